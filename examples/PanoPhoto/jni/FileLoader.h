@@ -17,10 +17,11 @@ of patent rights can be found in the PATENTS file in the same directory.
 
 NV_NAMESPACE_BEGIN
 
-class App;
-class PanoPhoto;
+// Starts the thread which reads the files
+void InitFileQueue();
 
-void InitFileQueue( App * app, PanoPhoto * photos);
+// Reads a file from the file system or else from the apk
+bool ReadFile(const VString &path, VByteArray &data);
 
 extern VEventLoop		Queue1;
 
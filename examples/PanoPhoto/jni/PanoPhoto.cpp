@@ -23,6 +23,7 @@ of patent rights can be found in the PATENTS file in the same directory.
 #include <android/JniUtils.h>
 #include <VZipFile.h>
 #include <VThread.h>
+#include <VThreadPool.h>
 #include <VStandardPath.h>
 #include <VFile.h>
 #include <VLog.h>
@@ -105,6 +106,7 @@ PanoPhoto::PanoPhoto(JNIEnv *jni, jclass activityClass, jobject activityObject)
     , m_useOverlay( true )
     , m_useSrgb( true )
     , m_backgroundCommands( 100 )
+    , m_panoGeneration( 0 )
     , m_eglClientVersion( 0 )
     , m_eglDisplay( 0 )
     , m_eglConfig( 0 )
@@ -112,6 +114,7 @@ PanoPhoto::PanoPhoto(JNIEnv *jni, jclass activityClass, jobject activityObject)
     , m_eglShareContext( 0 )
 {
     m_shutdownRequest.setState( false );
+    initPanoLoader();
 }
 
 PanoPhoto::~PanoPhoto()
@@ -145,7 +148,7 @@ void PanoPhoto::init(const VString &, const VString &, const VString &)
     m_scene.Znear = 0.1f;
     m_scene.Zfar = 200.0f;
 
-    InitFileQueue( vApp, this );
+    InitFileQueue();
 
     //---------------------------------------------------------
     // OpenGL initialization for shared context for
@@ -293,79 +296,8 @@ void * PanoPhoto::BackgroundGLLoadThread( void * v )
 
         photos->m_backgroundCommands.wait();
         VEvent event = photos->m_backgroundCommands.next();
-        vInfo("BackgroundGLLoadThread Commands:" << event.name);
-        if (event.name == "pano") {
-            uchar *data = static_cast<uchar *>(event.data.at(0).toPointer());
-            int width = event.data.at(1).toInt();
-            int height = event.data.at(2).toInt();
-
-            const double start = VTimer::Seconds( );
-
-            // Resample oversize images so gl can load them.
-            // We could consider resampling to GL_MAX_TEXTURE_SIZE exactly for better quality.
-            GLint maxTextureSize = 0;
-            glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxTextureSize );
-
-            VImage image(data, width, height);
-            data = nullptr;
-            while (width > maxTextureSize || width > maxTextureSize) {
-                vInfo("Quartering oversize" << width << height << "image");
-                image.quarter(true);
-                width = image.width();
-                height = image.height();
-            }
-
-            photos->loadRgbaTexture(image.data(), width, height, true);
-
-            // Add a sync object for uploading textures
-            EGLSyncKHR GpuSync = VEglDriver::eglCreateSyncKHR( photos->m_eglDisplay, EGL_SYNC_FENCE_KHR, NULL );
-            if ( GpuSync == EGL_NO_SYNC_KHR ) {
-                vFatal("BackgroundGLLoadThread eglCreateSyncKHR_():EGL_NO_SYNC_KHR");
-            }
-
-            // Force it to flush the commands and wait until the textures are fully uploaded
-            if ( EGL_FALSE == VEglDriver::eglClientWaitSyncKHR( photos->m_eglDisplay, GpuSync, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR,
-                                                                EGL_FOREVER_KHR ) )
-            {
-                vInfo("BackgroundGLLoadThread eglClientWaitSyncKHR returned EGL_FALSE");
-            }
-
-            vApp->eventLoop().post("loaded pano");
-
-            const double end = VTimer::Seconds();
-            vInfo(end - start << "s to load" << width << height << "res pano map");
-        } else if (event.name == "cube") {
-            int size = event.data.at(0).toInt();
-            uchar *data[6];
-            for (int i = 0; i < 6; i++) {
-                data[i] = static_cast<uchar *>(event.data.at(i + 1).toPointer());
-            }
-
-            const double start = VTimer::Seconds( );
-
-            photos->loadRgbaCubeMap( size, data, true );
-            for ( int i = 0; i < 6; i++ )
-            {
-                free( data[ i ] );
-            }
-
-            // Add a sync object for uploading textures
-            EGLSyncKHR GpuSync = VEglDriver::eglCreateSyncKHR( photos->m_eglDisplay, EGL_SYNC_FENCE_KHR, NULL );
-            if ( GpuSync == EGL_NO_SYNC_KHR ) {
-                vFatal("BackgroundGLLoadThread eglCreateSyncKHR_():EGL_NO_SYNC_KHR");
-            }
-
-            // Force it to flush the commands and wait until the textures are fully uploaded
-            if ( EGL_FALSE == VEglDriver::eglClientWaitSyncKHR( photos->m_eglDisplay, GpuSync, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR,
-                                                                EGL_FOREVER_KHR ) )
-            {
-                vInfo("BackgroundGLLoadThread eglClientWaitSyncKHR returned EGL_FALSE");
-            }
-
-            vApp->eventLoop().post("loaded cube");
-
-            const double end = VTimer::Seconds();
-            vInfo(end - start << "s to load" << size << "res cube map");
+        if (event.isExecutable()) {
+            event.execute();
         }
     }
 
@@ -619,15 +551,100 @@ void PanoPhoto::startBackgroundPanoLoad(const VString &filename)
 {
     vInfo("StartBackgroundPanoLoad" << filename);
 
-    // Queue1 will determine if this is a cube map and then post a message for each
-    // cube face to the other queues.
-    char const * command = filename.endsWith("_nz.jpg", false) ? "cube" : "pano";
+    // Supersede any load still in progress
+    PanoLoad load;
+    load.generation = ++m_panoGeneration;
+    load.cube = filename.endsWith("_nz.jpg", false);
+    load.filename = filename;
+    if (!m_panoLoader.start(std::move(load))) {
+        vWarn("StartBackgroundPanoLoad: file queue is full");
+    }
+}
+
+void PanoPhoto::initPanoLoader()
+{
+    m_panoLoader.then(&Queue1, [this](PanoLoad &load) {
+        if (load.generation != m_panoGeneration) {
+            return false;
+        }
+
+        if (!load.cube) {
+            return ReadFile(load.filename, load.files[0]);
+        }
+
+        const char * const cubeSuffix[6] = { "_px.jpg", "_nx.jpg", "_py.jpg", "_ny.jpg", "_pz.jpg", "_nz.jpg" };
+        const VString filenameWithoutSuffix = load.filename.left(load.filename.size() - 7);
+        for (int side = 0; side < 6; side++) {
+            const VString sideFilename = filenameWithoutSuffix + cubeSuffix[side];
+            if (!ReadFile(sideFilename, load.files[side])) {
+                vInfo("Queue1 failed to load" << sideFilename);
+                return false;
+            }
+            vInfo("Queue1 loaded" << sideFilename);
+        }
+        return true;
+    }).then(VThreadPool::instance(), [this](PanoLoad &load) {
+        if (load.generation != m_panoGeneration) {
+            return false;
+        }
+
+        const int numBuffers = load.cube ? 6 : 1;
+        for (int i = 0; i < numBuffers; i++) {
+            // done with the loading buffer once it is decoded
+            load.images[i].load(load.files[i]);
+            load.files[i] = VByteArray();
+            if (!load.images[i].isValid()) {
+                vInfo("LoadingThread: failed to load from buffer");
+                return false;
+            }
+        }
+        return true;
+    }).then(&m_backgroundCommands, [this](PanoLoad &load) {
+        if (load.generation != m_panoGeneration) {
+            return false;
+        }
+
+        const double start = VTimer::Seconds();
+
+        if (!load.cube) {
+            // Resample oversize images so gl can load them.
+            // We could consider resampling to GL_MAX_TEXTURE_SIZE exactly for better quality.
+            GLint maxTextureSize = 0;
+            glGetIntegerv( GL_MAX_TEXTURE_SIZE, &maxTextureSize );
+
+            VImage &image = load.images[0];
+            while (image.width() > maxTextureSize || image.height() > maxTextureSize) {
+                vInfo("Quartering oversize" << image.width() << image.height() << "image");
+                image.quarter(true);
+            }
+            loadRgbaTexture(image.data(), image.width(), image.height(), true);
+        } else {
+            const uchar *data[6];
+            for (int i = 0; i < 6; i++) {
+                data[i] = load.images[i].data();
+            }
+            loadRgbaCubeMap(load.images[0].width(), data, true);
+        }
+
+        // Add a sync object for uploading textures
+        EGLSyncKHR GpuSync = VEglDriver::eglCreateSyncKHR( m_eglDisplay, EGL_SYNC_FENCE_KHR, NULL );
+        if ( GpuSync == EGL_NO_SYNC_KHR ) {
+            vFatal("BackgroundGLLoadThread eglCreateSyncKHR_():EGL_NO_SYNC_KHR");
+        }
+
+        // Force it to flush the commands and wait until the textures are fully uploaded
+        if ( EGL_FALSE == VEglDriver::eglClientWaitSyncKHR( m_eglDisplay, GpuSync, EGL_SYNC_FLUSH_COMMANDS_BIT_KHR,
+                                                            EGL_FOREVER_KHR ) )
+        {
+            vInfo("BackgroundGLLoadThread eglClientWaitSyncKHR returned EGL_FALSE");
+        }
 
-    // Dump any load that hasn't started
-    Queue1.clear();
+        vApp->eventLoop().post(load.cube ? "loaded cube" : "loaded pano");
 
-    // Start a background load of the current pano image
-    Queue1.post(command, filename);
+        const double end = VTimer::Seconds();
+        vInfo(end - start << "s to load" << load.images[0].width() << load.images[0].height() << "res" << (load.cube ? "cube" : "pano") << "map");
+        return true;
+    });
 }
 
 void PanoPhoto::SetMenuState( const OvrMenuState state )
@@ -3,8 +3,12 @@
 #include "VMainActivity.h"
 
 #include "ModelView.h"
+#include "VAsyncTask.h"
+#include "VImage.h"
 #include "VLockless.h"
 
+#include <atomic>
+
 NV_NAMESPACE_BEGIN
 
 class PanoPhoto : public VMainActivity
@@ -67,8 +71,20 @@ public:
     VEventLoop &		backgroundMessageQueue() { return m_backgroundCommands;  }
 
 private:
+    // State of a background load while it moves from the file queue to the
+    // decoders and to the GL loader
+    struct PanoLoad
+    {
+        uint generation;
+        bool cube;
+        VString filename;
+        VByteArray files[6];
+        VImage images[6];
+    };
+
 	// Background textures loaded into GL by background thread using shared context
 	static void *		BackgroundGLLoadThread( void * v );
+    void				initPanoLoader();
     void				startBackgroundPanoLoad(const VString &filename );
     void				loadRgbaCubeMap( const int resolution, const unsigned char * const rgba[ 6 ], const bool useSrgbFormat );
     void				loadRgbaTexture( const unsigned char * data, int width, int height, const bool useSrgbFormat );
@@ -98,6 +114,11 @@ private:
 	// Background texture commands produced by FileLoader consumed by BackgroundGLLoadThread
     VEventLoop		m_backgroundCommands;
 
+    // Reads on Queue1, decodes on the thread pool and uploads on BackgroundGLLoadThread.
+    // A newer load makes the steps of the older ones stop.
+    VAsyncTask<PanoLoad>	m_panoLoader;
+    std::atomic<uint>	m_panoGeneration;
+
 	// The background loader loop will exit when this is set true.
     VLockless<bool>		m_shutdownRequest;
 
@@ -184,7 +184,8 @@ void PanoVideo::command(const VEvent &event )
 	// Always include the space in MatchesHead to prevent problems
 	// with commands with matching prefixes.
 
-    if (event.name == "newVideo") {
+    switch (event.name) {
+    case VAtom("newVideo"): {
         delete m_movieTexture;
         m_movieTexture = new SurfaceTexture( vApp->vrJni() );
         vInfo("RC_NEW_VIDEO texId" << m_movieTexture->textureId);
@@ -196,11 +197,12 @@ void PanoVideo::command(const VEvent &event )
         m_videoWidth = 0;
 		return;
 
-    } else if (event.name == "completion") {// video complete, return to menu
+    }
+    case VAtom("completion"): // video complete, return to menu
         setMenuState( MENU_BROWSER );
 		return;
 
-    } else if (event.name == "video") {
+    case VAtom("video"):
         m_videoWidth = event.data.at(0).toInt();
         m_videoHeight = event.data.at(1).toInt();
 
@@ -211,7 +213,7 @@ void PanoVideo::command(const VEvent &event )
 
 		return;
 
-    } else if (event.name == "startError") {
+    case VAtom("startError"): {
 		// FIXME: this needs to do some parameter magic to fix xliff tags
 		VString message;
 //		VrLocale::GetString( vApp->vrJni(), vApp->javaObject(), "@string/playback_failed", "@string/playback_failed", message );
@@ -225,7 +227,7 @@ void PanoVideo::command(const VEvent &event )
         setMenuState( MENU_BROWSER );
 		return;
 	}
-
+    }
 }
 
 VMatrix4f	PanoVideo::texmForVideo( const int eye )
@@ -33,6 +33,9 @@
 #include "VLog.h"
 #include "VMainActivity.h"
 #include "VThread.h"
+#include "VFrameArena.h"
+#include "VObjectPool.h"
+#include "VFrameGraph.h"
 #include "VStandardPath.h"
 #include "VColor.h"
 #include "VScene.h"
@@ -615,6 +618,11 @@ struct App::Private
         // Always include the space in MatchesHead to prevent problems
         // with commands that have matching prefixes.
 
+        if (event.isExecutable()) {
+            event.execute();
+            return;
+        }
+
         if (event.name == "joy") {
             vAssert(event.data.isArray());
             joypad.sticks[0][0] = event.data.at(0).toFloat();
@@ -901,104 +909,18 @@ struct App::Private
         int countApplicationFrames = 0;
         double lastReportTime = ceil(VTimer::Seconds());
 
-        while(!(vrThreadSynced && createdSurface && readyToExit))
-        {
-            //SPAM("FRAME START");
-
-            gazeCursor->BeginFrame();
-
-            // Process incoming messages until queue is empty
-            forever {
-                VEvent event = eventLoop.next();
-                if (!event.isValid()) {
-                    break;
-                }
-                command(event);
-            }
-
-            // If we don't have a surface yet, or we are paused, sleep until
-            // something shows up on the message queue.
-            if (windowSurface == EGL_NO_SURFACE || paused)
-            {
-                if (!(vrThreadSynced && createdSurface && readyToExit))
-                {
-                    eventLoop.wait();
-                }
-                continue;
-            }
-
-            // if there is an error condition, warp swap and nothing else
-            if (errorTexture != 0)
-            {
-                if (VTimer::Seconds() >= errorMessageEndTime)
-                {
-                    kernel->destroy(EXIT_TYPE_FINISH_AFFINITY);
-                }
-                else
-                {
-                    ovrTimeWarpParms warpSwapMessageParms = kernel->InitTimeWarpParms(WARP_INIT_MESSAGE, errorTexture.id());
-                    warpSwapMessageParms.ProgramParms[0] = 0.0f;						// rotation in radians
-                    warpSwapMessageParms.ProgramParms[1] = 1024.0f / errorTextureSize;	// message size factor
-                    kernel->doSmooth(&warpSwapMessageParms);
-
-//                    kernel->InitTimeWarpParms();
-//                    kernel->setSmoothOption( VK_INHIBIT_SRGB_FB | VK_FLUSH | VK_IMAGE);
-//
-//                    kernel->setSmoothProgram(VK_LOGO);
-//                    float mprogramParms[4];
-//                    mprogramParms[0] = 0.0f;		// rotation in radians per second
-//                    mprogramParms[1] = 2.0f;
-//                    kernel->setProgramParms(mprogramParms);
-//                            // icon size factor smaller than fullscreen
-//                    for ( int eye = 0; eye < 2; eye++ )
-//                    {
-//                       kernel->setSmoothEyeTexture(0, eye, 0);
-//                       kernel->setSmoothEyeTexture(errorTexture.id(), eye, 1);
-//
-//                    }
-//
-//                    kernel->doSmooth();
-//                    kernel->setSmoothProgram(VK_DEFAULT);
-
-                }
-                continue;
-            }
-
-            // Let the client app initialize only once by calling OneTimeInit() when the windowSurface is valid.
-            if (!running)
-            {
-                if (activity->showLoadingIcon())
-                {
-                    const ovrTimeWarpParms warpSwapLoadingIconParms = kernel->InitTimeWarpParms(WARP_INIT_LOADING_ICON, loadingIconTexId);
-                    kernel->doSmooth(&warpSwapLoadingIconParms);
-
-
-//                    kernel->InitTimeWarpParms();
-//                    kernel->setSmoothOption( VK_INHIBIT_SRGB_FB | VK_FLUSH | VK_IMAGE);
-//                    kernel->setSmoothProgram(VK_LOGO);
-//                    float mprogramParms[4];
-//                    mprogramParms[0] = 1.0f;		// rotation in radians per second
-//                    mprogramParms[1] = 16.0f;
-//                    kernel->setProgramParms(mprogramParms);
-//                            // icon size factor smaller than fullscreen
-//                    for ( int eye = 0; eye < 2; eye++ )
-//                    {
-//                       kernel->setSmoothEyeTexture(0,eye, 0);
-//                       kernel->setSmoothEyeTexture(loadingIconTexId,eye,1);
-//
-//                    }
-//
-//                    kernel->doSmooth();
-//                    kernel->setSmoothProgram(VK_DEFAULT);
+        VArray<VEvent> events;
 
-                }
-                vInfo("launchIntentJSON:" << launchIntentJSON);
-                vInfo("launchIntentURI:" << launchIntentURI);
+        // Per-frame work. Stages which use the GL context or JNI stay on this
+        // thread, the others go to the thread pool.
+        VFrameGraph frameGraph;
+        double rawDelta = 0.0;
 
-                activity->init(launchIntentFromPackage, launchIntentJSON, launchIntentURI);
-                running = true;
-            }
+        // Scratch memory of this thread, given back at the start of every frame
+        VFrameArena frameArena;
+        frameArena.makeCurrent();
 
+        const int inputStage = frameGraph.addStage("input", [this]{
             // latch the current joypad state and note transitions
             self->text.vrFrame.input = joypad;
             self->text.vrFrame.input.buttonPressed = joypad.buttonState & (~lastVrFrame.input.buttonState);
@@ -1019,24 +941,71 @@ struct App::Private
 
             // Synthesize swipe gestures
             interpretTouchpad(self->text.vrFrame.input);
+        });
 
+        const int recenterStage = frameGraph.addStage("recenter", [this]{
             if (recenterYawFrameStart != 0)
             {
                 // Perform a reorient before sensor data is read.  Allows apps to reorient without having invalid orientation information for that frame.
                 // Do a warp swap black on the frame the recenter started.
                 self->recenterYaw(recenterYawFrameStart == (self->text.vrFrame.id + 1));  // vrFrame.FrameNumber hasn't been incremented yet, so add 1.
             }
+        }, {}, VFrameGraph::CallerThread);
 
+        const int sensorStage = frameGraph.addStage("sensor", [this, &rawDelta]{
             // Get the latest head tracking state, predicted ahead to the midpoint of the time
             // it will be displayed.  It will always be corrected to the real values by
             // time warp, but the closer we get, the less black will be pulled in at the edges.
             const double now = VTimer::Seconds();
             static double prev = 0.0;
-            const double rawDelta = now - prev;
+            rawDelta = now - prev;
             prev = now;
             const double clampedPrediction = std::min(0.1, rawDelta * 2);
             sensorForNextWarp = VRotationSensor::instance()->predictState(now + clampedPrediction);
+        }, {recenterStage});
+
+        // Recentering changes lastViewMatrix
+        const int fpsStage = frameGraph.addStage("fps", [this]{
+            if (!showFPS) {
+                return;
+            }
+
+            const int FPS_NUM_FRAMES_TO_AVERAGE = 30;
+            static double  LastFrameTime = VTimer::Seconds();
+            static double  AccumulatedFrameInterval = 0.0;
+            static int   NumAccumulatedFrames = 0;
+            static float LastFrameRate = 60.0f;
+
+            double currentFrameTime = VTimer::Seconds();
+            double frameInterval = currentFrameTime - LastFrameTime;
+            AccumulatedFrameInterval += frameInterval;
+            NumAccumulatedFrames++;
+            if (NumAccumulatedFrames > FPS_NUM_FRAMES_TO_AVERAGE) {
+                double interval = (AccumulatedFrameInterval / NumAccumulatedFrames);  // averaged
+                AccumulatedFrameInterval = 0.0;
+                NumAccumulatedFrames = 0;
+                LastFrameRate = 1.0f / float(interval > 0.000001 ? interval : 0.00001);
+            }
 
+            VVect3f viewPos = lastViewMatrix.viewForward();
+            VVect3f viewFwd = lastViewMatrix.viewForward();
+            VVect3f newPos = viewPos + viewFwd * 1.5f;
+            fpsPointTracker.Update(VTimer::Seconds(), newPos);
+
+            fontParms_t fp;
+            fp.AlignHoriz = HORIZONTAL_CENTER;
+            fp.Billboard = true;
+            fp.TrackRoll = false;
+            VString temp;
+            temp.sprintf("%.1f fps", LastFrameRate);
+            worldFontSurface->DrawTextBillboarded3D(*defaultFont, fp, fpsPointTracker.GetCurPosition(),
+                    0.8f, VVect4f(1.0f, 0.0f, 0.0f, 1.0f), temp);
+
+            LastFrameTime = currentFrameTime;
+        }, {recenterStage});
+
+        // Back key handlers and the info text may use the font surface too
+        const int frameStage = frameGraph.addStage("frame", [this, &rawDelta]{
             self->text.vrFrame.pose = sensorForNextWarp;
             self->text.vrFrame.deltaSeconds   = std::min(0.1, rawDelta);
             self->text.vrFrame.id++;
@@ -1086,41 +1055,6 @@ struct App::Private
                 }
             }
 
-            if (showFPS) {
-                const int FPS_NUM_FRAMES_TO_AVERAGE = 30;
-                static double  LastFrameTime = VTimer::Seconds();
-                static double  AccumulatedFrameInterval = 0.0;
-                static int   NumAccumulatedFrames = 0;
-                static float LastFrameRate = 60.0f;
-
-                double currentFrameTime = VTimer::Seconds();
-                double frameInterval = currentFrameTime - LastFrameTime;
-                AccumulatedFrameInterval += frameInterval;
-                NumAccumulatedFrames++;
-                if (NumAccumulatedFrames > FPS_NUM_FRAMES_TO_AVERAGE) {
-                    double interval = (AccumulatedFrameInterval / NumAccumulatedFrames);  // averaged
-                    AccumulatedFrameInterval = 0.0;
-                    NumAccumulatedFrames = 0;
-                    LastFrameRate = 1.0f / float(interval > 0.000001 ? interval : 0.00001);
-                }
-
-                VVect3f viewPos = lastViewMatrix.viewForward();
-                VVect3f viewFwd = lastViewMatrix.viewForward();
-                VVect3f newPos = viewPos + viewFwd * 1.5f;
-                fpsPointTracker.Update(VTimer::Seconds(), newPos);
-
-                fontParms_t fp;
-                fp.AlignHoriz = HORIZONTAL_CENTER;
-                fp.Billboard = true;
-                fp.TrackRoll = false;
-                VString temp;
-                temp.sprintf("%.1f fps", LastFrameRate);
-                worldFontSurface->DrawTextBillboarded3D(*defaultFont, fp, fpsPointTracker.GetCurPosition(),
-                        0.8f, VVect4f(1.0f, 0.0f, 0.0f, 1.0f), temp);
-
-                LastFrameTime = currentFrameTime;
-            }
-
             // draw info text
             if (self->text.infoTextEndFrame >= self->text.vrFrame.id)
             {
@@ -1139,13 +1073,122 @@ struct App::Private
                 worldFontSurface->DrawTextBillboarded3D(*defaultFont, fp, self->text.infoTextPointTracker.GetCurPosition(),
                         1.0f, self->text.infoTextColor, self->text.infoText);
             }
+        }, {inputStage, sensorStage, fpsStage}, VFrameGraph::CallerThread);
 
+        frameGraph.addStage("update", [this]{
             // Main loop logic / draw code
             if (!readyToExit)
             {
                 lastViewMatrix = activity->onNewFrame(self->text.vrFrame);
                 scene->update();
             }
+        }, {frameStage}, VFrameGraph::CallerThread);
+
+        double criticalPathSum = 0.0;
+        double criticalPathMax = 0.0;
+        VThread::CpuStats lastCpuStats;
+
+        while(!(vrThreadSynced && createdSurface && readyToExit))
+        {
+            //SPAM("FRAME START");
+            frameArena.reset();
+
+            gazeCursor->BeginFrame();
+
+            // Process incoming messages until queue is empty
+            while (eventLoop.drain(events) > 0) {
+                for (const VEvent &event : events) {
+                    command(event);
+                }
+                events.clear();
+            }
+
+            // If we don't have a surface yet, or we are paused, sleep until
+            // something shows up on the message queue.
+            if (windowSurface == EGL_NO_SURFACE || paused)
+            {
+                if (!(vrThreadSynced && createdSurface && readyToExit))
+                {
+                    eventLoop.wait();
+                }
+                continue;
+            }
+
+            // if there is an error condition, warp swap and nothing else
+            if (errorTexture != 0)
+            {
+                if (VTimer::Seconds() >= errorMessageEndTime)
+                {
+                    kernel->destroy(EXIT_TYPE_FINISH_AFFINITY);
+                }
+                else
+                {
+                    ovrTimeWarpParms warpSwapMessageParms = kernel->InitTimeWarpParms(WARP_INIT_MESSAGE, errorTexture.id());
+                    warpSwapMessageParms.ProgramParms[0] = 0.0f;						// rotation in radians
+                    warpSwapMessageParms.ProgramParms[1] = 1024.0f / errorTextureSize;	// message size factor
+                    kernel->doSmooth(&warpSwapMessageParms);
+
+//                    kernel->InitTimeWarpParms();
+//                    kernel->setSmoothOption( VK_INHIBIT_SRGB_FB | VK_FLUSH | VK_IMAGE);
+//
+//                    kernel->setSmoothProgram(VK_LOGO);
+//                    float mprogramParms[4];
+//                    mprogramParms[0] = 0.0f;		// rotation in radians per second
+//                    mprogramParms[1] = 2.0f;
+//                    kernel->setProgramParms(mprogramParms);
+//                            // icon size factor smaller than fullscreen
+//                    for ( int eye = 0; eye < 2; eye++ )
+//                    {
+//                       kernel->setSmoothEyeTexture(0, eye, 0);
+//                       kernel->setSmoothEyeTexture(errorTexture.id(), eye, 1);
+//
+//                    }
+//
+//                    kernel->doSmooth();
+//                    kernel->setSmoothProgram(VK_DEFAULT);
+
+                }
+                continue;
+            }
+
+            // Let the client app initialize only once by calling OneTimeInit() when the windowSurface is valid.
+            if (!running)
+            {
+                if (activity->showLoadingIcon())
+                {
+                    const ovrTimeWarpParms warpSwapLoadingIconParms = kernel->InitTimeWarpParms(WARP_INIT_LOADING_ICON, loadingIconTexId);
+                    kernel->doSmooth(&warpSwapLoadingIconParms);
+
+
+//                    kernel->InitTimeWarpParms();
+//                    kernel->setSmoothOption( VK_INHIBIT_SRGB_FB | VK_FLUSH | VK_IMAGE);
+//                    kernel->setSmoothProgram(VK_LOGO);
+//                    float mprogramParms[4];
+//                    mprogramParms[0] = 1.0f;		// rotation in radians per second
+//                    mprogramParms[1] = 16.0f;
+//                    kernel->setProgramParms(mprogramParms);
+//                            // icon size factor smaller than fullscreen
+//                    for ( int eye = 0; eye < 2; eye++ )
+//                    {
+//                       kernel->setSmoothEyeTexture(0,eye, 0);
+//                       kernel->setSmoothEyeTexture(loadingIconTexId,eye,1);
+//
+//                    }
+//
+//                    kernel->doSmooth();
+//                    kernel->setSmoothProgram(VK_DEFAULT);
+
+                }
+                vInfo("launchIntentJSON:" << launchIntentJSON);
+                vInfo("launchIntentURI:" << launchIntentURI);
+
+                activity->init(launchIntentFromPackage, launchIntentJSON, launchIntentURI);
+                running = true;
+            }
+
+            frameGraph.run();
+            criticalPathSum += frameGraph.criticalPath();
+            criticalPathMax = std::max(criticalPathMax, frameGraph.criticalPath());
 
             // MWC demo hack to allow keyboard swipes
             joypad.buttonState &= ~(BUTTON_SWIPE_FORWARD|BUTTON_SWIPE_BACK);
@@ -1155,6 +1198,34 @@ struct App::Private
             const double timeNow = floor(VTimer::Seconds());
             if (timeNow > lastReportTime)
             {
+                if (enableDebugOptions && countApplicationFrames > 0)
+                {
+                    VString path;
+                    for (int stage : frameGraph.criticalStages())
+                    {
+                        if (!path.isEmpty())
+                        {
+                            path += " > ";
+                        }
+                        path += frameGraph.stageName(stage);
+                    }
+                    vInfo("Frame critical path: average " << criticalPathSum * 1000.0 / countApplicationFrames
+                          << "ms, max " << criticalPathMax * 1000.0 << "ms, last " << path);
+
+                    // Whether the scheduler keeps us on the cores we asked for
+                    const VThread::CpuStats cpuStats = renderThread->cpuStats();
+                    vInfo("VR thread: cpu " << cpuStats.lastCpu << " of mask " << renderThread->affinity()
+                          << ", cpu time " << (cpuStats.userTime + cpuStats.systemTime - lastCpuStats.userTime - lastCpuStats.systemTime) * 1000.0
+                          << "ms, switches " << cpuStats.voluntarySwitches - lastCpuStats.voluntarySwitches
+                          << " voluntary " << cpuStats.involuntarySwitches - lastCpuStats.involuntarySwitches << " involuntary");
+                    lastCpuStats = cpuStats;
+
+                    vInfo("Frame arena: last " << frameArena.lastFrameBytes() << " bytes, peak " << frameArena.peakBytes()
+                          << " bytes, capacity " << frameArena.capacity() << " bytes");
+                    VMemoryPool::LogStats();
+                }
+                criticalPathSum = 0.0;
+                criticalPathMax = 0.0;
 
                 countApplicationFrames = 0;
                 lastReportTime = timeNow;
@@ -1162,6 +1233,7 @@ struct App::Private
 
             //SPAM("FRAME END");
         }
+        frameArena.doneCurrent();
 
         // Shutdown the VR thread
         {
@@ -1337,6 +1409,7 @@ App::App(JNIEnv *jni, jobject activityObject, VMainActivity *activity)
         d->run();
         return 0;
     }, d);
+    d->renderThread->setAffinity(VThread::BigCoreMask());
 }
 
 App::~App()
@@ -14,6 +14,7 @@
 #include "android/JniUtils.h"
 #include "VLensDistortion.h"
 #include "../core/VString.h"
+#include "VThread.h"
 #include "VTimer.h"
 #include "VRotationSensor.h"
 
@@ -819,7 +820,7 @@ void VFrameSmooth::Private::warpThreadInit()
 
     pthread_setname_np( pthread_self(), "NervGear::VFrameSmooth" );
 
-    //SetCurrentThreadAffinityMask( 0xF0 );
+    VThread::SetAffinity( VThread::currentThreadSystemId(), VThread::BigCoreMask() );
 
     //---------------------------------------------------------
     // OpenGl initiailization
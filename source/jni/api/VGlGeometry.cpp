@@ -6,6 +6,7 @@
 
 #include "VEglDriver.h"
 #include "VAlgorithm.h"
+#include "VFrameArena.h"
 #include "VLensDistortion.h"
 #include "VGlShader.h"
 
@@ -18,7 +19,7 @@
 NV_NAMESPACE_BEGIN
 
 template< typename _attrib_type_ >
-void PackVertexAttribute( VArray< uint8_t > & packed, const VArray< _attrib_type_ > & attrib,
+void PackVertexAttribute( VFrameArray< uint8_t > & packed, const VArray< _attrib_type_ > & attrib,
                           const int glLocation, const int glType, const int glComponents )
 {
     if ( attrib.size() > 0 )
@@ -37,6 +38,20 @@ void PackVertexAttribute( VArray< uint8_t > & packed, const VArray< _attrib_type
         glDisableVertexAttribArray( glLocation );
     }
 }
+// Reserved up front, as each time a frame array grows its old buffer stays in the arena
+static size_t PackedSize( const VertexAttribs & attribs )
+{
+    return attribs.position.size() * sizeof( attribs.position[0] )
+            + attribs.normal.size() * sizeof( attribs.normal[0] )
+            + attribs.tangent.size() * sizeof( attribs.tangent[0] )
+            + attribs.binormal.size() * sizeof( attribs.binormal[0] )
+            + attribs.color.size() * sizeof( attribs.color[0] )
+            + attribs.uvCoordinate0.size() * sizeof( attribs.uvCoordinate0[0] )
+            + attribs.uvCoordinate1.size() * sizeof( attribs.uvCoordinate1[0] )
+            + attribs.motionIndices.size() * sizeof( attribs.motionIndices[0] )
+            + attribs.motionWeight.size() * sizeof( attribs.motionWeight[0] );
+}
+
 void VGlGeometry::createGlGeometry( const VertexAttribs & attribs, const VArray< ushort > & indices )
 {
 
@@ -49,7 +64,9 @@ void VGlGeometry::createGlGeometry( const VertexAttribs & attribs, const VArray<
     VEglDriver::glBindVertexArrayOES( vertexArrayObject );
     glBindBuffer( GL_ARRAY_BUFFER, vertexBuffer );
 
-    VArray< uint8_t > packed;
+    // Only lives until glBufferData, so it comes from the frame arena on the VR thread
+    VFrameArray< uint8_t > packed;
+    packed.reserve( PackedSize( attribs ) );
     PackVertexAttribute( packed, attribs.position,		VERTEX_POSITION,			GL_FLOAT,	3 );
     PackVertexAttribute( packed, attribs.normal,		VERTEX_NORMAL,			GL_FLOAT,	3 );
     PackVertexAttribute( packed, attribs.tangent,		VERTEX_TANGENT,			GL_FLOAT,	3 );
@@ -90,7 +107,8 @@ void VGlGeometry::createGlGeometry( const VertexAttribs & attribs, const VArray<
     glOperation.glBindVertexArrayOES( vertexArrayObject );
     glBindBuffer( GL_ARRAY_BUFFER, vertexBuffer );
 
-    VArray< uint8_t > packed;
+    VFrameArray< uint8_t > packed;
+    packed.reserve( PackedSize( attribs ) );
     PackVertexAttribute( packed, attribs.position,		LOCATION_POSITION,			GL_FLOAT,	3 );
     PackVertexAttribute( packed, attribs.normal,		LOCATION_NORMAL,			GL_FLOAT,	3 );
     PackVertexAttribute( packed, attribs.tangent,		LOCATION_TANGENT,			GL_FLOAT,	3 );
@@ -131,7 +149,8 @@ void VGlGeometry::updateGlGeometry( const VertexAttribs & attribs )
 
     glBindBuffer( GL_ARRAY_BUFFER, vertexBuffer );
 
-    VArray< uint8_t > packed;
+    VFrameArray< uint8_t > packed;
+    packed.reserve( PackedSize( attribs ) );
 
     PackVertexAttribute( packed, attribs.position,		VERTEX_POSITION,			GL_FLOAT,	3 );
     PackVertexAttribute( packed, attribs.normal,		VERTEX_NORMAL,			GL_FLOAT,	3 );
@@ -13,6 +13,7 @@
 #include "VString.h"
 #include "VLockless.h"
 #include "VModule.h"
+#include "VThread.h"
 
 #include "android/JniUtils.h"
 #include "android/VOsBuild.h"
@@ -343,9 +344,14 @@ void VKernel::run()
 
     frameSmooth = new VFrameSmooth(asyncSmooth, vApp->vrParms().wantSingleBuffer);
 
+    // Apps rarely hold CAP_SYS_NICE, the Java side asks the system for SCHED_FIFO then
     jmethodID setSchedFifoId = JniUtils::GetStaticMethodID(Jni, VrLibClass, "setSchedFifoStatic", "(Landroid/app/Activity;II)I");
-    Jni->CallStaticIntMethod(VrLibClass, setSchedFifoId, ActivityObject, gettid(), 1);
-    Jni->CallStaticIntMethod(VrLibClass, setSchedFifoId, ActivityObject, frameSmooth->threadId(), 3);
+    if (!VThread::SetRealtime(gettid(), VThread::FifoScheduling, 1)) {
+        Jni->CallStaticIntMethod(VrLibClass, setSchedFifoId, ActivityObject, gettid(), 1);
+    }
+    if (!VThread::SetRealtime(frameSmooth->threadId(), VThread::FifoScheduling, 3)) {
+        Jni->CallStaticIntMethod(VrLibClass, setSchedFifoId, ActivityObject, frameSmooth->threadId(), 3);
+    }
 
     if ( setActivityWindowFullscreenID != NULL)
     {
@@ -1,5 +1,6 @@
 #include "VRotationSensor.h"
 #include "VLockless.h"
+#include "VLocklessHistory.h"
 #include "VCircularQueue.h"
 #include "VAlgorithm.h"
 #include "VLog.h"
@@ -7,6 +8,7 @@
 #include "VTimer.h"
 #include "VQuat.h"
 
+#include <atomic>
 #include <jni.h>
 #include <fcntl.h>
 
@@ -14,78 +16,71 @@ NV_NAMESPACE_BEGIN
 
 struct VRotationSensor::Private
 {
-    VLockless<VRotationState> state;
+    // About 128ms of samples at 1000Hz
+    VLocklessHistory<VRotationState, 128> history;
     VLockless<VQuatf> recenter;
-    VMutex recenterMutex;
+    // The sensor thread is the only writer of the history and the recenter
+    // rotation. Other threads request a yaw, which it applies to the next
+    // sample, and only wait for each other.
+    VLockless<float> requestedYaw;
+    std::atomic<uint> requests;
+    uint appliedRequests;
+    VMutex requestMutex;
     bool initialized;
 
     Private()
-        : initialized(false)
+        : requests(0)
+        , appliedRequests(0)
+        , initialized(false)
     {
     }
+
+    void requestYaw(float yaw)
+    {
+        requestMutex.lock();
+        requestedYaw.setState(yaw);
+        requests.fetch_add(1, std::memory_order_release);
+        requestMutex.unlock();
+    }
+
+    // Turns the raw state to the given yaw from now on
+    void setYaw(const VRotationState &state, float newYaw)
+    {
+        float yaw, pitch, roll;
+        state.GetEulerAngles<VAxis_Y, VAxis_X, VAxis_Z>(&yaw, &pitch, &roll);
+        recenter.setState(VQuatf(VAxis_Y, newYaw - yaw));
+    }
 };
 
 void VRotationSensor::setState(const VRotationState &state)
 {
     if (!d->initialized) {
-        float yaw, pitch, roll;
-        state.GetEulerAngles<VAxis_Y, VAxis_X, VAxis_Z>(&yaw, &pitch, &roll);
-        d->recenter.setState(VQuatf(VAxis_Y, -yaw));
+        d->setYaw(state, 0.0f);
         d->initialized = true;
-    } else {
-        VRotationState recentered = state;
-        VQuatf base = d->recenter.state() * state;
-        recentered.w = base.w;
-        recentered.x = base.x;
-        recentered.y = base.y;
-        recentered.z = base.z;
-        d->state.setState(state);
+        return;
+    }
+
+    const uint requests = d->requests.load(std::memory_order_acquire);
+    if (requests != d->appliedRequests) {
+        d->setYaw(state, d->requestedYaw.state());
+        d->appliedRequests = requests;
     }
+    d->history.append(state.timestamp, state);
 }
 
 VRotationState VRotationSensor::state() const
 {
-    return d->state.state();
+    return d->history.state();
 }
 
 void VRotationSensor::recenterYaw()
 {
-    // get the current state
-    VRotationState state = this->state();
-
-    // get the yaw in the current state
-    float yaw, pitch, roll;
-    state.GetEulerAngles<VAxis_Y, VAxis_X, VAxis_Z>(&yaw, &pitch, &roll);
-
-    // get the pose that adjusts the yaw
-    VQuatf yawAdjustment(VAxis_Y, -yaw);
-    state = yawAdjustment;
-
-    // To allow RecenterYaw() to be called from multiple threads we need a mutex
-    // because LocklessUpdater is only safe for single producer cases.
-    d->recenterMutex.lock();
-    d->state.setState(state);
-    d->recenterMutex.unlock();
+    d->requestYaw(0.0f);
 }
 
 void VRotationSensor::setYaw(float newYaw)
 {
-    // get the current state
-    VRotationState state = this->state();
-
-    // get the yaw in the current state
-    float yaw, pitch, roll;
-    state.GetEulerAngles<VAxis_Y, VAxis_X, VAxis_Z>(&yaw, &pitch, &roll);
-
-    // get the pose that adjusts the yaw
-    VQuatf yawAdjustment(VAxis_Y, newYaw - yaw);
-    state = yawAdjustment;
-
-    // To allow SetYaw() to be called from multiple threads we need a mutex
-    // because LocklessUpdater is only safe for single producer cases.
-    d->recenterMutex.lock();
-    d->state.setState(state);
-    d->recenterMutex.unlock();
+    d->requestYaw(newYaw);
 }
 
 VRotationSensor *VRotationSensor::instance()
@@ -122,11 +117,21 @@ static VQuatf calcPredictedPose(const VRotationState &pose, float predictionDt)
     return pose;
 }
 
-VRotationState VRotationSensor::predictState(double timestamp) const
+static VRotationState interpolateState(const VRotationState &from, const VRotationState &to, double fraction)
 {
-    //lockless state fetch
-    VRotationState state = this->state();
+    VRotationState state;
+    // Nlerp() goes from the other one to this
+    state = to.Nlerp(from, float(fraction));
+    state.gyro = from.gyro + (to.gyro - from.gyro) * float(fraction);
+    state.timestamp = from.timestamp + (to.timestamp - from.timestamp) * fraction;
+    return state;
+}
 
+VRotationState VRotationSensor::predictState(double timestamp) const
+{
+    //lockless state fetch, interpolated if the timestamp has passed
+    VRotationState state = VRotationState();
+    d->history.sampleAt(timestamp, state, interpolateState);
 
     // Delta time from the last processed message
     double pdt = timestamp - state.timestamp;
@@ -15,10 +15,10 @@
 
 NV_NAMESPACE_BEGIN
 
-template <class E>
-class VArray : public std::vector<E>
+template <class E, class Allocator = std::allocator<E>>
+class VArray : public std::vector<E, Allocator>
 {
-    typedef std::vector<E> ParentType;
+    typedef std::vector<E, Allocator> ParentType;
 
 public:
     typedef typename ParentType::iterator Iterator;
@@ -26,6 +26,7 @@ public:
     typedef E ValueType;
 
     VArray() {}
+    explicit VArray(const Allocator &allocator) : ParentType(allocator) {}
 
     int length() const { return (int) ParentType::size(); }
     uint size() const { return ParentType::size(); }
@@ -51,7 +52,7 @@ public:
         return *this;
     }
 
-    VArray &operator << (const VArray<E> &elements)
+    VArray &operator << (const VArray &elements)
     {
         append(elements);
         return *this;
@@ -71,7 +72,7 @@ public:
     void append(const E &e) { ParentType::push_back(e); }
     void append(E &&e) { ParentType::push_back(std::move(e)); }
 
-    void append(const VArray<E> &elements)
+    void append(const VArray &elements)
     {
         for(const E &e : elements) {
             append(e);
@@ -81,7 +82,7 @@ public:
     void prepend(const E &e) { ParentType::insert(ParentType::begin(), e); }
     void prepend(E &&e) { ParentType::insert(ParentType::begin(), std::move(e)); }
 
-    void prepend(const VArray<E> &elements)
+    void prepend(const VArray &elements)
     {
         for (auto i = elements.rbegin(); i != elements.rend(); i++) {
             ParentType::insert(ParentType::begin(), *i);
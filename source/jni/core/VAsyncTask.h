@@ -0,0 +1,170 @@
+#pragma once
+
+#include "VArray.h"
+#include "VEventLoop.h"
+#include "VLog.h"
+#include "VThreadPool.h"
+
+#include <functional>
+#include <memory>
+
+NV_NAMESPACE_BEGIN
+
+// A chain of steps sharing one frame object, where every step may run on its
+// own event loop or thread pool, e.g. read a file on an IO thread, decode it
+// on the pool and upload it on a GL thread. Moving on to another thread posts
+// a pointer to the frame, so the frame is the only allocation of a run. A
+// loop which drops the event, on clear() or when destroyed, deletes the run.
+//
+// A step returns false to end the run early. The loops must execute the
+// events they receive (see VEvent::isExecutable()).
+template<typename Frame>
+class VAsyncTask
+{
+public:
+    typedef std::function<bool(Frame &)> Step;
+
+    VAsyncTask()
+        : m_steps(new VArray<Entry>)
+    {
+    }
+
+    // Runs on the thread which finished the previous step
+    VAsyncTask &then(const Step &step)
+    {
+        return append(nullptr, VEventLoop::NormalPriority, nullptr, step);
+    }
+
+    VAsyncTask &then(VEventLoop *loop, const Step &step, VEventLoop::Priority priority = VEventLoop::NormalPriority)
+    {
+        return append(loop, priority, nullptr, step);
+    }
+
+    VAsyncTask &then(VThreadPool *pool, const Step &step)
+    {
+        return append(nullptr, VEventLoop::NormalPriority, pool, step);
+    }
+
+    // Returns false if the first step can't be posted
+    bool start(Frame &&frame) const
+    {
+        return launch(new Run(std::move(frame), m_steps));
+    }
+
+    bool start(const Frame &frame) const
+    {
+        return launch(new Run(frame, m_steps));
+    }
+
+private:
+    struct Entry
+    {
+        VEventLoop *loop;
+        VEventLoop::Priority priority;
+        VThreadPool *pool;
+        Step step;
+    };
+
+    typedef std::shared_ptr<VArray<Entry>> Steps;
+
+    struct Run
+    {
+        Run(Frame &&frame, const Steps &steps)
+            : frame(std::move(frame))
+            , steps(steps)
+            , index(0)
+        {
+        }
+
+        Run(const Frame &frame, const Steps &steps)
+            : frame(frame)
+            , steps(steps)
+            , index(0)
+        {
+        }
+
+        Frame frame;
+        Steps steps;
+        int index;
+
+        static void Resume(void *context)
+        {
+            static_cast<Run *>(context)->resume();
+        }
+
+        static void Dispose(void *context)
+        {
+            delete static_cast<Run *>(context);
+        }
+
+        // Returns false if the loop of the current step refused it
+        bool hop()
+        {
+            const Entry &entry = (*steps)[index];
+            if (entry.loop) {
+                return entry.loop->post(VEvent(Resume, this, Dispose), entry.priority);
+            }
+
+            if (entry.pool) {
+                entry.pool->run([this]{
+                    resume();
+                });
+            } else {
+                resume();
+            }
+            return true;
+        }
+
+        void resume()
+        {
+            forever {
+                if (!(*steps)[index].step(frame) || ++index >= steps->length()) {
+                    delete this;
+                    return;
+                }
+
+                const Entry &next = (*steps)[index];
+                if (next.loop || next.pool) {
+                    if (!hop()) {
+                        vWarn("VAsyncTask: step" << index << "dropped, its event loop is full or has quit");
+                        delete this;
+                    }
+                    return;
+                }
+            }
+        }
+    };
+
+    VAsyncTask &append(VEventLoop *loop, VEventLoop::Priority priority, VThreadPool *pool, const Step &step)
+    {
+        // Runs in flight keep the steps they started with
+        if (!m_steps.unique()) {
+            m_steps.reset(new VArray<Entry>(*m_steps));
+        }
+
+        Entry entry;
+        entry.loop = loop;
+        entry.priority = priority;
+        entry.pool = pool;
+        entry.step = step;
+        m_steps->append(entry);
+        return *this;
+    }
+
+    static bool launch(Run *run)
+    {
+        if (run->steps->isEmpty()) {
+            delete run;
+            return true;
+        }
+        if (!run->hop()) {
+            delete run;
+            return false;
+        }
+        return true;
+    }
+
+    Steps m_steps;
+};
+
+NV_NAMESPACE_END
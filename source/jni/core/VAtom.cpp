@@ -0,0 +1,101 @@
+#include "VAtom.h"
+#include "VLog.h"
+#include "VMutex.h"
+#include "VString.h"
+
+#include <atomic>
+#include <string.h>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+// Open addressing over the ids. Readers probe without a lock, a new name is
+// published by storing its id after its copy.
+struct AtomTable
+{
+    enum { Capacity = 1024 };
+
+    std::atomic<uint> ids[Capacity];
+    const char *names[Capacity];
+    VMutex mutex;
+
+    AtomTable()
+        : mutex(false)
+    {
+        for (uint i = 0; i < Capacity; i++) {
+            ids[i].store(0, std::memory_order_relaxed);
+            names[i] = nullptr;
+        }
+    }
+
+    // The slot holding id, or the empty one it would go to, or -1 if full
+    int find(uint id) const
+    {
+        uint index = id & (Capacity - 1);
+        for (uint probe = 0; probe < Capacity; probe++) {
+            const uint slot = ids[index].load(std::memory_order_acquire);
+            if (slot == id || slot == 0) {
+                return index;
+            }
+            index = (index + 1) & (Capacity - 1);
+        }
+        return -1;
+    }
+};
+
+AtomTable &Table()
+{
+    static AtomTable table;
+    return table;
+}
+
+} // anonymous namespace
+
+VAtom VAtom::Intern(const char *name)
+{
+    const uint id = Hash(name);
+    AtomTable &table = Table();
+
+    int index = table.find(id);
+    if (index < 0 || table.ids[index].load(std::memory_order_relaxed) == 0) {
+        VMutex::Locker locker(&table.mutex);
+        index = table.find(id);
+        if (index < 0) {
+            vWarn("VAtom: too many names to record" << name);
+            return VAtom(id, 0);
+        }
+        if (table.ids[index].load(std::memory_order_relaxed) == 0) {
+            table.names[index] = strdup(name);
+            table.ids[index].store(id, std::memory_order_release);
+            return VAtom(id, 0);
+        }
+    }
+
+    // Literals of the same name usually share their address
+    const char *recorded = table.names[index];
+    if (recorded != name && strcmp(recorded, name) != 0) {
+        vWarn("VAtom: " << name << "and" << recorded << "have the same hash");
+    }
+    return VAtom(id, 0);
+}
+
+VAtom VAtom::Intern(const VString &name)
+{
+    return Intern(name.toUtf8().data());
+}
+
+const char *VAtom::name() const
+{
+    if (m_id == 0) {
+        return "";
+    }
+    const AtomTable &table = Table();
+    const int index = table.find(m_id);
+    if (index < 0 || table.ids[index].load(std::memory_order_relaxed) == 0) {
+        return "";
+    }
+    return table.names[index];
+}
+
+NV_NAMESPACE_END
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "vglobal.h"
+
+#include <ostream>
+
+NV_NAMESPACE_BEGIN
+
+class VString;
+
+// A name reduced to a 32-bit FNV-1a hash. Atoms made from literals are
+// computed at compile time, so comparing them or switching over them never
+// touches a string:
+//
+//     switch (event.name) {
+//     case VAtom("quit"): ...
+//     }
+//
+// Intern() also records the name in a process-wide table, which is only
+// read back to print atoms.
+class VAtom
+{
+public:
+    constexpr VAtom() : m_id(0) {}
+
+    template<int N>
+    constexpr VAtom(const char (&name)[N]) : m_id(Hash(name)) {}
+
+    static VAtom Intern(const char *name);
+    static VAtom Intern(const VString &name);
+
+    constexpr uint id() const { return m_id; }
+    constexpr bool isNull() const { return m_id == 0; }
+    constexpr operator uint() const { return m_id; }
+
+    // The interned name, or "" if it was never interned
+    const char *name() const;
+
+    constexpr bool operator == (VAtom other) const { return m_id == other.m_id; }
+    constexpr bool operator != (VAtom other) const { return m_id != other.m_id; }
+
+    // 0 is the null atom, so no name may hash to it
+    static constexpr uint Hash(const char *name)
+    {
+        return NonZero(Fnv(name, 2166136261u));
+    }
+
+    friend std::ostream &operator << (std::ostream &out, VAtom atom) { out << atom.name(); return out; }
+
+private:
+    explicit constexpr VAtom(uint id, int) : m_id(id) {}
+
+    static constexpr uint Fnv(const char *name, uint hash)
+    {
+        return *name ? Fnv(name + 1, (hash ^ (uchar) *name) * 16777619u) : hash;
+    }
+
+    static constexpr uint NonZero(uint hash) { return hash ? hash : 1; }
+
+    uint m_id;
+};
+
+NV_NAMESPACE_END
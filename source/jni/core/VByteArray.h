@@ -6,6 +6,10 @@
 
 NV_NAMESPACE_BEGIN
 
+// The GNU STL we build with shares string buffers between copies and only
+// duplicates one when it is written to, so copying a VByteArray is as cheap
+// as copying a handle. Calling non-const operator[], begin() or end() counts
+// as a write, so read shared data through the const functions.
 class VByteArray : public std::basic_string<char>
 {
     typedef std::basic_string<char> ParentType;
@@ -18,7 +22,7 @@ public:
     VByteArray(const char *bytes, uint length) : basic_string(bytes, length) {}
 
     void append(char ch) { basic_string::operator +=(ch); }
-    void append(char *bytes, vint64 length) { basic_string::append(bytes, length); }
+    void append(const char *bytes, vint64 length) { basic_string::append(bytes, length); }
 
     uint size() const { return ParentType::size(); }
     int length() const { return (int) ParentType::length(); }
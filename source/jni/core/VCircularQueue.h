@@ -2,20 +2,27 @@
 
 #include "vglobal.h"
 
+#include <algorithm>
 #include <memory>
 
 NV_NAMESPACE_BEGIN
 
+// Keeps the last capacity elements. Appending to a full queue drops the first
+// element and prepending drops the last one.
+//
+// The elements live in a power-of-two sized ring indexed by free-running
+// counters and a mask, so there is no modulo on any access. Not thread-safe,
+// see VLocklessQueue for passing elements between two threads.
 template <class E>
 class VCircularQueue
 {
 public:
     VCircularQueue(uint capacity = 500)
         : m_capacity(capacity)
-        , m_size(0)
-        , m_front(0)
-        , m_back(0)
-        , m_data(new E[m_capacity])
+        , m_mask(RoundUp(capacity) - 1)
+        , m_head(0)
+        , m_tail(0)
+        , m_data(new E[m_mask + 1])
     {
     }
 
@@ -25,79 +32,116 @@ public:
     }
 
     uint capacity() const { return m_capacity; }
-    uint size() const { return m_size; }
+    uint size() const { return m_tail - m_head; }
 
-    bool isFull() const { return m_size >= m_capacity; }
-    bool isEmpty() const { return m_front == m_back && !isFull(); }
+    bool isFull() const { return size() >= m_capacity; }
+    bool isEmpty() const { return m_tail == m_head; }
 
-    E first() const { return m_data[m_front]; }
-    E &first() { return m_data[m_front]; }
+    E first() const { return m_data[m_head & m_mask]; }
+    E &first() { return m_data[m_head & m_mask]; }
 
-    E last() const { return m_data[(m_back - 1 + m_capacity) % m_capacity]; }
-    E &last() { return m_data[(m_back - 1 + m_capacity) % m_capacity]; }
+    E last() const { return m_data[(m_tail - 1) & m_mask]; }
+    E &last() { return m_data[(m_tail - 1) & m_mask]; }
 
     void append(const E &element)
     {
-        m_data[m_back] = element;
+        m_data[m_tail & m_mask] = element;
         forward();
     }
 
     void append(E &&element)
     {
-        m_data[m_back] = std::move(element);
+        m_data[m_tail & m_mask] = std::move(element);
         forward();
     }
 
+    // Of more than capacity elements, only the last ones are kept
+    void appendRange(const E *elements, uint count)
+    {
+        if (count > m_capacity) {
+            elements += count - m_capacity;
+            count = m_capacity;
+        }
+
+        const uint start = m_tail & m_mask;
+        const uint chunk = std::min(count, m_mask + 1 - start);
+        std::copy(elements, elements + chunk, m_data + start);
+        std::copy(elements + chunk, elements + count, m_data);
+
+        m_tail += count;
+        if (size() > m_capacity) {
+            m_head = m_tail - m_capacity;
+        }
+    }
+
     void prepend(const E &element)
     {
         backward();
-        m_data[m_front] = element;
+        m_data[m_head & m_mask] = element;
     }
 
     void prepend(E &&element)
     {
         backward();
-        m_data[m_front] = std::move(element);
+        m_data[m_head & m_mask] = std::move(element);
     }
 
-    const E &at(uint index) const { return m_data[(m_front + index) % m_capacity]; }
-    E &operator[](uint index) { return m_data[(m_front + index) % m_capacity]; }
-    const E &operator[] (uint index) const { return m_data[(m_front + index) % m_capacity]; }
+    // Copies up to count elements from index on and returns how many there were
+    uint copyOut(E *elements, uint index, uint count) const
+    {
+        if (index >= size()) {
+            return 0;
+        }
+        count = std::min(count, size() - index);
+
+        const uint start = (m_head + index) & m_mask;
+        const uint chunk = std::min(count, m_mask + 1 - start);
+        std::copy(m_data + start, m_data + start + chunk, elements);
+        std::copy(m_data, m_data + count - chunk, elements + chunk);
+        return count;
+    }
+
+    const E &at(uint index) const { return m_data[(m_head + index) & m_mask]; }
+    E &operator[](uint index) { return m_data[(m_head + index) & m_mask]; }
+    const E &operator[] (uint index) const { return m_data[(m_head + index) & m_mask]; }
 
     void clear()
     {
-        m_front = m_back = 0;
-        m_size = 0;
+        m_head = m_tail = 0;
     }
 
 private:
-    void forward()
+    static uint RoundUp(uint capacity)
     {
-        m_back++;
-        if (m_back >= m_capacity) {
-            m_back = 0;
+        uint result = 1;
+        while (result < capacity) {
+            result <<= 1;
         }
-        if (m_size >= m_capacity) {
-            m_front = (m_front + 1) % m_capacity;
-        } else {
-            m_size++;
+        return result;
+    }
+
+    // The counters wrap around together, and the ring size divides 2^32, so
+    // masking them stays consistent
+    void forward()
+    {
+        m_tail++;
+        if (size() > m_capacity) {
+            m_head++;
         }
     }
 
     void backward()
     {
-        m_front = m_front ? m_front - 1 : m_capacity - 1;
-        if (m_size >= m_capacity) {
-            m_back = m_back ? m_back - 1 : m_capacity - 1;
-        } else {
-            m_size++;
+        m_head--;
+        if (size() > m_capacity) {
+            m_tail--;
         }
     }
 
     uint m_capacity;
-    uint m_size;
-    uint m_front;
-    uint m_back;
+    uint m_mask;
+    uint m_head;
+    uint m_tail;
     E *m_data;
 };
 
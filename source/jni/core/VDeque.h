@@ -20,20 +20,20 @@ public:
 
     void removeFirst() { ParentType::pop_front(); }
 
-    E &&takeFirst()
+    E takeFirst()
     {
         E element = std::move(ParentType::front());
         ParentType::pop_front();
-        return std::move(element);
+        return element;
     }
 
     void removeLast() { ParentType::pop_back(); }
 
-    E &&takeLast()
+    E takeLast()
     {
         E element = std::move(ParentType::back());
         ParentType::pop_back();
-        return std::move(element);
+        return element;
     }
 
     const E &peekFirst(uint i = 0) const { return ParentType::operator [](i); }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "VAtom.h"
 #include "VString.h"
 #include "VVariant.h"
 
@@ -7,22 +8,70 @@ NV_NAMESPACE_BEGIN
 
 struct VEvent
 {
+    // Unlike a closure, a callback with a context pointer needs no allocation
+    typedef void (*Callback)(void *context);
+
     VEvent()
+        : callback(nullptr)
+        , dispose(nullptr)
+    {
+    }
+
+    // Names are interned, so handlers compare them as integers
+    VEvent(const char *name)
+        : name(VAtom::Intern(name))
+        , callback(nullptr)
+        , dispose(nullptr)
     {
     }
 
     VEvent(const VString &name)
+        : name(VAtom::Intern(name))
+        , callback(nullptr)
+        , dispose(nullptr)
+    {
+    }
+
+    VEvent(VAtom name)
         : name(name)
+        , callback(nullptr)
+        , dispose(nullptr)
     {
     }
 
-    bool isValid() const { return !name.isEmpty() || isExecutable(); }
+    // A loop which drops the event unexecuted, on clear(), when coalescing
+    // or when destroyed with it pending, calls dispose instead
+    VEvent(Callback callback, void *context, Callback dispose = nullptr)
+        : data(context)
+        , callback(callback)
+        , dispose(dispose)
+    {
+    }
+
+    bool isValid() const { return !name.isNull() || isExecutable(); }
 
-    bool isExecutable() const { return data.isClosure(); }
-    void execute() const { data.execute(); }
+    bool isExecutable() const { return callback != nullptr || data.isClosure(); }
+    void execute() const
+    {
+        if (callback) {
+            callback(data.toPointer());
+        } else {
+            data.execute();
+        }
+    }
+
+    // Lets the context go of an event which will never be executed
+    void discard() const
+    {
+        if (dispose) {
+            dispose(data.toPointer());
+        }
+    }
 
-    VString name;
+    VAtom name;
     VVariant data;
+    Callback callback;
+    Callback dispose;
 };
 
 NV_NAMESPACE_END
@@ -1,98 +1,593 @@
 #include "VEventLoop.h"
 
+#include <VFutex.h>
+#include <VHash.h>
 #include <VLog.h>
 #include <VMutex.h>
 #include <VSemaphore.h>
+#include <VTimer.h>
+#include <VTimerWheel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <limits.h>
+#include <math.h>
+#include <sched.h>
 
 NV_NAMESPACE_BEGIN
 
+namespace {
+
+const int CacheLineSize = 64;
+const ulonglong NanosPerTick = 1000000;
+const ulonglong NoTimer = ULLONG_MAX;
+// Times the consumer yields to the producers before it parks
+const int ParkSpins = 2;
+
+uint RoundUpCapacity(int capacity)
+{
+    // The ring needs at least two nodes to tell a full slot from a free one
+    uint result = 2;
+    while (result < (uint) capacity) {
+        result <<= 1;
+    }
+    return result;
+}
+
+struct Node
+{
+    std::atomic<uint> sequence;
+    VEvent event;
+    // Semaphore of the sender waiting for this event to be received, if any
+    VSemaphore *received;
+    // Coalescing key and stamp, generation is 0 for ordinary events
+    VAtom key;
+    uint generation;
+};
+
+// Bounded multi-producer/single-consumer ring.
+// Every node carries a sequence number: a producer owns node (pos & mask) when
+// its sequence equals pos, and the consumer owns it when it equals pos + 1.
+// Producers claim positions with a CAS on tail, the consumer advances head
+// without any atomic read-modify-write. Batches claim and release a run of
+// nodes with a single update of tail or head.
+struct Ring
+{
+    Ring(uint capacity)
+        : capacity(capacity)
+        , mask(capacity - 1)
+        , nodes(new Node[capacity])
+        , tail(0)
+        , clearRequested(false)
+        , clearTail(0)
+        , head(0)
+        , scanned(0)
+        , discarding(false)
+        , discardUntil(0)
+    {
+        for (uint i = 0; i < capacity; i++) {
+            nodes[i].sequence.store(i, std::memory_order_relaxed);
+            nodes[i].received = nullptr;
+            nodes[i].generation = 0;
+        }
+    }
+
+    ~Ring()
+    {
+        for (uint pos = head.load(std::memory_order_relaxed); nodes[pos & mask].sequence.load(std::memory_order_acquire) == pos + 1; pos++) {
+            nodes[pos & mask].event.discard();
+        }
+        delete[] nodes;
+    }
+
+    const uint capacity;
+    const uint mask;
+    Node *nodes;
+
+    // Written by producers
+    char padding1[CacheLineSize];
+    std::atomic<uint> tail;
+    std::atomic<bool> clearRequested;
+    std::atomic<uint> clearTail;
+    char padding2[CacheLineSize];
+
+    // Written by the consumer
+    std::atomic<uint> head;
+    // End of the nodes the consumer has looked ahead at
+    uint scanned;
+    bool discarding;
+    uint discardUntil;
+    char padding3[CacheLineSize];
+
+    // Returns nullptr if the ring is full
+    Node *claim(uint &pos)
+    {
+        pos = tail.load(std::memory_order_relaxed);
+        forever {
+            Node *node = &nodes[pos & mask];
+            const uint sequence = node->sequence.load(std::memory_order_acquire);
+            const int diff = (int) (sequence - pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return node;
+                }
+            } else if (diff < 0) {
+                // The consumer hasn't released this node yet
+                return nullptr;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Claims up to count consecutive nodes with a single CAS
+    int claim(int count, uint &pos)
+    {
+        pos = tail.load(std::memory_order_relaxed);
+        forever {
+            // Nodes below head + capacity have all been released by the consumer
+            const int used = (int) (pos - head.load(std::memory_order_acquire));
+            if (used < 0) {
+                pos = tail.load(std::memory_order_relaxed);
+                continue;
+            }
+            const int claimed = std::min(count, (int) capacity - used);
+            if (claimed <= 0) {
+                return 0;
+            }
+            if (tail.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+                return claimed;
+            }
+        }
+    }
+
+    void publish(uint pos)
+    {
+        nodes[pos & mask].sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    bool isEmpty() const
+    {
+        const uint pos = head.load(std::memory_order_relaxed);
+        return nodes[pos & mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    int length() const
+    {
+        return std::max(0, (int) (tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed)));
+    }
+
+    void clear()
+    {
+        clearTail.store(tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        clearRequested.store(true, std::memory_order_release);
+    }
+
+    // Hands the ready nodes not seen by an earlier scan to visit, called
+    // by the consumer only
+    template<typename Visit>
+    void scan(Visit visit)
+    {
+        uint pos = head.load(std::memory_order_relaxed);
+        if ((int) (scanned - pos) > 0) {
+            pos = scanned;
+        }
+        forever {
+            Node &node = nodes[pos & mask];
+            if (node.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            visit(node);
+            pos++;
+        }
+        scanned = pos;
+    }
+
+    // Hands ready nodes to output until it accepted max of them, then
+    // publishes the new head once. Output returns false to drop a node.
+    // With scannedOnly, stops at the end of the last scan.
+    template<typename Output, typename Drop>
+    int pop(int max, bool scannedOnly, Output output, Drop drop)
+    {
+        discard(drop);
+
+        const uint start = head.load(std::memory_order_relaxed);
+        uint pos = start;
+        int count = 0;
+        while (count < max && (!scannedOnly || (int) (scanned - pos) > 0)) {
+            Node &node = nodes[pos & mask];
+            if (node.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+
+            if (output(node)) {
+                count++;
+            }
+            release(node, pos);
+            pos++;
+        }
+
+        if (pos != start) {
+            head.store(pos, std::memory_order_release);
+        }
+        return count;
+    }
+
+private:
+    void release(Node &node, uint pos)
+    {
+        if (node.received) {
+            node.received->post();
+            node.received = nullptr;
+        }
+        node.sequence.store(pos + capacity, std::memory_order_release);
+    }
+
+    // Drop the events posted before the last clear() call
+    template<typename Drop>
+    void discard(Drop drop)
+    {
+        if (clearRequested.load(std::memory_order_relaxed) && clearRequested.exchange(false, std::memory_order_acquire)) {
+            discardUntil = clearTail.load(std::memory_order_relaxed);
+            discarding = true;
+        }
+
+        if (!discarding) {
+            return;
+        }
+
+        uint pos = head.load(std::memory_order_relaxed);
+        while ((int) (discardUntil - pos) > 0) {
+            Node &node = nodes[pos & mask];
+            if (node.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            drop(node);
+            node.event.discard();
+            VEvent dropped(std::move(node.event));
+            release(node, pos);
+            pos++;
+        }
+        head.store(pos, std::memory_order_release);
+        discarding = (int) (discardUntil - pos) > 0;
+    }
+};
+
+struct TimedEvent
+{
+    VEvent event;
+    VEventLoop::Priority priority;
+};
+
+} //anonymous namespace
+
+// One ring per priority lane. The consumer serves the lanes in priority order
+// and only parks on a futex when all of them are empty.
+// Delayed events wait in a timer wheel with a resolution of 1 ms until the
+// consumer moves them to their lane. nextTimer lets the consumer check for
+// due timers without locking and park exactly until the next one.
 struct VEventLoop::Private
 {
     Private(int capacity)
         : shutdown(false)
-        , capacity(capacity)
-        , messages(new Node[capacity])
-        , head(0)
-        , tail(0)
+        , capacity(RoundUpCapacity(capacity))
+        , stamps(0)
+        , coalesced(0)
+        , timers(VTimer::TicksNanos() / NanosPerTick)
+        , nextTimer(NoTimer)
+        , parked(false)
+        , wakeups(0)
     {
         vAssert(capacity > 0);
 
-        for (int i = 0; i < capacity; i++) {
-            messages[i].sychronized = false;
+        for (int i = 0; i < PriorityCount; i++) {
+            lanes[i].store(nullptr, std::memory_order_relaxed);
         }
+        // Most loops never use the other lanes, those are created on demand
+        lanes[NormalPriority].store(new Ring(this->capacity), std::memory_order_relaxed);
     }
 
     ~Private()
     {
-        delete[] messages;
+        for (const TimedEvent &timed : overdue) {
+            timed.event.discard();
+        }
+        timers.clear([](TimedEvent &&timed) {
+            timed.event.discard();
+        });
+        for (int i = 0; i < PriorityCount; i++) {
+            delete lanes[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<bool> shutdown;
+    const uint capacity;
+    std::atomic<Ring *> lanes[PriorityCount];
+
+    // Stamps the coalesced events in the order they were posted, 0 until
+    // coalesce() is first called
+    std::atomic<uint> stamps;
+    std::atomic<uint> coalesced;
+    // Newest stamp of each key with a pending event the consumer has seen,
+    // only accessed by the consumer
+    VHash<uint, uint> latest;
+
+    VTimerWheel<TimedEvent> timers;
+    VMutex timerMutex;
+    std::atomic<ulonglong> nextTimer;
+    // Due timers whose lane was full, only accessed by the consumer
+    VArray<TimedEvent> overdue;
+
+    char padding[CacheLineSize];
+    std::atomic<bool> parked;
+    std::atomic<uint> wakeups;
+
+    Ring *lane(Priority priority)
+    {
+        Ring *ring = lanes[priority].load(std::memory_order_acquire);
+        if (ring == nullptr) {
+            Ring *created = new Ring(capacity);
+            if (lanes[priority].compare_exchange_strong(ring, created, std::memory_order_acq_rel)) {
+                ring = created;
+            } else {
+                delete created;
+            }
+        }
+        return ring;
     }
 
-    bool shutdown;
-    const int capacity;
+    template<typename T>
+    bool post(T &&event, Priority priority, VSemaphore *received, const VAtom *key = nullptr)
+    {
+        if (shutdown.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        return enqueue(std::forward<T>(event), priority, received, key);
+    }
 
-    struct Node
+    template<typename T>
+    bool enqueue(T &&event, Priority priority, VSemaphore *received, const VAtom *key = nullptr)
     {
-        VEvent event;
-        bool sychronized;
-    };
+        Ring *ring = lane(priority);
+        uint pos;
+        Node *node = ring->claim(pos);
+        if (node == nullptr) {
+            return false;
+        }
 
-    Node *messages;
+        node->event = std::forward<T>(event);
+        node->received = received;
+        if (key) {
+            node->key = *key;
+            node->generation = stamps.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (node->generation == 0) {
+                node->generation = stamps.fetch_add(1, std::memory_order_relaxed) + 1;
+            }
+        } else {
+            node->generation = 0;
+        }
+        ring->publish(pos);
 
-    volatile int head;
-    volatile int tail;
-    VMutex mutex;
-    VSemaphore posted;
-    VSemaphore received;
+        wake();
+        return true;
+    }
 
-    bool post(const VEvent &event, bool synchronized)
+    template<typename T>
+    void send(T &&event)
     {
-        if (shutdown) {
-            return false;
+        VSemaphore received;
+        if (post(std::forward<T>(event), NormalPriority, &received)) {
+            received.wait();
+        }
+    }
+
+    template<typename Iterator>
+    int postBatch(Iterator event, int count, Priority priority)
+    {
+        if (shutdown.load(std::memory_order_relaxed)) {
+            return 0;
         }
 
-        mutex.lock();
-        if (tail - head >= capacity) {
-            mutex.unlock();
+        Ring *ring = lane(priority);
+        uint pos;
+        const int claimed = ring->claim(count, pos);
+        for (int i = 0; i < claimed; i++, ++event) {
+            Node &node = ring->nodes[(pos + i) & ring->mask];
+            node.event = *event;
+            node.received = nullptr;
+            node.generation = 0;
+            ring->publish(pos + i);
+        }
+
+        if (claimed > 0) {
+            wake();
+        }
+        return claimed;
+    }
+
+    bool postAt(ulonglong tick, VEvent &&event, Priority priority)
+    {
+        if (shutdown.load(std::memory_order_relaxed)) {
             return false;
         }
-        const int index = tail % capacity;
-        messages[index].event = event;
-        messages[index].sychronized = synchronized;
-        tail++;
-        mutex.lock();
 
-        posted.post();
-        if (synchronized) {
-            received.wait();
+        TimedEvent timed;
+        timed.event = std::move(event);
+        timed.priority = priority;
+        {
+            VMutex::Locker locker(&timerMutex);
+            timers.insert(tick, std::move(timed), VTimer::TicksNanos() / NanosPerTick);
+            if (tick < nextTimer.load(std::memory_order_relaxed)) {
+                nextTimer.store(tick, std::memory_order_release);
+            }
         }
 
+        // A parked consumer has to recompute its timeout
+        wake();
         return true;
     }
 
-    bool post(VEvent &&event, bool synchronized)
+    // Moves the due timers to their lanes, called by the consumer only
+    void fireTimers()
     {
-        if (shutdown) {
-            return false;
+        if (!overdue.isEmpty()) {
+            VArray<TimedEvent> events;
+            events.swap(overdue);
+            for (TimedEvent &timed : events) {
+                if (!enqueue(std::move(timed.event), timed.priority, nullptr)) {
+                    overdue.append(std::move(timed));
+                }
+            }
         }
 
-        mutex.lock();
-        if (tail - head >= capacity) {
-            mutex.unlock();
+        const ulonglong next = nextTimer.load(std::memory_order_acquire);
+        if (next == NoTimer || next > VTimer::TicksNanos() / NanosPerTick) {
+            return;
+        }
+
+        VMutex::Locker locker(&timerMutex);
+        timers.advance(VTimer::TicksNanos() / NanosPerTick, [this](TimedEvent &&timed) {
+            if (!enqueue(std::move(timed.event), timed.priority, nullptr)) {
+                overdue.append(std::move(timed));
+            }
+        });
+        nextTimer.store(timers.nextTick(), std::memory_order_release);
+    }
+
+    // Called by the consumer for each coalesced event it looks ahead at
+    void note(const Node &node)
+    {
+        uint &stamp = latest[node.key.id()];
+        if (stamp == 0 || (int) (node.generation - stamp) > 0) {
+            stamp = node.generation;
+        }
+    }
+
+    // Whether the event is the newest pending one of its key. The entry of
+    // the key goes with its newest event, so only pending keys take one.
+    bool consume(const Node &node)
+    {
+        const uint stamp = latest.value(node.key.id(), 0);
+        if (stamp != node.generation) {
             return false;
         }
-        const int index = tail % capacity;
-        messages[index].event = std::move(event);
-        messages[index].sychronized = synchronized;
-        tail++;
-        mutex.unlock();
+        latest.remove(node.key.id());
+        return true;
+    }
 
-        posted.post();
-        if (synchronized) {
-            received.wait();
+    template<typename Output>
+    int pop(int max, Output output)
+    {
+        fireTimers();
+
+        // Once coalesce() has been used, the consumer looks ahead at every
+        // lane first and then only takes the events it has seen, so no newer
+        // event of a key can be missed. Producers never synchronize for it.
+        const bool coalescing = stamps.load(std::memory_order_acquire) != 0;
+        if (coalescing) {
+            for (int i = 0; i < PriorityCount; i++) {
+                Ring *ring = lanes[i].load(std::memory_order_acquire);
+                if (ring) {
+                    ring->scan([this](const Node &node) {
+                        if (node.generation) {
+                            note(node);
+                        }
+                    });
+                }
+            }
         }
 
+        int count = 0;
+        for (int i = 0; i < PriorityCount && count < max; i++) {
+            Ring *ring = lanes[i].load(std::memory_order_acquire);
+            if (ring == nullptr) {
+                continue;
+            }
+
+            count += ring->pop(max - count, coalescing, [&](Node &node) {
+                // An event stamped after the check above was never looked
+                // ahead at and is simply delivered
+                if (node.generation && coalescing && !consume(node)) {
+                    node.event.discard();
+                    VEvent dropped(std::move(node.event));
+                    coalesced.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                output(node.event);
+                return true;
+            }, [this](const Node &node) {
+                if (node.generation) {
+                    consume(node);
+                }
+            });
+        }
+        return count;
+    }
+
+    bool isEmpty() const
+    {
+        for (int i = 0; i < PriorityCount; i++) {
+            Ring *ring = lanes[i].load(std::memory_order_acquire);
+            if (ring && !ring->isEmpty()) {
+                return false;
+            }
+        }
         return true;
     }
+
+    void wake()
+    {
+        // Pairs with the fence in park(): either the consumer sees the new
+        // event or we see it parked. Only the producer which unparks it
+        // makes the system call, the others see it running.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed) && parked.exchange(false, std::memory_order_relaxed)) {
+            wakeups.fetch_add(1);
+            VFutex::Wake(&wakeups);
+        }
+    }
+
+    // Returns false if nothing arrived before the deadline
+    bool park(ulonglong deadline)
+    {
+        // Parking costs a system call on both sides, while a producer which
+        // is already running usually posts again before the consumer could
+        // go to sleep
+        int spins = 0;
+        forever {
+            fireTimers();
+            if (!isEmpty()) {
+                return true;
+            }
+            if (spins < ParkSpins) {
+                spins++;
+                sched_yield();
+                continue;
+            }
+
+            const uint ticket = wakeups.load();
+            parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (isEmpty()) {
+                const ulonglong now = VTimer::TicksNanos();
+                if (now >= deadline) {
+                    parked.store(false, std::memory_order_relaxed);
+                    return false;
+                }
+
+                ulonglong wakeUpTime = deadline;
+                const ulonglong next = nextTimer.load(std::memory_order_acquire);
+                if (next != NoTimer) {
+                    wakeUpTime = std::min(wakeUpTime, next * NanosPerTick);
+                }
+                if (wakeUpTime > now) {
+                    VFutex::Wait(&wakeups, ticket, wakeUpTime == NoTimer ? VFutex::Infinite : wakeUpTime - now);
+                }
+            }
+            parked.store(false, std::memory_order_relaxed);
+        }
+    }
 };
 
 VEventLoop::VEventLoop(int capacity)
@@ -110,116 +605,180 @@ void VEventLoop::quit()
     d->shutdown = true;
 }
 
-void VEventLoop::post(const VEvent &event)
+bool VEventLoop::post(const VEvent &event, Priority priority)
 {
-    d->post(event, false);
+    return d->post(event, priority, nullptr);
 }
 
-void VEventLoop::post(VEvent &&event)
+bool VEventLoop::post(VEvent &&event, Priority priority)
 {
-    d->post(std::move(event), false);
+    return d->post(std::move(event), priority, nullptr);
 }
 
-void VEventLoop::post(const VString &command, const VVariant &data)
+bool VEventLoop::post(const char *command, const VVariant &data)
 {
     VEvent event(command);
     event.data = data;
-    d->post(std::move(event), false);
+    return d->post(std::move(event), NormalPriority, nullptr);
 }
 
-void VEventLoop::post(const VString &command, VVariant &&data)
+bool VEventLoop::post(const char *command, VVariant &&data)
 {
     VEvent event(command);
     event.data = std::move(data);
-    d->post(std::move(event), false);
+    return d->post(std::move(event), NormalPriority, nullptr);
 }
 
-void VEventLoop::post(const char *command)
+bool VEventLoop::post(const char *command)
 {
     VEvent event(command);
-    d->post(std::move(event), false);
+    return d->post(std::move(event), NormalPriority, nullptr);
 }
 
-void VEventLoop::post(const VVariant::Function &func)
+bool VEventLoop::post(const VVariant::Function &func)
 {
     VEvent event;
     event.data = func;
-    d->post(std::move(event), false);
+    return d->post(std::move(event), NormalPriority, nullptr);
+}
+
+int VEventLoop::postBatch(const VArray<VEvent> &events, Priority priority)
+{
+    return d->postBatch(events.begin(), events.length(), priority);
+}
+
+int VEventLoop::postBatch(VArray<VEvent> &&events, Priority priority)
+{
+    return d->postBatch(std::make_move_iterator(events.begin()), events.length(), priority);
+}
+
+bool VEventLoop::postDelayed(uint msecs, VEvent &&event, Priority priority)
+{
+    const ulonglong now = VTimer::TicksNanos();
+    const ulonglong tick = (now + NanosPerTick - 1) / NanosPerTick + msecs;
+    return d->postAt(tick, std::move(event), priority);
+}
+
+bool VEventLoop::postDelayed(uint msecs, const char *command)
+{
+    return postDelayed(msecs, VEvent(command));
+}
+
+bool VEventLoop::postAt(double seconds, VEvent &&event, Priority priority)
+{
+    const ulonglong tick = (ulonglong) ceil(seconds * 1000.0);
+    return d->postAt(tick, std::move(event), priority);
+}
+
+bool VEventLoop::coalesce(const VEvent &event, Priority priority)
+{
+    return d->post(event, priority, nullptr, &event.name);
+}
+
+bool VEventLoop::coalesce(VEvent &&event, Priority priority)
+{
+    const VAtom key = event.name;
+    return d->post(std::move(event), priority, nullptr, &key);
+}
+
+bool VEventLoop::coalesce(VAtom key, VEvent &&event, Priority priority)
+{
+    return d->post(std::move(event), priority, nullptr, &key);
 }
 
 void VEventLoop::send(const VEvent &event)
 {
-    d->post(event, true);
+    d->send(event);
 }
 
 void VEventLoop::send(VEvent &&event)
 {
-    d->post(std::move(event), true);
+    d->send(std::move(event));
 }
 
-void VEventLoop::send(const VString &command, const VVariant &data)
+void VEventLoop::send(const char *command, const VVariant &data)
 {
     VEvent event(command);
     event.data = data;
-    d->post(std::move(event), true);
+    d->send(std::move(event));
 }
 
-void VEventLoop::send(const VString &command, VVariant &&data)
+void VEventLoop::send(const char *command, VVariant &&data)
 {
     VEvent event(command);
     event.data = std::move(data);
-    d->post(std::move(event), true);
+    d->send(std::move(event));
 }
 
 void VEventLoop::send(const char *command)
 {
     VEvent event(command);
-    d->post(std::move(event), true);
+    d->send(std::move(event));
 }
 
 void VEventLoop::send(const VVariant::Function &func)
 {
     VEvent event;
     event.data = func;
-    d->post(std::move(event), true);
+    d->send(std::move(event));
 }
 
 VEvent VEventLoop::next()
 {
-    d->mutex.lock();
-    if (d->tail <= d->head) {
-        d->mutex.unlock();
-        return VEvent();
-    }
-
-    const int index = d->head % d->capacity;
-    VEvent event = std::move(d->messages[index].event);
-    if (d->messages[index].sychronized) {
-        d->received.post();
-    }
-    d->messages[index].sychronized = false;
-    d->head++;
-    d->mutex.unlock();
-
+    VEvent event;
+    d->pop(1, [&](VEvent &next) {
+        event = std::move(next);
+    });
     return event;
 }
 
+int VEventLoop::drain(VArray<VEvent> &events, int max)
+{
+    return d->pop(max, [&](VEvent &next) {
+        events.append(std::move(next));
+    });
+}
+
 // Returns immediately if there is already a message in the queue.
 void VEventLoop::wait()
 {
-    d->mutex.lock();
-    if (d->tail > d->head) {
-        d->mutex.unlock();
-        return;
-    }
-    d->mutex.unlock();
+    d->park(NoTimer);
+}
 
-    d->posted.wait();
+bool VEventLoop::wait(uint msecs)
+{
+    return d->park(VTimer::TicksNanos() + msecs * NanosPerTick);
 }
 
+// May be called from any thread. The consumer drops the pending events lazily.
 void VEventLoop::clear()
 {
-    d->head = d->tail;
+    for (int i = 0; i < PriorityCount; i++) {
+        Ring *ring = d->lanes[i].load(std::memory_order_acquire);
+        if (ring) {
+            ring->clear();
+        }
+    }
+}
+
+int VEventLoop::length() const
+{
+    int result = 0;
+    for (int i = 0; i < PriorityCount; i++) {
+        result += length(static_cast<Priority>(i));
+    }
+    return result;
+}
+
+int VEventLoop::length(Priority priority) const
+{
+    Ring *ring = d->lanes[priority].load(std::memory_order_acquire);
+    return ring ? ring->length() : 0;
+}
+
+uint VEventLoop::coalescedCount() const
+{
+    return d->coalesced.load(std::memory_order_relaxed);
 }
 
 NV_NAMESPACE_END
@@ -2,37 +2,83 @@
 
 #include "VEvent.h"
 
+#include <limits.h>
+
 NV_NAMESPACE_BEGIN
 
 class VEventLoop
 {
 public:
+    //Events in a higher priority lane are always received first
+    enum Priority
+    {
+        HighPriority,
+        NormalPriority,
+        LowPriority,
+
+        PriorityCount
+    };
+
     VEventLoop(int capacity);
     ~VEventLoop();
 
     void quit();
 
-    //Send out an event
-    void post(const VEvent &event);
-    void post(VEvent &&event);
-    void post(const VString &command, const VVariant &data);
-    void post(const VString &command, VVariant &&data);
-    void post(const char *command);
-    void post(const VVariant::Function &func);
+    //Send out an event. Returns false if the loop has quit or is full.
+    //Any thread may post, but only one thread may consume the events.
+    bool post(const VEvent &event, Priority priority = NormalPriority);
+    bool post(VEvent &&event, Priority priority = NormalPriority);
+    bool post(const char *command, const VVariant &data);
+    bool post(const char *command, VVariant &&data);
+    bool post(const char *command);
+    bool post(const VVariant::Function &func);
+
+    //Send out several events at once. Returns the number of events queued,
+    //which is less than events.length() if the loop is nearly full.
+    int postBatch(const VArray<VEvent> &events, Priority priority = NormalPriority);
+    int postBatch(VArray<VEvent> &&events, Priority priority = NormalPriority);
+
+    //Send out an event once msecs have elapsed, or at the given time of
+    //VTimer::Seconds(). Timers have a resolution of 1 ms.
+    bool postDelayed(uint msecs, VEvent &&event, Priority priority = NormalPriority);
+    bool postDelayed(uint msecs, const char *command);
+    bool postAt(double seconds, VEvent &&event, Priority priority = NormalPriority);
+
+    //Send out an event which supersedes any pending event with the same key,
+    //the event name by default. Superseded events are dropped unproceeded.
+    bool coalesce(const VEvent &event, Priority priority = NormalPriority);
+    bool coalesce(VEvent &&event, Priority priority = NormalPriority);
+    bool coalesce(VAtom key, VEvent &&event, Priority priority = NormalPriority);
 
     //Send out an event and wait until it is proceeded
     void send(const VEvent &event);
     void send(VEvent &&event);
-    void send(const VString &command, const VVariant &data);
-    void send(const VString &command, VVariant &&data);
+    void send(const char *command, const VVariant &data);
+    void send(const char *command, VVariant &&data);
     void send(const char *command);
     void send(const VVariant::Function &func);
 
+    //Block until an event arrives or a delayed event is due
     void wait();
+    //Same as wait(), but returns false if nothing arrived within msecs
+    bool wait(uint msecs);
+
+    //Drop the pending events. Delayed events which are not due yet are kept.
     void clear();
 
     VEvent next();
 
+    //Move up to max pending events to the end of events.
+    //Returns the number of events moved.
+    int drain(VArray<VEvent> &events, int max = INT_MAX);
+
+    //Number of pending events, including those to be dropped
+    int length() const;
+    int length(Priority priority) const;
+
+    //Number of events dropped because a newer one was coalesced
+    uint coalescedCount() const;
+
 private:
     NV_DECLARE_PRIVATE
     NV_DISABLE_COPY(VEventLoop)
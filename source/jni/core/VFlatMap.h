@@ -0,0 +1,122 @@
+#pragma once
+
+#include "VArray.h"
+
+#include <algorithm>
+#include <utility>
+
+NV_NAMESPACE_BEGIN
+
+// A map with the API of VMap, keeping its pairs sorted in one array. Lookups
+// are binary searches over contiguous memory and iterating is a linear walk,
+// which beats a node per key for the small, read-mostly maps JSON files and
+// variants are made of. Inserting and removing move the pairs behind, and
+// invalidate iterators like VArray does.
+//
+// Keys must not be changed through iterators.
+template<typename Key, typename Value, typename Allocator = std::allocator<std::pair<Key, Value>>>
+class VFlatMap
+{
+public:
+    typedef Key KeyType;
+    typedef Value ValueType;
+    typedef std::pair<Key, Value> value_type;
+    typedef VArray<value_type, Allocator> ParentType;
+
+    typedef typename ParentType::iterator Iterator;
+    typedef typename ParentType::const_iterator ConstIterator;
+    typedef Iterator iterator;
+    typedef ConstIterator const_iterator;
+
+    VFlatMap() {}
+    explicit VFlatMap(const Allocator &allocator) : m_pairs(allocator) {}
+
+    Iterator begin() { return m_pairs.begin(); }
+    Iterator end() { return m_pairs.end(); }
+    ConstIterator begin() const { return m_pairs.begin(); }
+    ConstIterator end() const { return m_pairs.end(); }
+
+    uint size() const { return m_pairs.size(); }
+    bool empty() const { return m_pairs.isEmpty(); }
+    bool isEmpty() const { return m_pairs.isEmpty(); }
+    void clear() { m_pairs.clear(); }
+    void reserve(uint size) { m_pairs.reserve(size); }
+
+    // The first pair whose key is not less than the given one
+    Iterator lowerBound(const Key &key) { return std::lower_bound(begin(), end(), key, KeyLess); }
+    ConstIterator lowerBound(const Key &key) const { return std::lower_bound(begin(), end(), key, KeyLess); }
+
+    Iterator find(const Key &key)
+    {
+        Iterator i = lowerBound(key);
+        return i != end() && !(key < i->first) ? i : end();
+    }
+
+    ConstIterator find(const Key &key) const
+    {
+        ConstIterator i = lowerBound(key);
+        return i != end() && !(key < i->first) ? i : end();
+    }
+
+    bool contains(const Key &key) const { return find(key) != end(); }
+
+    const Value &value(const Key &key) const
+    {
+        ConstIterator i = find(key);
+        if (i != end()) {
+            return i->second;
+        }
+        static const Value defaultValue = Value();
+        return defaultValue;
+    }
+
+    Value &operator[](const Key &key)
+    {
+        Iterator i = lowerBound(key);
+        if (i == end() || key < i->first) {
+            i = m_pairs.insert(i, value_type(key, Value()));
+        }
+        return i->second;
+    }
+    const Value &operator[](const Key &key) const { return value(key); }
+
+    // Like VMap, an existing value is kept
+    void insert(const Key &key, const Value &value) { emplace(key, value); }
+    void insert(const Key &key, Value &&value) { emplace(key, std::move(value)); }
+    void insert(Key &&key, Value &&value) { emplace(std::move(key), std::move(value)); }
+
+    void remove(const Key &key)
+    {
+        Iterator i = find(key);
+        if (i != end()) {
+            m_pairs.erase(i);
+        }
+    }
+
+    Iterator erase(Iterator i) { return m_pairs.erase(i); }
+
+    bool operator == (const VFlatMap &map) const { return m_pairs == map.m_pairs; }
+    bool operator != (const VFlatMap &map) const { return m_pairs != map.m_pairs; }
+
+private:
+    static bool KeyLess(const value_type &pair, const Key &key) { return pair.first < key; }
+
+    template<typename K, typename V>
+    void emplace(K &&key, V &&value)
+    {
+        // Keys mostly come in order from files and literals, so try the end first
+        if (m_pairs.isEmpty() || m_pairs.last().first < key) {
+            m_pairs.append(value_type(std::forward<K>(key), std::forward<V>(value)));
+            return;
+        }
+
+        Iterator i = lowerBound(key);
+        if (key < i->first) {
+            m_pairs.insert(i, value_type(std::forward<K>(key), std::forward<V>(value)));
+        }
+    }
+
+    ParentType m_pairs;
+};
+
+NV_NAMESPACE_END
@@ -0,0 +1,188 @@
+#include "VFrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+NV_NAMESPACE_BEGIN
+
+struct VFrameArena::Private
+{
+    struct Block
+    {
+        char *data;
+        uint size;
+    };
+
+    // The last block is the one being filled
+    VArray<Block> blocks;
+    char *top;
+    char *end;
+    // Filled up space of the blocks before the last one
+    uint usedBefore;
+    uint blockSize;
+
+    uint lastFrameBytes;
+    uint peakBytes;
+    uint frameCount;
+
+    static thread_local VFrameArena *current;
+
+    Private(uint blockSize)
+        : top(nullptr)
+        , end(nullptr)
+        , usedBefore(0)
+        , blockSize(blockSize)
+        , lastFrameBytes(0)
+        , peakBytes(0)
+        , frameCount(0)
+    {
+        addBlock(blockSize);
+    }
+
+    ~Private()
+    {
+        for (const Block &block : blocks) {
+            free(block.data);
+        }
+    }
+
+    void addBlock(uint size)
+    {
+        if (!blocks.isEmpty()) {
+            usedBefore += top - blocks.last().data;
+        }
+        Block block;
+        block.data = static_cast<char *>(malloc(size));
+        block.size = size;
+        blocks.append(block);
+        top = block.data;
+        end = block.data + size;
+    }
+
+    uint bytesUsed() const
+    {
+        return usedBefore + (top - blocks.last().data);
+    }
+};
+
+thread_local VFrameArena *VFrameArena::Private::current = nullptr;
+
+VFrameArena::VFrameArena(uint blockSize)
+    : d(new Private(blockSize))
+{
+}
+
+VFrameArena::~VFrameArena()
+{
+    if (Private::current == this) {
+        Private::current = nullptr;
+    }
+    delete d;
+}
+
+void *VFrameArena::allocate(uint size, uint alignment)
+{
+    if (size > d->blockSize / 2) {
+        return ::operator new(size);
+    }
+
+    const uintptr_t mask = alignment - 1;
+    char *start = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(d->top) + mask) & ~mask);
+    if (start + size > d->end) {
+        d->addBlock(d->blockSize);
+        start = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(d->top) + mask) & ~mask);
+    }
+    d->top = start + size;
+    return start;
+}
+
+void VFrameArena::deallocate(void *pointer, uint size)
+{
+    char *start = static_cast<char *>(pointer);
+    if (start + size == d->top && start >= d->blocks.last().data) {
+        d->top = start;
+    } else if (size > d->blockSize / 2) {
+        ::operator delete(pointer);
+    }
+}
+
+bool VFrameArena::owns(const void *pointer) const
+{
+    const char *p = static_cast<const char *>(pointer);
+    for (const Private::Block &block : d->blocks) {
+        if (p >= block.data && p < block.data + block.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void VFrameArena::reset()
+{
+    d->lastFrameBytes = d->bytesUsed();
+    d->peakBytes = std::max(d->peakBytes, d->lastFrameBytes);
+    d->frameCount++;
+
+    // Grow to what the frame took, so the next one fits in one block
+    if (d->blocks.size() > 1) {
+        const uint size = capacity();
+        for (const Private::Block &block : d->blocks) {
+            free(block.data);
+        }
+        d->blocks.clear();
+        d->usedBefore = 0;
+        d->blockSize = std::max(d->blockSize, size);
+        d->addBlock(size);
+    } else {
+        d->top = d->blocks.last().data;
+    }
+}
+
+void VFrameArena::makeCurrent()
+{
+    Private::current = this;
+}
+
+void VFrameArena::doneCurrent()
+{
+    if (Private::current == this) {
+        Private::current = nullptr;
+    }
+}
+
+VFrameArena *VFrameArena::current()
+{
+    return Private::current;
+}
+
+uint VFrameArena::bytesUsed() const
+{
+    return d->bytesUsed();
+}
+
+uint VFrameArena::lastFrameBytes() const
+{
+    return d->lastFrameBytes;
+}
+
+uint VFrameArena::peakBytes() const
+{
+    return d->peakBytes;
+}
+
+uint VFrameArena::capacity() const
+{
+    uint size = 0;
+    for (const Private::Block &block : d->blocks) {
+        size += block.size;
+    }
+    return size;
+}
+
+uint VFrameArena::frameCount() const
+{
+    return d->frameCount;
+}
+
+NV_NAMESPACE_END
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "VArray.h"
+
+#include <cstddef>
+#include <new>
+#include <string>
+
+NV_NAMESPACE_BEGIN
+
+// A monotonic allocator for data which doesn't outlive the frame. Allocating
+// bumps a pointer and nothing is given back until reset(), which the VR
+// thread calls once per frame. A frame outgrowing the block chains more
+// blocks on, and reset() merges them into one, so a steady frame doesn't
+// touch the heap at all. Requests larger than half a block go to the heap.
+//
+// An arena belongs to one thread. current() returns it on the thread it was
+// made current on and null everywhere else.
+class VFrameArena
+{
+public:
+    VFrameArena(uint blockSize = 64 * 1024);
+    ~VFrameArena();
+
+    // What malloc() guarantees. GCC 4.8 has no std::max_align_t.
+    enum { DefaultAlignment = alignof(long double) };
+
+    void *allocate(uint size, uint alignment = DefaultAlignment);
+    // Only the latest allocation is taken back, so an array growing at the
+    // end of the arena keeps its space
+    void deallocate(void *pointer, uint size);
+    bool owns(const void *pointer) const;
+
+    // Everything allocated before is invalid afterwards
+    void reset();
+
+    void makeCurrent();
+    void doneCurrent();
+    static VFrameArena *current();
+
+    // Bytes handed out since the last reset, by the last frame and by the
+    // largest frame so far. Requests which went to the heap aren't counted.
+    uint bytesUsed() const;
+    uint lastFrameBytes() const;
+    uint peakBytes() const;
+    uint capacity() const;
+    uint frameCount() const;
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VFrameArena)
+};
+
+// Standard allocator on top of a VFrameArena, or on the heap if there is no
+// arena, which is the case outside the VR thread. Containers using it must be
+// gone before the arena is reset.
+template<class T>
+class VFrameAllocator
+{
+public:
+    typedef T value_type;
+
+    template<class U>
+    struct rebind { typedef VFrameAllocator<U> other; };
+
+    VFrameAllocator(VFrameArena *arena = VFrameArena::current())
+        : m_arena(arena)
+    {
+    }
+
+    template<class U>
+    VFrameAllocator(const VFrameAllocator<U> &source)
+        : m_arena(source.arena())
+    {
+    }
+
+    VFrameArena *arena() const { return m_arena; }
+
+    T *allocate(std::size_t n)
+    {
+        if (m_arena) {
+            return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, std::size_t n)
+    {
+        if (m_arena) {
+            m_arena->deallocate(pointer, n * sizeof(T));
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    template<class U>
+    bool operator == (const VFrameAllocator<U> &allocator) const { return m_arena == allocator.arena(); }
+    template<class U>
+    bool operator != (const VFrameAllocator<U> &allocator) const { return m_arena != allocator.arena(); }
+
+private:
+    VFrameArena *m_arena;
+};
+
+// Growing only takes back the old buffer if it is still the latest
+// allocation, which it isn't once the new one is made. Each reallocation
+// leaves the old buffer in the arena until reset(), so reserve() the final
+// size up front where it is known.
+template<class E>
+using VFrameArray = VArray<E, VFrameAllocator<E>>;
+
+// VString derives from std::u16string and can't change its allocator, so
+// frame temporaries use this and VStringView(data(), size()) to be passed on
+typedef std::basic_string<char16_t, std::char_traits<char16_t>, VFrameAllocator<char16_t>> VFrameString;
+
+NV_NAMESPACE_END
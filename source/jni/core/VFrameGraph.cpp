@@ -0,0 +1,250 @@
+#include "VFrameGraph.h"
+#include "VDeque.h"
+#include "VLog.h"
+#include "VMutex.h"
+#include "VSemaphore.h"
+#include "VThreadPool.h"
+#include "VTimer.h"
+
+#include <atomic>
+
+NV_NAMESPACE_BEGIN
+
+struct VFrameGraph::Private : public std::enable_shared_from_this<VFrameGraph::Private>
+{
+    struct Stage
+    {
+        VString name;
+        Job job;
+        Affinity affinity;
+        VArray<int> dependencies;
+        VArray<int> dependents;
+
+        std::atomic<int> remaining;
+        double start;
+        double finish;
+
+        Stage()
+            : affinity(AnyThread)
+            , remaining(0)
+            , start(0.0)
+            , finish(0.0)
+        {
+        }
+    };
+
+    VThreadPool *pool;
+    VArray<Stage *> stages;
+
+    VMutex mutex;
+    VDeque<int> ready;
+    VDeque<int> callerReady;
+    // Posted when a caller stage becomes ready or the last stage is finished,
+    // the only times the caller has to wake up
+    VSemaphore wakeup;
+    std::atomic<int> finished;
+
+    double elapsed;
+    double criticalPath;
+    VArray<int> criticalStages;
+
+    Private(VThreadPool *pool)
+        : pool(pool)
+        , mutex(false)
+        , finished(0)
+        , elapsed(0.0)
+        , criticalPath(0.0)
+    {
+    }
+
+    ~Private()
+    {
+        for (Stage *stage : stages) {
+            delete stage;
+        }
+    }
+
+    void schedule(int index)
+    {
+        const bool anyThread = stages[index]->affinity == AnyThread;
+        mutex.lock();
+        (anyThread ? ready : callerReady).append(index);
+        mutex.unlock();
+
+        if (anyThread) {
+            // The caller may take the stage first, then the task finds nothing
+            std::shared_ptr<Private> self = shared_from_this();
+            pool->run([self]{
+                int index;
+                if (self->take(false, index)) {
+                    self->execute(index);
+                }
+            });
+        } else {
+            wakeup.post();
+        }
+    }
+
+    bool take(bool caller, int &index)
+    {
+        mutex.lock();
+        bool found = true;
+        if (caller && !callerReady.isEmpty()) {
+            index = callerReady.takeFirst();
+        } else if (!ready.isEmpty()) {
+            index = ready.takeFirst();
+        } else {
+            found = false;
+        }
+        mutex.unlock();
+        return found;
+    }
+
+    void execute(int index)
+    {
+        Stage *stage = stages[index];
+        stage->start = VTimer::Seconds();
+        stage->job();
+        stage->finish = VTimer::Seconds();
+
+        for (int dependent : stage->dependents) {
+            if (stages[dependent]->remaining.fetch_sub(1) == 1) {
+                schedule(dependent);
+            }
+        }
+        if (finished.fetch_add(1) + 1 == stages.length()) {
+            wakeup.post();
+        }
+    }
+
+    void updateCriticalPath()
+    {
+        // Stages are added in a topological order
+        const int stageNum = stages.length();
+        VArray<double> length;
+        VArray<int> previous;
+        length.resize(stageNum);
+        previous.resize(stageNum);
+
+        int last = 0;
+        for (int i = 0; i < stageNum; i++) {
+            const Stage *stage = stages[i];
+            double longest = 0.0;
+            previous[i] = -1;
+            for (int dependency : stage->dependencies) {
+                if (length[dependency] > longest) {
+                    longest = length[dependency];
+                    previous[i] = dependency;
+                }
+            }
+            length[i] = longest + stage->finish - stage->start;
+            if (length[i] > length[last]) {
+                last = i;
+            }
+        }
+
+        criticalPath = length[last];
+        criticalStages.clear();
+        for (int i = last; i >= 0; i = previous[i]) {
+            criticalStages.insert(criticalStages.begin(), i);
+        }
+    }
+};
+
+VFrameGraph::VFrameGraph(VThreadPool *pool)
+    : d(new Private(pool ? pool : VThreadPool::instance()))
+{
+}
+
+VFrameGraph::~VFrameGraph()
+{
+}
+
+int VFrameGraph::addStage(const VString &name, const Job &job, std::initializer_list<int> dependencies, Affinity affinity)
+{
+    const int index = d->stages.length();
+    Private::Stage *stage = new Private::Stage;
+    stage->name = name;
+    stage->job = job;
+    stage->affinity = affinity;
+    for (int dependency : dependencies) {
+        vAssert(dependency >= 0 && dependency < index);
+        stage->dependencies.append(dependency);
+        d->stages[dependency]->dependents.append(index);
+    }
+    d->stages.append(stage);
+    return index;
+}
+
+int VFrameGraph::stageCount() const
+{
+    return d->stages.length();
+}
+
+const VString &VFrameGraph::stageName(int stage) const
+{
+    return d->stages[stage]->name;
+}
+
+void VFrameGraph::run()
+{
+    const int stageNum = d->stages.length();
+    if (stageNum <= 0) {
+        return;
+    }
+
+    const double start = VTimer::Seconds();
+    // Posts for stages the caller took without waiting are left from the last
+    // frame. Nothing else posts between frames.
+    while (d->wakeup.available() > 0) {
+        d->wakeup.wait();
+    }
+    d->finished = 0;
+    for (Private::Stage *stage : d->stages) {
+        stage->remaining = stage->dependencies.length();
+    }
+    for (int i = 0; i < stageNum; i++) {
+        if (d->stages[i]->dependencies.isEmpty()) {
+            d->schedule(i);
+        }
+    }
+
+    // Run the stages pinned to this thread and help with the others
+    forever {
+        int index;
+        if (d->take(true, index)) {
+            d->execute(index);
+            continue;
+        }
+        if (d->finished.load() >= stageNum) {
+            break;
+        }
+        d->wakeup.wait();
+    }
+
+    d->elapsed = VTimer::Seconds() - start;
+    d->updateCriticalPath();
+}
+
+double VFrameGraph::stageTime(int stage) const
+{
+    const Private::Stage *s = d->stages[stage];
+    return s->finish - s->start;
+}
+
+double VFrameGraph::elapsed() const
+{
+    return d->elapsed;
+}
+
+double VFrameGraph::criticalPath() const
+{
+    return d->criticalPath;
+}
+
+const VArray<int> &VFrameGraph::criticalStages() const
+{
+    return d->criticalStages;
+}
+
+NV_NAMESPACE_END
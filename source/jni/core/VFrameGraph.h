@@ -0,0 +1,57 @@
+#pragma once
+
+#include "VArray.h"
+#include "VString.h"
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+
+NV_NAMESPACE_BEGIN
+
+class VThreadPool;
+
+// A fixed set of stages with declared dependencies, built once and run every
+// frame. Stages without a dependency path between them run in parallel on a
+// thread pool and run() returns once all of them are done.
+class VFrameGraph
+{
+public:
+    typedef std::function<void()> Job;
+
+    enum Affinity
+    {
+        AnyThread,
+        // For stages which use the GL context or the JNI environment
+        CallerThread
+    };
+
+    // Uses VThreadPool::instance() if pool is null
+    VFrameGraph(VThreadPool *pool = nullptr);
+    ~VFrameGraph();
+
+    // Dependencies must have been added before, so the graph can't have a cycle
+    int addStage(const VString &name, const Job &job, std::initializer_list<int> dependencies = {}, Affinity affinity = AnyThread);
+
+    int stageCount() const;
+    const VString &stageName(int stage) const;
+
+    void run();
+
+    // Timings of the last run() in seconds
+    double stageTime(int stage) const;
+    double elapsed() const;
+
+    // The longest chain of dependent stages by their own run time, which is
+    // what the frame would take with enough workers
+    double criticalPath() const;
+    const VArray<int> &criticalStages() const;
+
+private:
+    // Shared with the pool tasks, which may outlive run()
+    struct Private;
+    std::shared_ptr<Private> d;
+    NV_DISABLE_COPY(VFrameGraph)
+};
+
+NV_NAMESPACE_END
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "vglobal.h"
+
+#include <atomic>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+NV_NAMESPACE_BEGIN
+
+// Process-private futex calls for the primitives built on 32-bit atomics
+class VFutex
+{
+public:
+    static const ulonglong Infinite = ULLONG_MAX;
+
+    // Sleep while *word still holds the expected value, at most for timeout
+    // nanoseconds. Returns false if the timeout expired. Spurious wake-ups are
+    // allowed.
+    template<typename T>
+    static bool Wait(std::atomic<T> *word, T expected, ulonglong timeout = Infinite)
+    {
+        static_assert(sizeof(std::atomic<T>) == sizeof(int), "A futex is a 32-bit word");
+        timespec duration;
+        timespec *limit = nullptr;
+        if (timeout != Infinite) {
+            duration.tv_sec = timeout / 1000000000;
+            duration.tv_nsec = timeout % 1000000000;
+            limit = &duration;
+        }
+        if (syscall(SYS_futex, reinterpret_cast<int *>(word), FUTEX_WAIT_PRIVATE, (int) expected, limit, nullptr, 0) != 0) {
+            return errno != ETIMEDOUT;
+        }
+        return true;
+    }
+
+    template<typename T>
+    static void Wake(std::atomic<T> *word, int count = INT_MAX)
+    {
+        syscall(SYS_futex, reinterpret_cast<int *>(word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+    // Tells the core it is in a spin loop
+    static void Relax()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+    // Times to look at a word before parking, which covers a short critical
+    // section on another core. With a single core the owner cannot run while
+    // we spin, so we park at once.
+    static int SpinCount()
+    {
+        static const int count = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 100 : 0;
+        return count;
+    }
+};
+
+NV_NAMESPACE_END
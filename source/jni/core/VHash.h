@@ -0,0 +1,307 @@
+#pragma once
+
+#include "vglobal.h"
+#include "VArray.h"
+
+#include <functional>
+#include <utility>
+
+NV_NAMESPACE_BEGIN
+
+// Hash and equality used by VHash. Another traits class may add overloads of
+// Hash() and Equal() for other types, which can then be looked up without
+// building a Key.
+template<class Key>
+struct VHashTraits
+{
+    static uint Hash(const Key &key) { return (uint) std::hash<Key>()(key); }
+    static bool Equal(const Key &key, const Key &other) { return key == other; }
+};
+
+// Open addressing with linear probing. The hashes are cached apart from the
+// pairs, so probing walks a dense array of integers and growing never hashes
+// a key again. Unlike VMap, the order of iteration is not defined and
+// insert() replaces an existing value.
+template<class Key, class Value, class Traits = VHashTraits<Key> >
+class VHash
+{
+public:
+    typedef Key KeyType;
+    typedef Value ValueType;
+    typedef std::pair<Key, Value> Pair;
+
+    template<class P>
+    class BasicIterator
+    {
+    public:
+        BasicIterator(P *pair, const uint *hash, const uint *end)
+            : m_pair(pair)
+            , m_hash(hash)
+            , m_end(end)
+        {
+            skipEmpty();
+        }
+
+        P &operator*() const { return *m_pair; }
+        P *operator->() const { return m_pair; }
+
+        BasicIterator &operator++()
+        {
+            m_pair++;
+            m_hash++;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator == (const BasicIterator &other) const { return m_hash == other.m_hash; }
+        bool operator != (const BasicIterator &other) const { return m_hash != other.m_hash; }
+
+    private:
+        void skipEmpty()
+        {
+            while (m_hash != m_end && *m_hash == 0) {
+                m_pair++;
+                m_hash++;
+            }
+        }
+
+        P *m_pair;
+        const uint *m_hash;
+        const uint *m_end;
+    };
+
+    typedef BasicIterator<Pair> Iterator;
+    typedef BasicIterator<const Pair> ConstIterator;
+
+    VHash()
+        : m_size(0)
+        , m_shift(32)
+    {
+    }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    int capacity() const { return m_hashes.length(); }
+
+    void clear()
+    {
+        m_hashes.clear();
+        m_pairs.clear();
+        m_size = 0;
+        m_shift = 32;
+    }
+
+    void reserve(int size)
+    {
+        if (size * 4 > capacity() * 3) {
+            int newCapacity = MinCapacity;
+            while (size * 4 > newCapacity * 3) {
+                newCapacity *= 2;
+            }
+            rehash(newCapacity);
+        }
+    }
+
+    template<class K>
+    bool contains(const K &key) const { return indexOf(key) >= 0; }
+
+    template<class K>
+    Iterator find(const K &key)
+    {
+        const int index = indexOf(key);
+        return index < 0 ? end() : iteratorAt(index);
+    }
+
+    template<class K>
+    ConstIterator find(const K &key) const
+    {
+        const int index = indexOf(key);
+        return index < 0 ? end() : iteratorAt(index);
+    }
+
+    template<class K>
+    const Value &value(const K &key) const
+    {
+        const int index = indexOf(key);
+        return index < 0 ? DefaultValue() : m_pairs[index].second;
+    }
+
+    template<class K>
+    Value value(const K &key, const Value &defaultValue) const
+    {
+        const int index = indexOf(key);
+        return index < 0 ? defaultValue : m_pairs[index].second;
+    }
+
+    Value &operator[](const Key &key)
+    {
+        const uint hash = HashOf(key);
+        int index = indexOf(key, hash);
+        if (index < 0) {
+            index = add(hash, Pair(key, Value()));
+        }
+        return m_pairs[index].second;
+    }
+
+    const Value &operator[](const Key &key) const { return value(key); }
+
+    void insert(const Key &key, const Value &value)
+    {
+        const uint hash = HashOf(key);
+        const int index = indexOf(key, hash);
+        if (index < 0) {
+            add(hash, Pair(key, value));
+        } else {
+            m_pairs[index].second = value;
+        }
+    }
+
+    void insert(const Key &key, Value &&value)
+    {
+        const uint hash = HashOf(key);
+        const int index = indexOf(key, hash);
+        if (index < 0) {
+            add(hash, Pair(key, std::move(value)));
+        } else {
+            m_pairs[index].second = std::move(value);
+        }
+    }
+
+    template<class K>
+    bool remove(const K &key)
+    {
+        int index = indexOf(key);
+        if (index < 0) {
+            return false;
+        }
+
+        // Shift the following entries back instead of leaving a tombstone
+        const uint mask = m_hashes.size() - 1;
+        uint hole = index;
+        uint next = hole;
+        forever {
+            next = (next + 1) & mask;
+            if (m_hashes[next] == 0) {
+                break;
+            }
+            const uint home = slotOf(m_hashes[next]);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                m_hashes[hole] = m_hashes[next];
+                m_pairs[hole] = std::move(m_pairs[next]);
+                hole = next;
+            }
+        }
+        m_hashes[hole] = 0;
+        m_pairs[hole] = Pair();
+        m_size--;
+        return true;
+    }
+
+    Iterator begin() { return iteratorAt(0); }
+    Iterator end() { return iteratorAt(m_hashes.size()); }
+    ConstIterator begin() const { return iteratorAt(0); }
+    ConstIterator end() const { return iteratorAt(m_hashes.size()); }
+
+private:
+    enum { MinCapacity = 8 };
+
+    template<class K>
+    static uint HashOf(const K &key)
+    {
+        const uint hash = Traits::Hash(key);
+        return hash ? hash : 1;
+    }
+
+    static const Value &DefaultValue()
+    {
+        static const Value value = Value();
+        return value;
+    }
+
+    // Fibonacci hashing spreads weak hashes such as small integers
+    uint slotOf(uint hash) const { return (hash * 2654435769u) >> m_shift; }
+
+    template<class K>
+    int indexOf(const K &key) const
+    {
+        return m_size == 0 ? -1 : indexOf(key, HashOf(key));
+    }
+
+    template<class K>
+    int indexOf(const K &key, uint hash) const
+    {
+        if (m_size == 0) {
+            return -1;
+        }
+        const uint mask = m_hashes.size() - 1;
+        for (uint i = slotOf(hash); ; i = (i + 1) & mask) {
+            const uint slot = m_hashes[i];
+            if (slot == 0) {
+                return -1;
+            }
+            if (slot == hash && Traits::Equal(m_pairs[i].first, key)) {
+                return i;
+            }
+        }
+    }
+
+    int add(uint hash, Pair &&pair)
+    {
+        if ((m_size + 1) * 4 > capacity() * 3) {
+            rehash(capacity() ? capacity() * 2 : (int) MinCapacity);
+        }
+        const int index = place(hash);
+        m_pairs[index] = std::move(pair);
+        m_size++;
+        return index;
+    }
+
+    int place(uint hash)
+    {
+        const uint mask = m_hashes.size() - 1;
+        uint i = slotOf(hash);
+        while (m_hashes[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        m_hashes[i] = hash;
+        return i;
+    }
+
+    void rehash(int newCapacity)
+    {
+        VArray<uint> hashes;
+        VArray<Pair> pairs;
+        hashes.swap(m_hashes);
+        pairs.swap(m_pairs);
+
+        m_hashes.resize(newCapacity, 0);
+        m_pairs.resize(newCapacity);
+        m_shift = 32;
+        for (int i = newCapacity; i > 1; i >>= 1) {
+            m_shift--;
+        }
+
+        for (uint i = 0; i < hashes.size(); i++) {
+            if (hashes[i]) {
+                m_pairs[place(hashes[i])] = std::move(pairs[i]);
+            }
+        }
+    }
+
+    Iterator iteratorAt(uint index)
+    {
+        return Iterator(m_pairs.data() + index, m_hashes.data() + index, m_hashes.data() + m_hashes.size());
+    }
+
+    ConstIterator iteratorAt(uint index) const
+    {
+        return ConstIterator(m_pairs.data() + index, m_hashes.data() + index, m_hashes.data() + m_hashes.size());
+    }
+
+    VArray<uint> m_hashes;
+    VArray<Pair> m_pairs;
+    int m_size;
+    uint m_shift;
+};
+
+NV_NAMESPACE_END
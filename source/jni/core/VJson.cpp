@@ -1,82 +1,100 @@
 #include "VJson.h"
 
 #include "VByteArray.h"
+#include "VJsonReader.h"
 #include "VLog.h"
+#include "VMessagePack.h"
+#include "VPath.h"
 
+#include <algorithm>
 #include <sstream>
 #include <fstream>
+#include <iterator>
 
 NV_NAMESPACE_BEGIN
 
 VJson::VJson()
     : m_type(Null)
+    , m_borrowed(false)
+    , m_value()
 {
 }
 
 VJson::VJson(bool value)
     : m_type(Boolean)
+    , m_borrowed(false)
 {
     m_value.boolean = value;
 }
 
 VJson::VJson(int value)
     : m_type(Number)
+    , m_borrowed(false)
 {
     m_value.number = value;
 }
 
 VJson::VJson(double value)
     : m_type(Number)
+    , m_borrowed(false)
 {
     m_value.number = value;
 }
 
 VJson::VJson(const char *value)
+    : m_type(String)
+    , m_borrowed(false)
 {
-    m_type = String;
     m_value.str = new VString(value);
 }
 
 VJson::VJson(const std::string &value)
     : m_type(String)
+    , m_borrowed(false)
 {
     m_value.str = new VString(value);
 }
 
 VJson::VJson(const VString &value)
     : m_type(String)
+    , m_borrowed(false)
 {
     m_value.str = new VString(value);
 }
 
 VJson::VJson(VString &&value)
     : m_type(String)
+    , m_borrowed(false)
 {
-    m_value.str = new VString(value);
+    m_value.str = new VString(std::move(value));
 }
 
 VJson::VJson(const VJsonArray &array)
     : m_type(Array)
+    , m_borrowed(false)
 {
     m_value.array = new VJsonArray(array);
 }
 
 VJson::VJson(VJsonArray &&array)
     : m_type(Array)
+    , m_borrowed(false)
 {
-    m_value.array = new VJsonArray(array);
+    m_value.array = new VJsonArray(std::move(array));
 }
 
 VJson::VJson(const VJsonObject &object)
     : m_type(Object)
+    , m_borrowed(false)
 {
     m_value.object = new VJsonObject(object);
 }
 
 VJson::VJson(VJsonObject &&object)
     : m_type(Object)
+    , m_borrowed(false)
 {
-    m_value.object = new VJsonObject(object);
+    m_value.object = new VJsonObject(std::move(object));
 }
 
 VJson::VJson(const VJson &source)
@@ -84,10 +102,14 @@ VJson::VJson(const VJson &source)
     copy(source);
 }
 
-VJson::VJson(VJson &&source)
+// A document node moved out would point into the document, and copying it
+// instead could throw, so its nodes are only ever copied
+VJson::VJson(VJson &&source) noexcept
     : m_type(source.m_type)
+    , m_borrowed(false)
     , m_value(source.m_value)
 {
+    vAssert(!source.m_borrowed);
     source.m_type = Null;
 }
 
@@ -209,10 +231,12 @@ VJson &VJson::operator =(const VJson &source)
     return *this;
 }
 
-VJson &VJson::operator = (VJson &&source)
+VJson &VJson::operator = (VJson &&source) noexcept
 {
+    vAssert(!source.m_borrowed);
     release();
     m_type = source.m_type;
+    m_borrowed = false;
     m_value = source.m_value;
     source.m_type = Null;
     return *this;
@@ -225,6 +249,50 @@ const VJson &VJson::value(const VString &key, const VJson &defaultValue) const
 	return defaultValue;
 }
 
+namespace {
+    // Binary search over the sorted pairs, comparing the keys as views
+    template<class Key>
+    const VJson *FindValue(const VJsonObject &object, const Key &key)
+    {
+        VJsonObject::ConstIterator i = std::lower_bound(object.begin(), object.end(), key,
+                [](const VJsonObject::value_type &pair, const Key &key) {
+            return VStringView(pair.first).compare(key) < 0;
+        });
+        if (i != object.end() && VStringView(i->first).compare(key) == 0) {
+            return &i->second;
+        }
+        return nullptr;
+    }
+
+    const VJson &NullValue()
+    {
+        static const VJson null;
+        return null;
+    }
+}
+
+// Decoded once rather than in every comparison of the search
+const VJson &VJson::value(VByteArrayView key) const
+{
+    return value(VDecodedUtf8(key).view());
+}
+
+const VJson &VJson::value(VStringView key) const
+{
+    const VJson *value = FindValue(*m_value.object, key);
+    return value ? *value : NullValue();
+}
+
+bool VJson::contains(VByteArrayView key) const
+{
+    return contains(VDecodedUtf8(key).view());
+}
+
+bool VJson::contains(VStringView key) const
+{
+    return FindValue(*m_value.object, key) != nullptr;
+}
+
 uint VJson::size() const
 {
 	if (isArray())
@@ -247,8 +315,12 @@ void VJson::clear()
     }
 }
 
+// The payload of a document node belongs to the document
 void VJson::release()
 {
+    if (m_borrowed) {
+        return;
+    }
     if (m_type == Array) {
         delete m_value.array;
     } else if (m_type == Object) {
@@ -261,144 +333,129 @@ void VJson::release()
 namespace
 {
 
-bool json_try_read(std::istream &in, char ch)
+// Builds the tree from the reader's events. Open containers and their keys
+// are kept on stacks and attached to their parent once they are complete.
+class DomBuilder : public VJsonHandler
 {
-    char first;
-    do {
-        in.get(first);
-    } while (isspace(first));
+public:
+    VJson root;
+
+    bool null() override { return add(VJson()); }
+    bool boolean(bool value) override { return add(VJson(value)); }
+    bool number(double value) override { return add(VJson(value)); }
+    bool string(VByteArrayView value) override { return add(VJson(VString::fromUtf8(value.data(), value.size()))); }
 
-    if (first == ch)
+    bool startObject() override
+    {
+        m_containers.append(VJson(VJsonObject()));
         return true;
+    }
 
-    in.unget();
-    return false;
-}
+    bool key(VByteArrayView name) override
+    {
+        m_keys.append(VString::fromUtf8(name.data(), name.size()));
+        return true;
+    }
 
-bool json_try_read(std::istream &in, const char *str)
-{
-    char first;
-    do {
-        in.get(first);
-    } while (isspace(first));
+    bool endObject() override { return close(); }
 
-    const char *cur = str;
-    if (*cur != first) {
-        in.unget();
-        return false;
+    bool startArray() override
+    {
+        m_containers.append(VJson(VJsonArray()));
+        return true;
     }
 
-    cur++;
-    while (*cur) {
-        if (json_try_read(in, *cur)) {
-            cur++;
+    bool endArray() override { return close(); }
+
+private:
+    bool add(VJson &&value)
+    {
+        if (m_containers.isEmpty()) {
+            root = std::move(value);
+        } else if (m_containers.last().isArray()) {
+            m_containers.last().array().append(std::move(value));
         } else {
-            while (cur != str) {
-                cur--;
-                in.putback(*cur);
-            }
-            return false;
+            m_containers.last().object().insert(std::move(m_keys.last()), std::move(value));
+            m_keys.removeLast();
+        }
+        return true;
+    }
+
+    bool close()
+    {
+        VJson value = std::move(m_containers.last());
+        m_containers.removeLast();
+        return add(std::move(value));
+    }
+
+    VArray<VJson> m_containers;
+    VArray<VString> m_keys;
+};
+
+// Parses and logs the first error with its offset. A partly parsed value is
+// dropped.
+VJson ParseBuffer(const char *data, uint size, uint *consumed = nullptr)
+{
+    VJsonReader reader(data, size);
+    DomBuilder builder;
+    if (!reader.parse(&builder)) {
+        vError("JSON: " << reader.error() << " at offset " << reader.errorOffset());
+        builder.root = VJson();
+    }
+    if (consumed) {
+        *consumed = reader.offset();
+    }
+    return std::move(builder.root);
+}
+
+void WriteBinary(VMessagePackWriter &writer, const VJson &value)
+{
+    switch (value.type()) {
+    case VJson::Null:
+        writer.writeNil();
+        break;
+    case VJson::Boolean:
+        writer.writeBool(value.toBool());
+        break;
+    case VJson::Number:
+        writer.writeNumber(value.toDouble());
+        break;
+    case VJson::String:
+        writer.writeString(value.toString());
+        break;
+    case VJson::Array:
+        writer.startArray(value.size());
+        for (const VJson &element : value.toArray()) {
+            WriteBinary(writer, element);
+        }
+        break;
+    case VJson::Object:
+        writer.startMap(value.size());
+        for (const VJsonObject::value_type &pair : value.toObject()) {
+            writer.writeString(pair.first);
+            WriteBinary(writer, pair.second);
         }
+        break;
     }
-    return true;
 }
 
 }
 
+// The rest of the stream is read into a buffer, and the stream is moved back to
+// right after the value where it can seek
 std::istream &operator>>(std::istream &in, VJson &value)
 {
     if (value.type() != VJson::Null)
         return in;
 
-    if (json_try_read(in, "null")) {
-        value.m_type = VJson::Null;
-    } else if (json_try_read(in, "false")) {
-        value.m_type = VJson::Boolean;
-        value.m_value.boolean = false;
-    } else if (json_try_read(in, "true")) {
-        value.m_type = VJson::Boolean;
-        value.m_value.boolean = true;
-    } else if (json_try_read(in, '"')) {
-        value.m_type = VJson::String;
-        std::string str;
-        char ch;
-        while (!in.eof()) {
-            in.get(ch);
-            if (ch == '\\') {
-                in.get(ch);
-                if (ch == '"') {
-                    str += ch;
-                    continue;
-                }
-            } else if (ch == '"') {
-                break;
-            }
-            str += ch;
-        }
-        value.m_value.str = new VString(VString::fromUtf8(str));
-    } else {
-        char ch;
-        in.get(ch);
-        if (ch == '-' || (ch >= '0' && ch <= '9') || ch == '.') {
-            in.unget();
-            value.m_type = VJson::Number;
-            in >> value.m_value.number;
-        } else if (ch == '[') {
-            value.m_type = VJson::Array;
-            value.m_value.array = new VJsonArray();
-            if (json_try_read(in, ']')) {
-                return in;
-            }
-
-            VJsonArray &array = (*value.m_value.array);
-            while (true) {
-                VJson element;
-                in >> element;
-                array.append(std::move(element));
-
-                if (!json_try_read(in, ',')) {
-                    if (!(json_try_read(in, ']'))) {
-                        vError("Expect ]");
-                    } else {
-                        break;
-                    }
-                }
-            }
-        } else if (ch == '{') {
-            value.m_type = VJson::Object;
-            value.m_value.object = new VJsonObject();
-            if (json_try_read(in, '}')) {
-                return in;
-            }
+    const std::streampos start = in.tellg();
+    const std::string buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
 
-            VJsonObject &object = *(value.m_value.object);
-            while (true) {
-                VJson key;
-                in >> key;
-                if (key.type() != VJson::String) {
-                    vError("Expect JSON key string.");
-                    break;
-                }
-                if (!json_try_read(in, ':')) {
-                    vError("Expect :");
-                    break;
-                }
-
-                VJson value;
-                in >> value;
-                object.insert(key.toString(), std::move(value));
-
-                if (!json_try_read(in, ',')) {
-                    if (!(json_try_read(in, '}'))) {
-                        vError("Expect }");
-                    } else {
-                        break;
-                    }
-                }
-            }
-        } else {
-            vError("Unexpected character: " << ch);
-        }
+    uint consumed = 0;
+    value = ParseBuffer(buffer.data(), buffer.size(), &consumed);
+    if (start != std::streampos(-1) && consumed < buffer.size()) {
+        in.clear();
+        in.seekg(start + std::streamoff(consumed));
     }
     return in;
 }
@@ -455,24 +512,54 @@ std::ostream &operator<<(std::ostream &out, const VJson &value)
 
 VJson VJson::Parse(const VByteArray &str)
 {
-	std::stringstream s;
-	s << str;
-    VJson json;
-	s >> json;
-	return json;
+    return ParseBuffer(str.data(), str.size());
+}
+
+VJson VJson::Parse(const char *data, uint size)
+{
+    return ParseBuffer(data, size);
 }
 
 VJson VJson::Load(const VString &path)
 {
-    std::ifstream s(path.toUtf8(), std::ios::binary);
-    VJson json;
-	s >> json;
-    return json;
+    std::ifstream s(VNativePath(path), std::ios::binary | std::ios::ate);
+    if (!s.is_open()) {
+        return VJson();
+    }
+
+    VByteArray buffer(s.tellg(), '\0');
+    s.seekg(0);
+    s.read(&buffer[0], buffer.size());
+    return ParseBuffer(buffer.data(), buffer.size());
+}
+
+VByteArray VJson::toBinary() const
+{
+    VMessagePackWriter writer;
+    WriteBinary(writer, *this);
+    return writer.data();
+}
+
+VJson VJson::FromBinary(const VByteArray &data)
+{
+    return FromBinary(data.data(), data.size());
+}
+
+VJson VJson::FromBinary(const char *data, uint size)
+{
+    VMessagePackReader reader(data, size);
+    DomBuilder builder;
+    if (!reader.parse(&builder)) {
+        vError("JSON: " << reader.error() << " at offset " << reader.errorOffset());
+        return VJson();
+    }
+    return std::move(builder.root);
 }
 
 void VJson::copy(const VJson &source)
 {
     m_type = source.type();
+    m_borrowed = false;
     switch (m_type) {
     case VJson::Boolean:
         m_value.boolean = source.m_value.boolean;
@@ -490,6 +577,7 @@ void VJson::copy(const VJson &source)
         m_value.object = new VJsonObject(*source.m_value.object);
         break;
     default:
+        m_value = Value();
         break;
     }
 }
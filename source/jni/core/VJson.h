@@ -5,14 +5,40 @@
 #include <ostream>
 
 #include "VString.h"
+#include "VStringView.h"
 #include "VArray.h"
-#include "VMap.h"
+#include "VFlatMap.h"
+#include "VFrameArena.h"
 
 NV_NAMESPACE_BEGIN
 
+// Keeps the elements of arrays and objects in the arena of a VJsonDocument,
+// or on the heap for every other value. Copies always go to the heap, so a
+// value copied out of a document may outlive it.
+template<class T>
+class VJsonAllocator : public VFrameAllocator<T>
+{
+public:
+    template<class U>
+    struct rebind { typedef VJsonAllocator<U> other; };
+
+    VJsonAllocator(VFrameArena *arena = nullptr)
+        : VFrameAllocator<T>(arena)
+    {
+    }
+
+    template<class U>
+    VJsonAllocator(const VJsonAllocator<U> &source)
+        : VFrameAllocator<T>(source.arena())
+    {
+    }
+
+    VJsonAllocator select_on_container_copy_construction() const { return VJsonAllocator(); }
+};
+
 class VJson;
-typedef VArray<VJson> VJsonArray;
-typedef VMap<VString, VJson> VJsonObject;
+typedef VArray<VJson, VJsonAllocator<VJson>> VJsonArray;
+typedef VFlatMap<VString, VJson, VJsonAllocator<std::pair<VString, VJson>>> VJsonObject;
 
 class VJson
 {
@@ -52,7 +78,7 @@ public:
     VJson(VJsonObject &&object);
 
     VJson(const VJson &source);
-    VJson(VJson &&source);
+    VJson(VJson &&source) noexcept;
     ~VJson();
 
     Type type() const { return m_type; }
@@ -78,7 +104,7 @@ public:
 
     //Assignment functions
     VJson &operator =(const VJson &source);
-    VJson &operator =(VJson &&source);
+    VJson &operator =(VJson &&source) noexcept;
 
 	//Array Functions
     VJson &operator[](uint i) { return (*m_value.array)[i]; }
@@ -95,6 +121,15 @@ public:
 
     bool contains(const VString &key) const { return m_value.object->contains(key); }
 
+    // Looked up without building a VString, so literal keys do not allocate
+    const VJson &value(const char *key) const { return value(VByteArrayView(key)); }
+    const VJson &value(VByteArrayView key) const;
+    const VJson &value(VStringView key) const;
+
+    bool contains(const char *key) const { return contains(VByteArrayView(key)); }
+    bool contains(VByteArrayView key) const;
+    bool contains(VStringView key) const;
+
 	//Array/Object functions
     uint size() const;
 	void clear();
@@ -102,14 +137,28 @@ public:
     friend std::istream &operator>>(std::istream &in, VJson &value);
     friend std::ostream &operator<<(std::ostream &out, const VJson &value);
 
+    // Parsed in place, logging the offset of the first error. Invalid JSON
+    // gives a null value.
     static VJson Parse(const VByteArray &str);
+    static VJson Parse(const char *data, uint size);
     static VJson Load(const VString &path);
 
+    // MessagePack, which is smaller and quicker to read. Parse() and Load()
+    // take it too, so precompiled files can replace text ones.
+    VByteArray toBinary() const;
+    static VJson FromBinary(const VByteArray &data);
+    static VJson FromBinary(const char *data, uint size);
+
 private:
+    friend class VJsonDocument;
+
     void copy(const VJson &source);
     void release();
 
     VJson::Type m_type;
+    // Set on the nodes of a VJsonDocument, whose payloads belong to the
+    // document. Copying one gives an ordinary value, moving one is refused.
+    bool m_borrowed;
 
     union Value
     {
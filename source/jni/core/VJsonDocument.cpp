@@ -0,0 +1,275 @@
+#include "VJsonDocument.h"
+#include "VHash.h"
+#include "VJsonReader.h"
+#include "VLog.h"
+#include "VPath.h"
+#include "VStringHash.h"
+
+#include <algorithm>
+#include <fstream>
+#include <new>
+#include <string.h>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+struct Utf8Traits
+{
+    static uint Hash(VByteArrayView key) { return VStringHashTraits::Hash(key); }
+    static bool Equal(VByteArrayView key, VByteArrayView other) { return key == other; }
+};
+
+// Longer strings are rarely repeated and aren't worth the lookup
+const uint MaxSharedLength = 64;
+
+}
+
+// Built from the reader's events. The values of open containers gather on a
+// stack, and a container is made in the arena once its size is known, so its
+// elements are never moved again. Moving a borrowed VJson copies it, so the
+// stack holds plain nodes which are written into place.
+struct VJsonDocument::Private : public VJsonHandler
+{
+    struct Node
+    {
+        VJson::Type type;
+        VJson::Value value;
+    };
+
+    VFrameArena *arena;
+    VJson root;
+
+    // Everything which needs a destructor: strings own their buffers, and
+    // containers larger than half an arena block are on the heap
+    VArray<VString *> strings;
+    VArray<VJsonArray *> arrays;
+    VArray<VJsonObject *> objects;
+
+    VHash<VByteArrayView, VString *, Utf8Traits> sharedStrings;
+
+    VArray<Node> values;
+    VArray<const VString *> keys;
+    VArray<uint> starts;
+
+    Private()
+        : arena(nullptr)
+    {
+    }
+
+    ~Private()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        root = VJson();
+        for (VJsonArray *array : arrays) {
+            array->~VJsonArray();
+        }
+        for (VJsonObject *object : objects) {
+            object->~VJsonObject();
+        }
+        for (VString *str : strings) {
+            str->~VString();
+        }
+        arrays.clear();
+        objects.clear();
+        strings.clear();
+        sharedStrings.clear();
+
+        delete arena;
+        arena = nullptr;
+    }
+
+    template<class T, class... Args>
+    T *create(Args &&... args)
+    {
+        return new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    const VString *share(VByteArrayView text)
+    {
+        if (text.size() > MaxSharedLength) {
+            VString *str = create<VString>(VString::fromUtf8(text.data(), text.size()));
+            strings.append(str);
+            return str;
+        }
+
+        VString *str = sharedStrings.value(text, nullptr);
+        if (!str) {
+            char *bytes = static_cast<char *>(arena->allocate(text.size(), 1));
+            memcpy(bytes, text.data(), text.size());
+            str = create<VString>(VString::fromUtf8(text.data(), text.size()));
+            strings.append(str);
+            sharedStrings.insert(VByteArrayView(bytes, text.size()), str);
+        }
+        return str;
+    }
+
+    Node &add(VJson::Type type)
+    {
+        Node node;
+        node.type = type;
+        node.value = VJson::Value();
+        values.append(node);
+        return values.last();
+    }
+
+    // Over a null VJson, which owns nothing
+    static void place(VJson &json, const Node &node)
+    {
+        json.m_type = node.type;
+        json.m_borrowed = node.type == VJson::String || node.type == VJson::Array || node.type == VJson::Object;
+        json.m_value = node.value;
+    }
+
+    bool null() override
+    {
+        add(VJson::Null);
+        return true;
+    }
+
+    bool boolean(bool value) override
+    {
+        add(VJson::Boolean).value.boolean = value;
+        return true;
+    }
+
+    bool number(double value) override
+    {
+        add(VJson::Number).value.number = value;
+        return true;
+    }
+
+    bool string(VByteArrayView value) override
+    {
+        add(VJson::String).value.str = const_cast<VString *>(share(value));
+        return true;
+    }
+
+    bool key(VByteArrayView name) override
+    {
+        keys.append(share(name));
+        return true;
+    }
+
+    bool startObject() override
+    {
+        starts.append(values.size());
+        return true;
+    }
+
+    bool endObject() override
+    {
+        const uint start = starts.last();
+        starts.removeLast();
+        const uint count = values.size() - start;
+        const uint firstKey = keys.size() - count;
+
+        VJsonObject *object = create<VJsonObject>(VJsonAllocator<VJsonObject::value_type>(arena));
+        object->reserve(count);
+        // Null values go in first, as pairs shift while the keys are sorted.
+        // Placing backwards keeps the first of duplicate keys, like insert().
+        for (uint i = 0; i < count; i++) {
+            (*object)[*keys[firstKey + i]];
+        }
+        for (uint i = count; i-- > 0;) {
+            place((*object)[*keys[firstKey + i]], values[start + i]);
+        }
+        objects.append(object);
+
+        values.resize(start);
+        keys.resize(firstKey);
+        add(VJson::Object).value.object = object;
+        return true;
+    }
+
+    bool startArray() override
+    {
+        starts.append(values.size());
+        return true;
+    }
+
+    bool endArray() override
+    {
+        const uint start = starts.last();
+        starts.removeLast();
+
+        VJsonArray *array = create<VJsonArray>(VJsonAllocator<VJson>(arena));
+        array->resize(values.size() - start);
+        for (uint i = start; i < values.size(); i++) {
+            place((*array)[i - start], values[i]);
+        }
+        arrays.append(array);
+
+        values.resize(start);
+        add(VJson::Array).value.array = array;
+        return true;
+    }
+};
+
+VJsonDocument::VJsonDocument()
+    : d(new Private)
+{
+}
+
+VJsonDocument::~VJsonDocument()
+{
+    delete d;
+}
+
+bool VJsonDocument::parse(const char *data, uint size)
+{
+    d->clear();
+    // The tree takes a few times the size of the text
+    d->arena = new VFrameArena(std::min<uint>(std::max<uint>(4096, size * 2), 1024 * 1024));
+
+    VJsonReader reader(data, size);
+    const bool parsed = reader.parse(d);
+    if (parsed) {
+        Private::place(d->root, d->values.last());
+    } else {
+        vError("JSON: " << reader.error() << " at offset " << reader.errorOffset());
+    }
+
+    d->values.clear();
+    d->keys.clear();
+    d->starts.clear();
+    if (!parsed) {
+        d->clear();
+    }
+    return parsed;
+}
+
+bool VJsonDocument::parse(const VByteArray &data)
+{
+    return parse(data.data(), data.size());
+}
+
+bool VJsonDocument::load(const VString &path)
+{
+    std::ifstream s(VNativePath(path), std::ios::binary | std::ios::ate);
+    if (!s.is_open()) {
+        d->clear();
+        return false;
+    }
+
+    VByteArray buffer(s.tellg(), '\0');
+    s.seekg(0);
+    s.read(&buffer[0], buffer.size());
+    return parse(buffer);
+}
+
+const VJson &VJsonDocument::root() const
+{
+    return d->root;
+}
+
+uint VJsonDocument::bytesUsed() const
+{
+    return d->arena ? d->arena->bytesUsed() : 0;
+}
+
+NV_NAMESPACE_END
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "VJson.h"
+
+NV_NAMESPACE_BEGIN
+
+// A parsed JSON tree whose nodes and containers all live in one arena, each
+// container's elements side by side, so walking it touches contiguous memory.
+// Equal strings are decoded once and shared by their nodes.
+//
+// Destruction is not O(1). Objects are VJsonObjects keyed by VString, which
+// toObject() hands out, so every key and string keeps its own heap buffer,
+// and destroying the document runs a destructor for each container, pair and
+// string. Only the nodes need none. Parsing into it is about as fast as
+// building the heap tree.
+//
+// The tree is read with the usual VJson accessors and can't be changed.
+// Copying a value out of it gives an ordinary VJson, moving one is refused.
+class VJsonDocument
+{
+public:
+    VJsonDocument();
+    ~VJsonDocument();
+
+    // Replaces the tree. An invalid document leaves a null root, and the
+    // first error is logged with its offset.
+    bool parse(const char *data, uint size);
+    bool parse(const VByteArray &data);
+    bool load(const VString &path);
+
+    const VJson &root() const;
+
+    // Arena bytes the tree takes
+    uint bytesUsed() const;
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VJsonDocument)
+};
+
+NV_NAMESPACE_END
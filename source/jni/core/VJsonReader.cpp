@@ -0,0 +1,461 @@
+#include "VJsonReader.h"
+#include "VMessagePack.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+// The same characters as isspace(), \t to \r being adjacent
+inline bool IsSpace(char ch)
+{
+    return ch == ' ' || (uint) (ch - '\t') < 5;
+}
+
+inline bool IsDigit(char ch)
+{
+    return (uint) (ch - '0') < 10;
+}
+
+// Powers of ten a double holds exactly
+const double ExactPowers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const int MaxExactPower = 22;
+// Mantissas of at most this many digits are below 2^53, so also exact
+const int MaxExactDigits = 15;
+
+}
+
+// Moves a cursor over the buffer once. Strings without escapes are handed out
+// straight from the buffer, and only the first error is kept.
+struct VJsonReader::Private
+{
+    const char *begin;
+    const char *cur;
+    const char *end;
+
+    const char *error;
+    const char *errorPos;
+
+    VJsonHandler *handler;
+
+    // Strings with escapes are unescaped here
+    std::string scratch;
+
+    Private(const char *data, uint size)
+        : begin(data)
+        , cur(data)
+        , end(data + size)
+        , error(nullptr)
+        , errorPos(data)
+        , handler(nullptr)
+    {
+    }
+
+    bool fail(const char *message)
+    {
+        if (!error) {
+            error = message;
+            errorPos = cur;
+        }
+        return false;
+    }
+
+    // Handlers return false to stop
+    bool emit(bool result)
+    {
+        return result || fail("Stopped by the handler");
+    }
+
+    void skipSpace()
+    {
+        while (cur < end && IsSpace(*cur)) {
+            cur++;
+        }
+    }
+
+    // Skips the character and the space after it if it is next
+    bool consume(char ch)
+    {
+        if (cur < end && *cur == ch) {
+            cur++;
+            skipSpace();
+            return true;
+        }
+        return false;
+    }
+
+    bool consumeChar(char ch)
+    {
+        if (cur < end && *cur == ch) {
+            cur++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseValue()
+    {
+        if (cur >= end) {
+            return fail("Unexpected end of JSON");
+        }
+
+        switch (*cur) {
+        case '"': {
+            VByteArrayView str;
+            if (!parseString(str) || !emit(handler->string(str))) {
+                return false;
+            }
+            break;
+        }
+        case '[':
+            cur++;
+            skipSpace();
+            return parseArray();
+        case '{':
+            cur++;
+            skipSpace();
+            return parseObject();
+        case 'n':
+            if (!parseLiteral("null", 4) || !emit(handler->null())) {
+                return false;
+            }
+            break;
+        case 't':
+            if (!parseLiteral("true", 4) || !emit(handler->boolean(true))) {
+                return false;
+            }
+            break;
+        case 'f':
+            if (!parseLiteral("false", 5) || !emit(handler->boolean(false))) {
+                return false;
+            }
+            break;
+        default: {
+            double number;
+            if (!parseNumber(number) || !emit(handler->number(number))) {
+                return false;
+            }
+            break;
+        }
+        }
+        skipSpace();
+        return true;
+    }
+
+    bool parseLiteral(const char *literal, uint length)
+    {
+        if ((uint) (end - cur) < length || memcmp(cur, literal, length) != 0) {
+            return fail("Unexpected character");
+        }
+        cur += length;
+        return true;
+    }
+
+    bool parseArray()
+    {
+        if (!emit(handler->startArray())) {
+            return false;
+        }
+        if (consume(']')) {
+            return emit(handler->endArray());
+        }
+
+        forever {
+            if (!parseValue()) {
+                return false;
+            }
+            if (consume(']')) {
+                return emit(handler->endArray());
+            }
+            if (!consume(',')) {
+                return fail("Expect , or ]");
+            }
+        }
+    }
+
+    bool parseObject()
+    {
+        if (!emit(handler->startObject())) {
+            return false;
+        }
+        if (consume('}')) {
+            return emit(handler->endObject());
+        }
+
+        forever {
+            if (cur >= end || *cur != '"') {
+                return fail("Expect JSON key string");
+            }
+            VByteArrayView key;
+            if (!parseString(key) || !emit(handler->key(key))) {
+                return false;
+            }
+            skipSpace();
+            if (!consume(':')) {
+                return fail("Expect :");
+            }
+
+            if (!parseValue()) {
+                return false;
+            }
+            if (consume('}')) {
+                return emit(handler->endObject());
+            }
+            if (!consume(',')) {
+                return fail("Expect , or }");
+            }
+        }
+    }
+
+    // The JSON escapes are decoded, any other character after a backslash
+    // is kept as it is
+    bool parseString(VByteArrayView &str)
+    {
+        const char *start = ++cur;
+        while (cur < end && *cur != '"' && *cur != '\\') {
+            cur++;
+        }
+        if (cur < end && *cur == '"') {
+            str = VByteArrayView(start, cur - start);
+            cur++;
+            return true;
+        }
+
+        scratch.assign(start, cur - start);
+        while (cur < end) {
+            char ch = *cur++;
+            if (ch == '"') {
+                str = VByteArrayView(scratch);
+                return true;
+            }
+            if (ch == '\\') {
+                if (cur >= end) {
+                    break;
+                }
+                ch = *cur++;
+                switch (ch) {
+                case 'n':
+                    ch = '\n';
+                    break;
+                case 't':
+                    ch = '\t';
+                    break;
+                case 'r':
+                    ch = '\r';
+                    break;
+                case 'b':
+                    ch = '\b';
+                    break;
+                case 'f':
+                    ch = '\f';
+                    break;
+                case 'u':
+                    if (!parseUnicodeEscape()) {
+                        return false;
+                    }
+                    continue;
+                default:
+                    break;
+                }
+            }
+            scratch += ch;
+        }
+        return fail("Unterminated string");
+    }
+
+    bool parseHex(uint &code)
+    {
+        if (end - cur < 4) {
+            return false;
+        }
+        code = 0;
+        for (int i = 0; i < 4; i++) {
+            const char ch = *cur++;
+            uint digit;
+            if (IsDigit(ch)) {
+                digit = ch - '0';
+            } else if (ch >= 'a' && ch <= 'f') {
+                digit = ch - 'a' + 10;
+            } else if (ch >= 'A' && ch <= 'F') {
+                digit = ch - 'A' + 10;
+            } else {
+                return false;
+            }
+            code = code << 4 | digit;
+        }
+        return true;
+    }
+
+    // \uXXXX, a surrogate pair taking two of them, appended as UTF-8
+    bool parseUnicodeEscape()
+    {
+        uint code;
+        if (!parseHex(code)) {
+            return fail("Invalid unicode escape");
+        }
+        if (code >= 0xd800 && code < 0xdc00 && end - cur >= 2 && cur[0] == '\\' && cur[1] == 'u') {
+            const char *mark = cur;
+            cur += 2;
+            uint low;
+            if (parseHex(low) && low >= 0xdc00 && low < 0xe000) {
+                code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+            } else {
+                cur = mark;
+            }
+        }
+
+        if (code < 0x80) {
+            scratch += (char) code;
+        } else if (code < 0x800) {
+            scratch += (char) (0xc0 | code >> 6);
+            scratch += (char) (0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            scratch += (char) (0xe0 | code >> 12);
+            scratch += (char) (0x80 | (code >> 6 & 0x3f));
+            scratch += (char) (0x80 | (code & 0x3f));
+        } else {
+            scratch += (char) (0xf0 | code >> 18);
+            scratch += (char) (0x80 | (code >> 12 & 0x3f));
+            scratch += (char) (0x80 | (code >> 6 & 0x3f));
+            scratch += (char) (0x80 | (code & 0x3f));
+        }
+        return true;
+    }
+
+    // Up to 15 digits with a small exponent are converted exactly by one
+    // multiplication or division, the rest by strtod()
+    bool parseNumber(double &number)
+    {
+        const char *start = cur;
+        const bool negative = consumeChar('-');
+
+        const char *integerStart = cur;
+        ulonglong mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        while (cur < end && IsDigit(*cur)) {
+            if (mantissa == 0 && *cur == '0') {
+                // Leading zeros are not significant
+            } else if (digits < 19) {
+                mantissa = mantissa * 10 + (*cur - '0');
+                digits++;
+            } else {
+                exponent++;
+                digits++;
+            }
+            cur++;
+        }
+        bool hasDigits = cur > integerStart;
+
+        if (consumeChar('.')) {
+            const char *fractionStart = cur;
+            while (cur < end && IsDigit(*cur)) {
+                if (mantissa == 0 && *cur == '0') {
+                    exponent--;
+                } else if (digits < 19) {
+                    mantissa = mantissa * 10 + (*cur - '0');
+                    digits++;
+                    exponent--;
+                } else {
+                    digits++;
+                }
+                cur++;
+            }
+            hasDigits = hasDigits || cur > fractionStart;
+        }
+        if (!hasDigits) {
+            cur = start;
+            return fail("Unexpected character");
+        }
+
+        if (cur < end && (*cur == 'e' || *cur == 'E')) {
+            const char *mark = cur++;
+            const bool negativeExponent = consumeChar('-');
+            if (!negativeExponent) {
+                consumeChar('+');
+            }
+            if (cur < end && IsDigit(*cur)) {
+                int value = 0;
+                while (cur < end && IsDigit(*cur)) {
+                    if (value < 100000) {
+                        value = value * 10 + (*cur - '0');
+                    }
+                    cur++;
+                }
+                exponent += negativeExponent ? -value : value;
+            } else {
+                cur = mark;
+            }
+        }
+
+        if (digits <= MaxExactDigits && exponent >= -MaxExactPower && exponent <= MaxExactPower) {
+            number = (double) mantissa;
+            number = exponent < 0 ? number / ExactPowers[-exponent] : number * ExactPowers[exponent];
+            if (negative) {
+                number = -number;
+            }
+        } else {
+            // Copied out, as the buffer may not end with a null character
+            const std::string token(start, cur);
+            number = strtod(token.c_str(), nullptr);
+        }
+        return true;
+    }
+};
+
+VJsonReader::VJsonReader(const char *data, uint size)
+    : d(new Private(data, size))
+{
+}
+
+VJsonReader::VJsonReader(const VByteArray &data)
+    : d(new Private(data.data(), data.size()))
+{
+}
+
+VJsonReader::~VJsonReader()
+{
+    delete d;
+}
+
+bool VJsonReader::parse(VJsonHandler *handler)
+{
+    const uint size = d->end - d->begin;
+    if (VMessagePackReader::Detect(d->begin, size)) {
+        VMessagePackReader reader(d->begin, size);
+        const bool parsed = reader.parse(handler);
+        if (!parsed) {
+            d->error = reader.error();
+            d->errorPos = d->begin + reader.errorOffset();
+        }
+        d->cur = d->begin + reader.offset();
+        return parsed;
+    }
+
+    d->handler = handler;
+    d->skipSpace();
+    return d->parseValue();
+}
+
+const char *VJsonReader::error() const
+{
+    return d->error;
+}
+
+uint VJsonReader::errorOffset() const
+{
+    return d->errorPos - d->begin;
+}
+
+uint VJsonReader::offset() const
+{
+    return d->cur - d->begin;
+}
+
+NV_NAMESPACE_END
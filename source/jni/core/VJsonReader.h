@@ -0,0 +1,53 @@
+#pragma once
+
+#include "VStringView.h"
+
+NV_NAMESPACE_BEGIN
+
+// Receives the parts of a JSON document in the order they are read. Strings
+// and keys are UTF-8 views which are only valid during the call. Returning
+// false stops the reader.
+class VJsonHandler
+{
+public:
+    virtual ~VJsonHandler() {}
+
+    virtual bool null() { return true; }
+    virtual bool boolean(bool value) { NV_UNUSED(value); return true; }
+    virtual bool number(double value) { NV_UNUSED(value); return true; }
+    virtual bool string(VByteArrayView value) { NV_UNUSED(value); return true; }
+
+    virtual bool startObject() { return true; }
+    virtual bool key(VByteArrayView name) { NV_UNUSED(name); return true; }
+    virtual bool endObject() { return true; }
+
+    virtual bool startArray() { return true; }
+    virtual bool endArray() { return true; }
+};
+
+// Reads one JSON value from a buffer and reports it to a handler, without
+// building any tree. The buffer needs no terminating zero and must outlive
+// the reader. Precompiled MessagePack is read as well, so loaders take either.
+class VJsonReader
+{
+public:
+    VJsonReader(const char *data, uint size);
+    VJsonReader(const VByteArray &data);
+    ~VJsonReader();
+
+    // Returns false if the JSON is invalid or the handler stopped
+    bool parse(VJsonHandler *handler);
+
+    // The first error and the byte offset it was found at
+    const char *error() const;
+    uint errorOffset() const;
+
+    // Where reading stopped, right after the value and the space following it
+    uint offset() const;
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VJsonReader)
+};
+
+NV_NAMESPACE_END
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "vglobal.h"
+
+#include <atomic>
+
+NV_NAMESPACE_BEGIN
+
+// Keeps the last Capacity timestamped states of a single writer. Every slot is
+// a seqlock, so the writer never waits and readers only retry if the slot they
+// copy is overwritten meanwhile. Timestamps must not decrease.
+template <class E, uint Capacity = 64>
+class VLocklessHistory
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    VLocklessHistory()
+        : m_count(0)
+    {
+        for (uint i = 0; i < Capacity; i++) {
+            m_slot[i].sequence.store(0, std::memory_order_relaxed);
+            m_slot[i].time = 0.0;
+        }
+    }
+
+    uint capacity() const { return Capacity; }
+    uint size() const
+    {
+        const uint count = m_count.load(std::memory_order_acquire);
+        return count < Capacity ? count : Capacity;
+    }
+    bool isEmpty() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+    void append(double time, const E &state)
+    {
+        const uint index = m_count.load(std::memory_order_relaxed);
+        Slot &slot = m_slot[index & (Capacity - 1)];
+
+        // An odd sequence marks the slot as being written
+        slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.time = time;
+        slot.state = state;
+        slot.sequence.store(index * 2 + 2, std::memory_order_release);
+
+        m_count.store(index + 1, std::memory_order_release);
+    }
+
+    // The latest state, or E() if there is none yet
+    E state() const
+    {
+        E state = E();
+        double time;
+        forever {
+            const uint count = m_count.load(std::memory_order_acquire);
+            if (count == 0 || read(count - 1, time, state)) {
+                return state;
+            }
+        }
+    }
+
+    // Interpolates between the two states around time with
+    // interpolate(const E &from, const E &to, double fraction). Times out of
+    // the history get the oldest or the latest state. Returns false if the
+    // history is empty.
+    template <class Interpolate>
+    bool sampleAt(double time, E &state, Interpolate interpolate) const
+    {
+        forever {
+            const uint count = m_count.load(std::memory_order_acquire);
+            if (count == 0) {
+                return false;
+            }
+
+            // Recent states are asked for the most, so search from the latest
+            const uint num = count < Capacity ? count : Capacity;
+            double laterTime = 0.0;
+            E later = E();
+            uint i = 0;
+            for (; i < num; i++) {
+                double sampleTime;
+                E sample;
+                if (!read(count - 1 - i, sampleTime, sample)) {
+                    break;
+                }
+
+                if (sampleTime <= time) {
+                    if (i == 0) {
+                        state = sample;
+                    } else if (laterTime > sampleTime) {
+                        state = interpolate(sample, later, (time - sampleTime) / (laterTime - sampleTime));
+                    } else {
+                        state = later;
+                    }
+                    return true;
+                }
+
+                laterTime = sampleTime;
+                later = sample;
+            }
+
+            if (i == num) {
+                state = later;
+                return true;
+            }
+            // The writer has overwritten the slot, look again from its state
+        }
+    }
+
+    // Linear interpolation for types with + and * by a scalar
+    bool sampleAt(double time, E &state) const
+    {
+        return sampleAt(time, state, [](const E &from, const E &to, double fraction) {
+            return from + (to - from) * fraction;
+        });
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint> sequence;
+        double time;
+        E state;
+    };
+
+    bool read(uint index, double &time, E &state) const
+    {
+        const Slot &slot = m_slot[index & (Capacity - 1)];
+        const uint sequence = index * 2 + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+            return false;
+        }
+        time = slot.time;
+        state = slot.state;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+    std::atomic<uint> m_count;
+    Slot m_slot[Capacity];
+};
+
+NV_NAMESPACE_END
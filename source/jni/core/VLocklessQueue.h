@@ -0,0 +1,138 @@
+#pragma once
+
+#include "vglobal.h"
+
+#include <algorithm>
+#include <atomic>
+
+NV_NAMESPACE_BEGIN
+
+// A bounded queue between exactly one producer thread and one consumer
+// thread, without locks. Unlike VCircularQueue a full queue rejects new
+// elements, since only the consumer may move the head.
+//
+// Each side keeps its index and a cached copy of the other side's index on a
+// cache line of its own, so it only reads the other line when the cached
+// index says the queue looks full or empty.
+template <class E>
+class VLocklessQueue
+{
+public:
+    // Rounded up to a power of two
+    VLocklessQueue(uint capacity = 256)
+        : m_mask(RoundUp(capacity) - 1)
+        , m_data(new E[m_mask + 1])
+        , m_tail(0)
+        , m_cachedHead(0)
+        , m_head(0)
+        , m_cachedTail(0)
+    {
+    }
+
+    ~VLocklessQueue()
+    {
+        delete[] m_data;
+    }
+
+    uint capacity() const { return m_mask + 1; }
+
+    // Only exact when called from one of the two threads while the other is idle
+    uint size() const { return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire); }
+    bool isEmpty() const { return size() == 0; }
+
+    // Producer side. Returns false if the queue is full.
+    bool append(const E &element)
+    {
+        const uint tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > m_mask) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > m_mask) {
+                return false;
+            }
+        }
+        m_data[tail & m_mask] = element;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Appends as many elements as fit and returns how many
+    uint appendRange(const E *elements, uint count)
+    {
+        const uint tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead + count > capacity()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+        }
+        count = std::min(count, capacity() - (tail - m_cachedHead));
+
+        const uint start = tail & m_mask;
+        const uint chunk = std::min(count, capacity() - start);
+        std::copy(elements, elements + chunk, m_data + start);
+        std::copy(elements + chunk, elements + count, m_data);
+
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool takeFirst(E &element)
+    {
+        const uint head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+        element = std::move(m_data[head & m_mask]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Takes up to count elements and returns how many
+    uint copyOut(E *elements, uint count)
+    {
+        const uint head = m_head.load(std::memory_order_relaxed);
+        if (m_cachedTail - head < count) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+        count = std::min(count, m_cachedTail - head);
+
+        const uint start = head & m_mask;
+        const uint chunk = std::min(count, capacity() - start);
+        std::move(m_data + start, m_data + start + chunk, elements);
+        std::move(m_data, m_data + count - chunk, elements + chunk);
+
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    static uint RoundUp(uint capacity)
+    {
+        uint result = 2;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static const int CacheLineSize = 64;
+
+    const uint m_mask;
+    E *m_data;
+
+    // Written by the producer
+    char m_padding1[CacheLineSize];
+    std::atomic<uint> m_tail;
+    uint m_cachedHead;
+    char m_padding2[CacheLineSize];
+
+    // Written by the consumer
+    std::atomic<uint> m_head;
+    uint m_cachedTail;
+    char m_padding3[CacheLineSize];
+
+    NV_DISABLE_COPY(VLocklessQueue)
+};
+
+NV_NAMESPACE_END
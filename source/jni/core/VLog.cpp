@@ -133,11 +133,29 @@ VLog &VLog::operator << (const char *str)
 }
 
 VLog &VLog::operator << (const VString &str)
+{
+    d->buffer << VStringView(str) << ' ';
+    return *this;
+}
+
+VLog &VLog::operator << (VStringView str)
 {
     d->buffer << str << ' ';
     return *this;
 }
 
+VLog &VLog::operator << (VByteArrayView str)
+{
+    d->buffer << str << ' ';
+    return *this;
+}
+
+VLog &VLog::operator << (VAtom atom)
+{
+    d->buffer << atom.name() << ' ';
+    return *this;
+}
+
 VLog &VLog::operator << (const VByteArray &str)
 {
     d->buffer << str << ' ';
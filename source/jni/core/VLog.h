@@ -1,7 +1,9 @@
 #pragma once
 
 #include "vglobal.h"
+#include "VAtom.h"
 #include "VString.h"
+#include "VStringView.h"
 
 NV_NAMESPACE_BEGIN
 
@@ -44,6 +46,9 @@ public:
 
     VLog &operator << (const char *str);
     VLog &operator << (const VString &str);
+    VLog &operator << (VStringView str);
+    VLog &operator << (VByteArrayView str);
+    VLog &operator << (VAtom atom);
     VLog &operator << (const VByteArray &str);
     VLog &operator << (const std::string &str);
 
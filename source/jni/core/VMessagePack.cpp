@@ -0,0 +1,555 @@
+#include "VMessagePack.h"
+#include "VJsonReader.h"
+
+#include <cmath>
+#include <string.h>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+// Format bytes, see https://github.com/msgpack/msgpack/blob/master/spec.md
+enum Format
+{
+    FormatFixMap = 0x80,
+    FormatFixArray = 0x90,
+    FormatFixStr = 0xa0,
+    FormatNil = 0xc0,
+    FormatFalse = 0xc2,
+    FormatTrue = 0xc3,
+    FormatFloat32 = 0xca,
+    FormatFloat64 = 0xcb,
+    FormatUInt8 = 0xcc,
+    FormatUInt16 = 0xcd,
+    FormatUInt32 = 0xce,
+    FormatUInt64 = 0xcf,
+    FormatInt8 = 0xd0,
+    FormatInt16 = 0xd1,
+    FormatInt32 = 0xd2,
+    FormatInt64 = 0xd3,
+    FormatStr8 = 0xd9,
+    FormatStr16 = 0xda,
+    FormatStr32 = 0xdb,
+    FormatArray16 = 0xdc,
+    FormatArray32 = 0xdd,
+    FormatMap16 = 0xde,
+    FormatMap32 = 0xdf,
+    FormatNegativeFixInt = 0xe0
+};
+
+}
+
+struct VMessagePackWriter::Private
+{
+    VByteArray buffer;
+
+    void put(uchar format)
+    {
+        buffer.append((char) format);
+    }
+
+    // Big-endian, as MessagePack has it
+    void put(uchar format, ulonglong value, uint bytes)
+    {
+        char data[9];
+        data[0] = (char) format;
+        for (uint i = bytes; i > 0; i--) {
+            data[i] = (char) (value & 0xff);
+            value >>= 8;
+        }
+        buffer.append(data, bytes + 1);
+    }
+
+    // Sizes of strings, arrays and maps
+    void putSize(uint size, uchar fixFormat, uint fixLimit, uchar format8, uchar format16, uchar format32)
+    {
+        if (size < fixLimit) {
+            put(fixFormat | size);
+        } else if (format8 && size <= 0xff) {
+            put(format8, size, 1);
+        } else if (size <= 0xffff) {
+            put(format16, size, 2);
+        } else {
+            put(format32, size, 4);
+        }
+    }
+};
+
+VMessagePackWriter::VMessagePackWriter()
+    : d(new Private)
+{
+}
+
+VMessagePackWriter::~VMessagePackWriter()
+{
+    delete d;
+}
+
+void VMessagePackWriter::writeNil()
+{
+    d->put(FormatNil);
+}
+
+void VMessagePackWriter::writeBool(bool value)
+{
+    d->put(value ? FormatTrue : FormatFalse);
+}
+
+// Signed values always take the signed formats, so they are read back as such
+void VMessagePackWriter::writeInt(long long value)
+{
+    if (value >= -32 && value < 128) {
+        d->put((uchar) value);
+    } else if (value >= -128 && value < 128) {
+        d->put(FormatInt8, value, 1);
+    } else if (value >= -32768 && value < 32768) {
+        d->put(FormatInt16, value, 2);
+    } else if (value >= -2147483648LL && value < 2147483648LL) {
+        d->put(FormatInt32, value, 4);
+    } else {
+        d->put(FormatInt64, value, 8);
+    }
+}
+
+void VMessagePackWriter::writeUInt(ulonglong value)
+{
+    if (value <= 0xff) {
+        d->put(FormatUInt8, value, 1);
+    } else if (value <= 0xffff) {
+        d->put(FormatUInt16, value, 2);
+    } else if (value <= 0xffffffffULL) {
+        d->put(FormatUInt32, value, 4);
+    } else {
+        d->put(FormatUInt64, value, 8);
+    }
+}
+
+void VMessagePackWriter::writeFloat(float value)
+{
+    uint bits;
+    memcpy(&bits, &value, sizeof(bits));
+    d->put(FormatFloat32, bits, 4);
+}
+
+void VMessagePackWriter::writeDouble(double value)
+{
+    ulonglong bits;
+    memcpy(&bits, &value, sizeof(bits));
+    d->put(FormatFloat64, bits, 8);
+}
+
+void VMessagePackWriter::writeNumber(double value)
+{
+    // -0 is whole but has no integer form
+    if (value >= -9223372036854775808.0 && value < 9223372036854775808.0
+            && value == (double) (long long) value && !(value == 0 && std::signbit(value))) {
+        writeInt((long long) value);
+    } else if ((double) (float) value == value) {
+        writeFloat((float) value);
+    } else {
+        writeDouble(value);
+    }
+}
+
+void VMessagePackWriter::writeString(VByteArrayView value)
+{
+    d->putSize(value.size(), FormatFixStr, 32, FormatStr8, FormatStr16, FormatStr32);
+    d->buffer.append(value.data(), value.size());
+}
+
+void VMessagePackWriter::writeString(const VString &value)
+{
+    writeString(VByteArrayView(value.toUtf8()));
+}
+
+void VMessagePackWriter::startArray(uint size)
+{
+    d->putSize(size, FormatFixArray, 16, 0, FormatArray16, FormatArray32);
+}
+
+void VMessagePackWriter::startMap(uint size)
+{
+    d->putSize(size, FormatFixMap, 16, 0, FormatMap16, FormatMap32);
+}
+
+const VByteArray &VMessagePackWriter::data() const
+{
+    return d->buffer;
+}
+
+// Decodes the header of one value at a time. Every element takes at least a
+// byte, so sizes larger than what is left are rejected before anyone
+// reserves memory for them.
+struct VMessagePackReader::Private
+{
+    const char *begin;
+    const char *cur;
+    const char *end;
+
+    const char *error;
+    const char *errorPos;
+
+    VJsonHandler *handler;
+
+    Type type;
+    union
+    {
+        bool boolean;
+        long long integer;
+        ulonglong uinteger;
+        double real;
+    } value;
+    VByteArrayView str;
+    uint count;
+
+    Private(const char *data, uint size)
+        : begin(data)
+        , cur(data)
+        , end(data + size)
+        , error(nullptr)
+        , errorPos(data)
+        , handler(nullptr)
+        , type(Invalid)
+        , count(0)
+    {
+        value.uinteger = 0;
+    }
+
+    bool fail(const char *message, const char *pos)
+    {
+        if (!error) {
+            error = message;
+            errorPos = pos;
+        }
+        type = Invalid;
+        return false;
+    }
+
+    bool emit(bool result)
+    {
+        return result || fail("Stopped by the handler", cur);
+    }
+
+    bool readBig(uint bytes, ulonglong &result)
+    {
+        if ((uint) (end - cur) < bytes) {
+            return false;
+        }
+        result = 0;
+        for (uint i = 0; i < bytes; i++) {
+            result = (result << 8) | (uchar) *cur++;
+        }
+        return true;
+    }
+
+    bool readString(const char *start, ulonglong length)
+    {
+        if ((ulonglong) (end - cur) < length) {
+            return fail("Truncated string", start);
+        }
+        type = String;
+        str = VByteArrayView(cur, length);
+        cur += length;
+        return true;
+    }
+
+    bool readContainer(const char *start, Type containerType, ulonglong size)
+    {
+        const ulonglong elements = containerType == Map ? size * 2 : size;
+        if ((ulonglong) (end - cur) < elements) {
+            return fail("Truncated container", start);
+        }
+        type = containerType;
+        count = size;
+        return true;
+    }
+
+    bool next()
+    {
+        const char *start = cur;
+        if (cur >= end) {
+            return fail("Unexpected end of data", start);
+        }
+
+        const uchar format = *cur++;
+        if (format < FormatFixMap) {
+            type = Int;
+            value.integer = format;
+            return true;
+        }
+        if (format >= FormatNegativeFixInt) {
+            type = Int;
+            value.integer = (signed char) format;
+            return true;
+        }
+        if (format < FormatFixArray) {
+            return readContainer(start, Map, format & 0x0f);
+        }
+        if (format < FormatFixStr) {
+            return readContainer(start, Array, format & 0x0f);
+        }
+        if (format < FormatNil) {
+            return readString(start, format & 0x1f);
+        }
+
+        ulonglong bits;
+        switch (format) {
+        case FormatNil:
+            type = Nil;
+            return true;
+        case FormatFalse:
+        case FormatTrue:
+            type = Boolean;
+            value.boolean = format == FormatTrue;
+            return true;
+        case FormatFloat32:
+            if (readBig(4, bits)) {
+                const uint low = (uint) bits;
+                float real;
+                memcpy(&real, &low, sizeof(real));
+                type = Float;
+                value.real = real;
+                return true;
+            }
+            break;
+        case FormatFloat64:
+            if (readBig(8, bits)) {
+                type = Double;
+                memcpy(&value.real, &bits, sizeof(bits));
+                return true;
+            }
+            break;
+        case FormatUInt8:
+        case FormatUInt16:
+        case FormatUInt32:
+        case FormatUInt64:
+            if (readBig(1 << (format - FormatUInt8), bits)) {
+                type = UInt;
+                value.uinteger = bits;
+                return true;
+            }
+            break;
+        case FormatInt8:
+        case FormatInt16:
+        case FormatInt32:
+        case FormatInt64: {
+            const uint bytes = 1 << (format - FormatInt8);
+            if (readBig(bytes, bits)) {
+                // Sign-extended from the top bit read
+                const uint shift = 64 - bytes * 8;
+                type = Int;
+                value.integer = (long long) (bits << shift) >> shift;
+                return true;
+            }
+            break;
+        }
+        case FormatStr8:
+        case FormatStr16:
+        case FormatStr32:
+            if (readBig(1 << (format - FormatStr8), bits)) {
+                return readString(start, bits);
+            }
+            break;
+        case FormatArray16:
+        case FormatArray32:
+            if (readBig(2 << (format - FormatArray16), bits)) {
+                return readContainer(start, Array, bits);
+            }
+            break;
+        case FormatMap16:
+        case FormatMap32:
+            if (readBig(2 << (format - FormatMap16), bits)) {
+                return readContainer(start, Map, bits);
+            }
+            break;
+        default:
+            cur = start;
+            return fail("Unsupported MessagePack type", start);
+        }
+        return fail("Unexpected end of data", start);
+    }
+
+    bool skip()
+    {
+        ulonglong pending = type == Map ? count * 2ULL : (type == Array ? count : 0);
+        while (pending > 0) {
+            if (!next()) {
+                return false;
+            }
+            pending--;
+            if (type == Map) {
+                pending += count * 2ULL;
+            } else if (type == Array) {
+                pending += count;
+            }
+        }
+        return true;
+    }
+
+    double toDouble() const
+    {
+        switch (type) {
+        case Int:
+            return (double) value.integer;
+        case UInt:
+            return (double) value.uinteger;
+        case Float:
+        case Double:
+            return value.real;
+        default:
+            return 0.0;
+        }
+    }
+
+    bool parseValue()
+    {
+        if (!next()) {
+            return false;
+        }
+
+        switch (type) {
+        case Nil:
+            return emit(handler->null());
+        case Boolean:
+            return emit(handler->boolean(value.boolean));
+        case Int:
+        case UInt:
+        case Float:
+        case Double:
+            return emit(handler->number(toDouble()));
+        case String:
+            return emit(handler->string(str));
+        case Array: {
+            const uint size = count;
+            if (!emit(handler->startArray())) {
+                return false;
+            }
+            for (uint i = 0; i < size; i++) {
+                if (!parseValue()) {
+                    return false;
+                }
+            }
+            return emit(handler->endArray());
+        }
+        case Map: {
+            const uint size = count;
+            if (!emit(handler->startObject())) {
+                return false;
+            }
+            for (uint i = 0; i < size; i++) {
+                const char *start = cur;
+                if (!next()) {
+                    return false;
+                }
+                if (type != String) {
+                    return fail("Expect string key", start);
+                }
+                if (!emit(handler->key(str)) || !parseValue()) {
+                    return false;
+                }
+            }
+            return emit(handler->endObject());
+        }
+        default:
+            return false;
+        }
+    }
+};
+
+VMessagePackReader::VMessagePackReader(const char *data, uint size)
+    : d(new Private(data, size))
+{
+}
+
+VMessagePackReader::VMessagePackReader(const VByteArray &data)
+    : d(new Private(data.data(), data.size()))
+{
+}
+
+VMessagePackReader::~VMessagePackReader()
+{
+    delete d;
+}
+
+bool VMessagePackReader::next()
+{
+    return d->next();
+}
+
+bool VMessagePackReader::skip()
+{
+    return d->skip();
+}
+
+VMessagePackReader::Type VMessagePackReader::type() const
+{
+    return d->type;
+}
+
+bool VMessagePackReader::toBool() const
+{
+    return d->type == Boolean && d->value.boolean;
+}
+
+long long VMessagePackReader::toLongLong() const
+{
+    if (d->type == Int || d->type == UInt) {
+        return d->value.integer;
+    }
+    return (long long) d->toDouble();
+}
+
+ulonglong VMessagePackReader::toULongLong() const
+{
+    if (d->type == Int || d->type == UInt) {
+        return d->value.uinteger;
+    }
+    return (ulonglong) d->toDouble();
+}
+
+double VMessagePackReader::toDouble() const
+{
+    return d->toDouble();
+}
+
+VByteArrayView VMessagePackReader::toString() const
+{
+    return d->type == String ? d->str : VByteArrayView();
+}
+
+uint VMessagePackReader::size() const
+{
+    return d->type == Array || d->type == Map ? d->count : 0;
+}
+
+bool VMessagePackReader::parse(VJsonHandler *handler)
+{
+    d->handler = handler;
+    return d->parseValue();
+}
+
+const char *VMessagePackReader::error() const
+{
+    return d->error;
+}
+
+uint VMessagePackReader::errorOffset() const
+{
+    return d->errorPos - d->begin;
+}
+
+uint VMessagePackReader::offset() const
+{
+    return d->cur - d->begin;
+}
+
+bool VMessagePackReader::Detect(const char *data, uint size)
+{
+    if (size == 0) {
+        return false;
+    }
+    const uchar format = *data;
+    return (format >= FormatFixMap && format < FormatFixStr) || (format >= FormatArray16 && format <= FormatMap32);
+}
+
+NV_NAMESPACE_END
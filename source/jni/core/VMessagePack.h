@@ -0,0 +1,98 @@
+#pragma once
+
+#include "VByteArray.h"
+#include "VStringView.h"
+
+NV_NAMESPACE_BEGIN
+
+class VJsonHandler;
+
+// Encodes values in MessagePack, the compact binary form VJson::toBinary()
+// and VVariant::toBinary() produce. Each value takes the shortest encoding of
+// its kind, and the sizes of arrays and maps go before their elements.
+class VMessagePackWriter
+{
+public:
+    VMessagePackWriter();
+    ~VMessagePackWriter();
+
+    void writeNil();
+    void writeBool(bool value);
+    void writeInt(long long value);
+    void writeUInt(ulonglong value);
+    void writeFloat(float value);
+    void writeDouble(double value);
+    // Whole numbers as integers, the rest as the smallest float holding them
+    void writeNumber(double value);
+    void writeString(const char *value) { writeString(VByteArrayView(value)); }
+    void writeString(VByteArrayView value);
+    void writeString(const VString &value);
+
+    // Followed by size values, or size keys each followed by its value
+    void startArray(uint size);
+    void startMap(uint size);
+
+    const VByteArray &data() const;
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VMessagePackWriter)
+};
+
+// Walks MessagePack in place, one value at a time, so a mapped file can be
+// read without building any tree. Strings point into the data, which must
+// outlive the reader.
+class VMessagePackReader
+{
+public:
+    enum Type
+    {
+        Invalid,
+        Nil,
+        Boolean,
+        Int,
+        UInt,
+        Float,
+        Double,
+        String,
+        Array,
+        Map
+    };
+
+    VMessagePackReader(const char *data, uint size);
+    VMessagePackReader(const VByteArray &data);
+    ~VMessagePackReader();
+
+    // Moves to the next value. The elements of an array, or the keys and
+    // values of a map, are the values which follow it.
+    bool next();
+    // Moves past the elements of the current array or map
+    bool skip();
+
+    Type type() const;
+    bool toBool() const;
+    // Any integer, and any number as a double
+    long long toLongLong() const;
+    ulonglong toULongLong() const;
+    double toDouble() const;
+    VByteArrayView toString() const;
+    // Elements of an array, pairs of a map
+    uint size() const;
+
+    // Reads one value and reports it as JSON, so VJsonHandlers take both
+    bool parse(VJsonHandler *handler);
+
+    // The first error and the byte offset it was found at
+    const char *error() const;
+    uint errorOffset() const;
+    uint offset() const;
+
+    // Whether the data starts with an array or a map, which JSON text can't
+    static bool Detect(const char *data, uint size);
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VMessagePackReader)
+};
+
+NV_NAMESPACE_END
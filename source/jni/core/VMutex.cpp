@@ -1,53 +1,101 @@
 #include "VMutex.h"
+#include "VFutex.h"
 #include "VLog.h"
 
+#include <atomic>
 #include <pthread.h>
 
 NV_NAMESPACE_BEGIN
 
 struct VMutex::Private
 {
-    pthread_mutex_t mutex;
+    // 0: unlocked, 1: locked, 2: locked and someone may sleep on it
+    std::atomic<int> state;
     bool recursive;
     uint lockCount;
-    pthread_t locker;
+    // Only the owner stores itself, so other threads never see their own id
+    std::atomic<pthread_t> locker;
+
+    std::atomic<uint> contended;
+    std::atomic<uint> parked;
+
+    bool tryAcquire()
+    {
+        int expected = 0;
+        return state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void acquire()
+    {
+        if (tryAcquire()) {
+            return;
+        }
+
+        contended.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < VFutex::SpinCount(); i++) {
+            VFutex::Relax();
+            if (state.load(std::memory_order_relaxed) == 0 && tryAcquire()) {
+                return;
+            }
+        }
+
+        while (state.exchange(2, std::memory_order_acquire) != 0) {
+            parked.fetch_add(1, std::memory_order_relaxed);
+            VFutex::Wait(&state, 2);
+        }
+    }
+
+    void release()
+    {
+        if (state.exchange(0, std::memory_order_release) == 2) {
+            VFutex::Wake(&state, 1);
+        }
+    }
+
+    bool isOwner() const
+    {
+        return pthread_equal(locker.load(std::memory_order_relaxed), pthread_self());
+    }
 };
 
 VMutex::VMutex(bool recursive)
     : d(new Private)
 {
+    d->state = 0;
     d->recursive = recursive;
     d->lockCount = 0;
-
-    if (d->recursive) {
-        pthread_mutexattr_t attr;
-        pthread_mutexattr_init(&attr);
-        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-        pthread_mutex_init(&d->mutex, &attr);
-        pthread_mutexattr_destroy(&attr);
-    } else {
-        pthread_mutex_init(&d->mutex, NULL);
-    }
+    d->locker = pthread_t();
+    d->contended = 0;
+    d->parked = 0;
 }
 
 VMutex::~VMutex()
 {
-    pthread_mutex_destroy(&d->mutex);
     delete d;
 }
 
 void VMutex::lock()
 {
-    while (pthread_mutex_lock(&d->mutex));
+    if (d->recursive && d->isOwner()) {
+        d->lockCount++;
+        return;
+    }
+
+    d->acquire();
     d->lockCount++;
-    d->locker = pthread_self();
+    d->locker.store(pthread_self(), std::memory_order_relaxed);
 }
 
 bool VMutex::tryLock()
 {
-    if (!pthread_mutex_trylock(&d->mutex)) {
+    if (d->recursive && d->isOwner()) {
         d->lockCount++;
-        d->locker = pthread_self();
+        return true;
+    }
+
+    if (d->tryAcquire()) {
+        d->lockCount++;
+        d->locker.store(pthread_self(), std::memory_order_relaxed);
         return true;
     }
     return false;
@@ -55,9 +103,12 @@ bool VMutex::tryLock()
 
 void VMutex::unlock()
 {
-    vAssert(pthread_self() == d->locker && d->lockCount > 0);
+    vAssert(pthread_equal(d->locker.load(std::memory_order_relaxed), pthread_self()) && d->lockCount > 0);
     d->lockCount--;
-    pthread_mutex_unlock(&d->mutex);
+    if (d->lockCount == 0) {
+        d->locker.store(pthread_t(), std::memory_order_relaxed);
+        d->release();
+    }
 }
 
 uint VMutex::lockCount() const
@@ -70,6 +121,16 @@ bool VMutex::isRecursive() const
     return d->recursive;
 }
 
+uint VMutex::contendedCount() const
+{
+    return d->contended.load(std::memory_order_relaxed);
+}
+
+uint VMutex::parkedCount() const
+{
+    return d->parked.load(std::memory_order_relaxed);
+}
+
 void VMutex::setLockCount(uint count)
 {
     d->lockCount = count;
@@ -77,7 +138,8 @@ void VMutex::setLockCount(uint count)
 
 void VMutex::_unlock()
 {
-    pthread_mutex_unlock(&d->mutex);
+    d->locker.store(pthread_t(), std::memory_order_relaxed);
+    d->release();
 }
 
 NV_NAMESPACE_END
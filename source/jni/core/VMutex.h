@@ -34,6 +34,11 @@ public:
     uint lockCount() const;
     bool isRecursive() const;
 
+    // Contention statistics, which are only counted on the slow path:
+    // lock() calls that found the mutex taken and the times they slept.
+    uint contendedCount() const;
+    uint parkedCount() const;
+
 private:
     void setLockCount(uint count);
     void _unlock();
@@ -0,0 +1,248 @@
+#include "VObjectPool.h"
+#include "VArray.h"
+#include "VLog.h"
+#include "VMutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+// Pools past this many are served from their shared list only
+const int MaxCachedPools = 32;
+// Blocks a thread keeps per pool, and how many move at once to or from the
+// shared list
+const uint CacheLimit = 32;
+const uint BatchSize = 16;
+
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+struct Cache
+{
+    FreeBlock *head;
+    uint count;
+};
+
+// Plain data, so threads need no destructor to exit. The blocks cached by a
+// finished thread stay unused.
+thread_local Cache ThreadCaches[MaxCachedPools];
+
+VMutex &RegistryMutex()
+{
+    static VMutex *mutex = new VMutex(false);
+    return *mutex;
+}
+
+VArray<VMemoryPool *> &Registry()
+{
+    static VArray<VMemoryPool *> *pools = new VArray<VMemoryPool *>;
+    return *pools;
+}
+
+// Ids are never reused, so a cache can't hand out blocks of a dead pool
+std::atomic<int> NextId(0);
+
+}
+
+struct VMemoryPool::Private
+{
+    const char *name;
+    uint blockSize;
+    uint alignment;
+    uint blocksPerSlab;
+    int id;
+
+    VMutex mutex;
+    FreeBlock *freeList;
+    VArray<char *> slabs;
+
+    std::atomic<int> live;
+    std::atomic<int> peak;
+
+    Private(const char *name, uint size, uint alignment, uint blocksPerSlab)
+        : name(name)
+        , alignment(std::max<uint>(alignment, alignof(FreeBlock)))
+        , blocksPerSlab(std::max<uint>(blocksPerSlab, 1))
+        , id(NextId.fetch_add(1))
+        , mutex(false)
+        , freeList(nullptr)
+        , live(0)
+        , peak(0)
+    {
+        const uint mask = this->alignment - 1;
+        blockSize = (std::max<uint>(size, sizeof(FreeBlock)) + mask) & ~mask;
+    }
+
+    ~Private()
+    {
+        for (char *slab : slabs) {
+            ::free(slab);
+        }
+    }
+
+    // Called with the mutex locked
+    void addSlab()
+    {
+        char *slab = static_cast<char *>(malloc(blockSize * blocksPerSlab + alignment));
+        slabs.append(slab);
+
+        const uintptr_t mask = alignment - 1;
+        char *block = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(slab) + mask) & ~mask);
+        for (uint i = 0; i < blocksPerSlab; i++, block += blockSize) {
+            FreeBlock *entry = reinterpret_cast<FreeBlock *>(block);
+            entry->next = freeList;
+            freeList = entry;
+        }
+    }
+
+    void *take()
+    {
+        VMutex::Locker locker(&mutex);
+        if (!freeList) {
+            addSlab();
+        }
+        FreeBlock *block = freeList;
+        freeList = block->next;
+        return block;
+    }
+
+    void give(void *pointer)
+    {
+        FreeBlock *block = static_cast<FreeBlock *>(pointer);
+        VMutex::Locker locker(&mutex);
+        block->next = freeList;
+        freeList = block;
+    }
+
+    void refill(Cache &cache)
+    {
+        VMutex::Locker locker(&mutex);
+        for (uint i = 0; i < BatchSize; i++) {
+            if (!freeList) {
+                addSlab();
+            }
+            FreeBlock *block = freeList;
+            freeList = block->next;
+            block->next = cache.head;
+            cache.head = block;
+        }
+        cache.count += BatchSize;
+    }
+
+    void drain(Cache &cache)
+    {
+        VMutex::Locker locker(&mutex);
+        for (uint i = 0; i < BatchSize; i++) {
+            FreeBlock *block = cache.head;
+            cache.head = block->next;
+            block->next = freeList;
+            freeList = block;
+        }
+        cache.count -= BatchSize;
+    }
+
+    void countAllocation()
+    {
+        const int count = live.fetch_add(1, std::memory_order_relaxed) + 1;
+        int max = peak.load(std::memory_order_relaxed);
+        while (count > max && !peak.compare_exchange_weak(max, count, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+VMemoryPool::VMemoryPool(const char *name, uint size, uint alignment, uint blocksPerSlab)
+    : d(new Private(name, size, alignment, blocksPerSlab))
+{
+    VMutex::Locker locker(&RegistryMutex());
+    Registry().append(this);
+}
+
+VMemoryPool::~VMemoryPool()
+{
+    {
+        VMutex::Locker locker(&RegistryMutex());
+        Registry().removeOne(this);
+    }
+    delete d;
+}
+
+void *VMemoryPool::allocate()
+{
+    d->countAllocation();
+    if (d->id >= MaxCachedPools) {
+        return d->take();
+    }
+
+    Cache &cache = ThreadCaches[d->id];
+    if (!cache.head) {
+        d->refill(cache);
+    }
+    FreeBlock *block = cache.head;
+    cache.head = block->next;
+    cache.count--;
+    return block;
+}
+
+void VMemoryPool::free(void *block)
+{
+    if (!block) {
+        return;
+    }
+    d->live.fetch_sub(1, std::memory_order_relaxed);
+    if (d->id >= MaxCachedPools) {
+        d->give(block);
+        return;
+    }
+
+    Cache &cache = ThreadCaches[d->id];
+    FreeBlock *entry = static_cast<FreeBlock *>(block);
+    entry->next = cache.head;
+    cache.head = entry;
+    if (++cache.count > CacheLimit) {
+        d->drain(cache);
+    }
+}
+
+const char *VMemoryPool::name() const
+{
+    return d->name;
+}
+
+uint VMemoryPool::blockSize() const
+{
+    return d->blockSize;
+}
+
+uint VMemoryPool::liveCount() const
+{
+    return d->live.load(std::memory_order_relaxed);
+}
+
+uint VMemoryPool::peakCount() const
+{
+    return d->peak.load(std::memory_order_relaxed);
+}
+
+uint VMemoryPool::slabCount() const
+{
+    VMutex::Locker locker(&d->mutex);
+    return d->slabs.size();
+}
+
+void VMemoryPool::LogStats()
+{
+    VMutex::Locker locker(&RegistryMutex());
+    for (const VMemoryPool *pool : Registry()) {
+        vInfo("Pool " << pool->name() << ": " << pool->liveCount() << " live, peak " << pool->peakCount()
+              << ", " << pool->slabCount() << " slabs of " << pool->d->blocksPerSlab << " x " << pool->blockSize() << " bytes");
+    }
+}
+
+NV_NAMESPACE_END
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "vglobal.h"
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+NV_NAMESPACE_BEGIN
+
+// Hands out blocks of one size, carved from slabs and recycled through a free
+// list. Every thread keeps a few free blocks of its own, so allocating and
+// freeing only take the pool's lock once per batch. A block may be freed on
+// any thread, it simply goes to that thread's cache.
+//
+// Slabs are only given back when the pool is destroyed.
+class VMemoryPool
+{
+public:
+    VMemoryPool(const char *name, uint size, uint alignment = alignof(long double), uint blocksPerSlab = 64);
+    ~VMemoryPool();
+
+    void *allocate();
+    void free(void *block);
+
+    const char *name() const;
+    uint blockSize() const;
+
+    // Blocks in use now and at most, so leaks and churn show up in the logs
+    uint liveCount() const;
+    uint peakCount() const;
+    uint slabCount() const;
+
+    // Logs the counts of every pool
+    static void LogStats();
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VMemoryPool)
+};
+
+// A pool of objects of type T
+template<class T>
+class VObjectPool
+{
+public:
+    VObjectPool(const char *name, uint objectsPerSlab = 64)
+        : m_pool(name, sizeof(T), alignof(T), objectsPerSlab)
+    {
+    }
+
+    template<class... Args>
+    T *create(Args &&... args)
+    {
+        return new (m_pool.allocate()) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T *object)
+    {
+        if (object) {
+            object->~T();
+            m_pool.free(object);
+        }
+    }
+
+    const VMemoryPool &pool() const { return m_pool; }
+
+private:
+    VMemoryPool m_pool;
+};
+
+// Makes new and delete of a class use a pool of its own. Subclasses of another
+// size which don't declare one go to the heap. The pool lives until the
+// process exits, so static objects may be deleted at any time.
+#define NV_DECLARE_POOLED(Class) \
+    static VMemoryPool &objectPool() \
+    { \
+        static VMemoryPool *pool = new VMemoryPool(#Class, sizeof(Class), alignof(Class)); \
+        return *pool; \
+    } \
+    static void *operator new(std::size_t size) \
+    { \
+        return size == sizeof(Class) ? objectPool().allocate() : ::operator new(size); \
+    } \
+    static void operator delete(void *pointer, std::size_t size) \
+    { \
+        if (size == sizeof(Class)) { \
+            objectPool().free(pointer); \
+        } else { \
+            ::operator delete(pointer); \
+        } \
+    }
+
+NV_NAMESPACE_END
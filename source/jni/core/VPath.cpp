@@ -253,4 +253,28 @@ VString VPath::toRelativePath(const VArray<VString> &parents) const
     return *this;
 }
 
+VNativePath::VNativePath(VStringView path)
+{
+    const uint length = path.toUtf8(m_buffer, sizeof(m_buffer) - 1);
+    if (length < sizeof(m_buffer)) {
+        m_buffer[length] = '\0';
+        m_data = m_buffer;
+    } else {
+        m_long = path.toUtf8();
+        m_data = m_long.c_str();
+    }
+}
+
+VNativePath::VNativePath(VByteArrayView path)
+{
+    if (path.size() < sizeof(m_buffer)) {
+        memcpy(m_buffer, path.data(), path.size());
+        m_buffer[path.size()] = '\0';
+        m_data = m_buffer;
+    } else {
+        m_long = path.toByteArray();
+        m_data = m_long.c_str();
+    }
+}
+
 NV_NAMESPACE_END
@@ -2,6 +2,7 @@
 
 #include "VString.h"
 #include "VArray.h"
+#include "VStringView.h"
 
 NV_NAMESPACE_BEGIN
 
@@ -14,6 +15,7 @@ public:
     VPath(const VPath &path) : VString(path.data(), path.size()) {}
     VPath(const char *data, uint length) : VString(data, length) {}
     VPath(const char16_t *data, uint length) : VString(data, length) {}
+    explicit VPath(VStringView path) : VString(path.data(), path.size()) {}
 
     bool isAbsolute() const;
 
@@ -33,4 +35,23 @@ public:
     VString toRelativePath(const VArray<VString> &searchPaths) const;
 };
 
+// A path the way the C library takes it: UTF-8 and terminated. It stays on
+// the stack unless it is very long.
+class VNativePath
+{
+public:
+    VNativePath(VStringView path);
+    VNativePath(VByteArrayView path);
+
+    const char *data() const { return m_data; }
+    operator const char *() const { return m_data; }
+
+private:
+    char m_buffer[512];
+    VByteArray m_long;
+    const char *m_data;
+
+    NV_DISABLE_COPY(VNativePath)
+};
+
 NV_NAMESPACE_END
@@ -1,41 +1,90 @@
 #include "VSemaphore.h"
+#include "VFutex.h"
 
-#include <semaphore.h>
+#include <atomic>
 
 NV_NAMESPACE_BEGIN
 
 struct VSemaphore::Private
 {
-    sem_t sem;
+    std::atomic<int> value;
+    std::atomic<int> waiters;
+
+    std::atomic<uint> contended;
+    std::atomic<uint> parked;
+
+    bool tryAcquire()
+    {
+        int current = value.load(std::memory_order_relaxed);
+        while (current > 0) {
+            if (value.compare_exchange_weak(current, current - 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 VSemaphore::VSemaphore(uint value)
     : d(new Private)
 {
-    sem_init(&d->sem, 0, value);
+    d->value = value;
+    d->waiters = 0;
+    d->contended = 0;
+    d->parked = 0;
 }
 
 VSemaphore::~VSemaphore()
 {
-    sem_destroy(&d->sem);
     delete d;
 }
 
 bool VSemaphore::wait()
 {
-    return sem_wait(&d->sem) == 0;
+    if (d->tryAcquire()) {
+        return true;
+    }
+
+    d->contended.fetch_add(1, std::memory_order_relaxed);
+    for (int i = 0; i < VFutex::SpinCount(); i++) {
+        VFutex::Relax();
+        if (d->tryAcquire()) {
+            return true;
+        }
+    }
+
+    // post() wakes someone up only if it sees a waiter after raising the value
+    d->waiters.fetch_add(1);
+    while (!d->tryAcquire()) {
+        d->parked.fetch_add(1, std::memory_order_relaxed);
+        VFutex::Wait(&d->value, 0);
+    }
+    d->waiters.fetch_sub(1);
+    return true;
 }
 
 bool VSemaphore::post()
 {
-    return sem_post(&d->sem) == 0;
+    d->value.fetch_add(1);
+    if (d->waiters.load() > 0) {
+        VFutex::Wake(&d->value, 1);
+    }
+    return true;
 }
 
 int VSemaphore::available() const
 {
-    int value;
-    sem_getvalue(&d->sem, &value);
-    return value;
+    return d->value.load(std::memory_order_relaxed);
+}
+
+uint VSemaphore::contendedCount() const
+{
+    return d->contended.load(std::memory_order_relaxed);
+}
+
+uint VSemaphore::parkedCount() const
+{
+    return d->parked.load(std::memory_order_relaxed);
 }
 
 NV_NAMESPACE_END
@@ -15,6 +15,11 @@ public:
 
     int available() const;
 
+    // Contention statistics: wait() calls that found no resource and the
+    // times they slept
+    uint contendedCount() const;
+    uint parkedCount() const;
+
 private:
     NV_DECLARE_PRIVATE
     NV_DISABLE_COPY(VSemaphore)
@@ -1,32 +1,59 @@
 #include "VSignal.h"
-#include "VMutex.h"
-#include "VWaitCondition.h"
+#include "VFutex.h"
+#include "VTimer.h"
+
+#include <atomic>
 
 NV_NAMESPACE_BEGIN
 
 struct VSignal::Private
 {
-    // Event state, its mutex and the wait condition
-    volatile bool state;
-    volatile bool temporary;
-    mutable VMutex stateMutex;
-    VWaitCondition stateWaitCondition;
+    enum State
+    {
+        Reset,
+        Set,
+        // Set until a waiter is released
+        Pulsed,
+
+        // Added to Reset by the waiters going to sleep
+        Waiting = 4
+    };
 
-    void updateState(bool newState, bool newTemp, bool mustNotify)
+    std::atomic<int> state;
+
+    // Takes the state, resetting a pulse. Returns false if it is not set.
+    bool consume()
     {
-        VMutex::Locker lock(&stateMutex);
-        state       = newState;
-        temporary   = newTemp;
-        if (mustNotify)
-            stateWaitCondition.notifyAll();
+        int current = state.load();
+        forever {
+            const int value = current & ~Waiting;
+            if (value == Reset) {
+                return false;
+            }
+            if (value == Set || state.compare_exchange_weak(current, (current & Waiting) | Reset)) {
+                return true;
+            }
+        }
+    }
+
+    // The signal may be deleted as soon as a waiter sees the new state, so
+    // nothing of it is read afterwards. The wake only passes the address.
+    void update(int newState)
+    {
+        if (newState == Reset) {
+            state.fetch_and(Waiting);
+            return;
+        }
+        if (state.exchange(newState) & Waiting) {
+            VFutex::Wake(&state);
+        }
     }
 };
 
 VSignal::VSignal(bool state)
     : d(new Private)
 {
-    d->state = state;
-    d->temporary = false;
+    d->state = state ? Private::Set : Private::Reset;
 }
 
 VSignal::~VSignal()
@@ -36,41 +63,57 @@ VSignal::~VSignal()
 
 bool VSignal::wait(uint delay)
 {
-    VMutex::Locker lock(&d->stateMutex);
+    if (d->consume()) {
+        return true;
+    }
+    if (delay == 0) {
+        return false;
+    }
 
-    // Do the correct amount of waiting
-    if (delay == Infinite) {
-        while(!d->state) {
-            d->stateWaitCondition.wait(&d->stateMutex);
-        }
-    } else if (delay) {
-        if (!d->state) {
-            d->stateWaitCondition.wait(&d->stateMutex, delay);
+    for (int i = 0; i < VFutex::SpinCount(); i++) {
+        VFutex::Relax();
+        if (d->consume()) {
+            return true;
         }
     }
 
-    bool state = d->state;
-    // Take care of temporary 'pulsing' of a state
-    if (d->temporary) {
-        d->temporary = false;
-        d->state = false;
+    const ulonglong deadline = delay == Infinite ? VFutex::Infinite : VTimer::TicksNanos() + delay * 1000000ull;
+    forever {
+        if (d->consume()) {
+            return true;
+        }
+
+        ulonglong timeout = VFutex::Infinite;
+        if (deadline != VFutex::Infinite) {
+            const ulonglong now = VTimer::TicksNanos();
+            if (now >= deadline) {
+                return false;
+            }
+            timeout = deadline - now;
+        }
+
+        // Setting the state clears the flag, and wakes us if it was there
+        int expected = Private::Reset;
+        const int waiting = Private::Reset | Private::Waiting;
+        if (d->state.compare_exchange_strong(expected, waiting) || expected == waiting) {
+            VFutex::Wait(&d->state, waiting, timeout);
+        }
     }
-    return state;
 }
 
 void VSignal::set()
 {
-    d->updateState(true, false, true);
+    d->update(Private::Set);
 }
 
 void VSignal::reset()
 {
-    d->updateState(false, false, false);
+    d->update(Private::Reset);
 }
 
 void VSignal::pulse()
 {
-    d->updateState(true, true, true);
+    d->update(Private::Pulsed);
 }
 
 NV_NAMESPACE_END
@@ -0,0 +1,313 @@
+#pragma once
+
+#include "vglobal.h"
+#include "VLog.h"
+
+#include <new>
+#include <utility>
+#include <type_traits>
+
+NV_NAMESPACE_BEGIN
+
+// An array keeping up to N elements inline, which only allocates once it
+// grows beyond them. It has the API of VArray, so a typedef switches a caller
+// over. Moving an inline array moves its elements one by one.
+template <class E, int N>
+class VSmallArray
+{
+public:
+    typedef E *Iterator;
+    typedef const E *ConstIterator;
+    typedef E ValueType;
+
+    VSmallArray()
+        : m_data(inlineData())
+        , m_size(0)
+        , m_capacity(N)
+    {
+    }
+
+    VSmallArray(const VSmallArray &source)
+        : m_data(inlineData())
+        , m_size(0)
+        , m_capacity(N)
+    {
+        append(source);
+    }
+
+    VSmallArray(VSmallArray &&source)
+        : m_data(inlineData())
+        , m_size(0)
+        , m_capacity(N)
+    {
+        take(std::move(source));
+    }
+
+    ~VSmallArray()
+    {
+        clear();
+        release();
+    }
+
+    VSmallArray &operator = (const VSmallArray &source)
+    {
+        if (this != &source) {
+            clear();
+            append(source);
+        }
+        return *this;
+    }
+
+    VSmallArray &operator = (VSmallArray &&source)
+    {
+        if (this != &source) {
+            clear();
+            release();
+            take(std::move(source));
+        }
+        return *this;
+    }
+
+    int length() const { return m_size; }
+    uint size() const { return m_size; }
+    int capacity() const { return m_capacity; }
+    bool isEmpty() const { return m_size == 0; }
+    // Whether the elements still live inside the array
+    bool isInline() const { return m_data == inlineData(); }
+
+    E *data() { return m_data; }
+    const E *data() const { return m_data; }
+
+    Iterator begin() { return m_data; }
+    Iterator end() { return m_data + m_size; }
+    ConstIterator begin() const { return m_data; }
+    ConstIterator end() const { return m_data + m_size; }
+
+    const E &first() const { return m_data[0]; }
+    E &first() { return m_data[0]; }
+
+    const E &last() const { return m_data[m_size - 1]; }
+    E &last() { return m_data[m_size - 1]; }
+
+    // Checked like VArray, which goes through std::vector::at()
+    E &operator[](int i) { vAssert((uint) i < (uint) m_size); return m_data[i]; }
+    const E &operator[](int i) const { return at(i); }
+    const E &at(uint i) const { vAssert(i < (uint) m_size); return m_data[i]; }
+
+    void reserve(int capacity)
+    {
+        if (capacity <= m_capacity) {
+            return;
+        }
+
+        E *data = static_cast<E *>(::operator new(capacity * sizeof(E)));
+        for (int i = 0; i < m_size; i++) {
+            new (data + i) E(std::move(m_data[i]));
+            m_data[i].~E();
+        }
+        release();
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    void resize(int size)
+    {
+        reserve(size);
+        while (m_size < size) {
+            new (m_data + m_size) E();
+            m_size++;
+        }
+        while (m_size > size) {
+            removeLast();
+        }
+    }
+
+    uint allocBack()
+    {
+        const uint index = m_size;
+        resize(m_size + 1);
+        return index;
+    }
+
+    // Keeps the heap block, if there is one
+    void clear()
+    {
+        for (int i = 0; i < m_size; i++) {
+            m_data[i].~E();
+        }
+        m_size = 0;
+    }
+
+    VSmallArray &operator << (const E &e)
+    {
+        append(e);
+        return *this;
+    }
+
+    VSmallArray &operator << (E &&e)
+    {
+        append(std::move(e));
+        return *this;
+    }
+
+    VSmallArray &operator << (const VSmallArray &elements)
+    {
+        append(elements);
+        return *this;
+    }
+
+    void append(const E &e)
+    {
+        if (m_size == m_capacity) {
+            // e may live in this array
+            E copy(e);
+            grow();
+            new (m_data + m_size) E(std::move(copy));
+        } else {
+            new (m_data + m_size) E(e);
+        }
+        m_size++;
+    }
+
+    void append(E &&e)
+    {
+        if (m_size == m_capacity) {
+            E moved(std::move(e));
+            grow();
+            new (m_data + m_size) E(std::move(moved));
+        } else {
+            new (m_data + m_size) E(std::move(e));
+        }
+        m_size++;
+    }
+
+    void append(const VSmallArray &elements)
+    {
+        reserve(m_size + elements.m_size);
+        for (const E &e : elements) {
+            append(e);
+        }
+    }
+
+    void insert(int index, E &&e)
+    {
+        append(std::move(e));
+        for (int i = m_size - 1; i > index; i--) {
+            std::swap(m_data[i], m_data[i - 1]);
+        }
+    }
+
+    void insert(int index, const E &e) { insert(index, E(e)); }
+
+    void prepend(const E &e) { insert(0, e); }
+    void prepend(E &&e) { insert(0, std::move(e)); }
+
+    void removeFirst() { removeAt(0); }
+
+    void removeLast()
+    {
+        m_size--;
+        m_data[m_size].~E();
+    }
+
+    void removeAt(int index)
+    {
+        for (int i = index + 1; i < m_size; i++) {
+            m_data[i - 1] = std::move(m_data[i]);
+        }
+        removeLast();
+    }
+
+    void removeOne(const E &e)
+    {
+        const int index = indexOf(e);
+        if (index >= 0) {
+            removeAt(index);
+        }
+    }
+
+    void removeAll(const E &e)
+    {
+        int kept = 0;
+        for (int i = 0; i < m_size; i++) {
+            if (!(m_data[i] == e)) {
+                if (kept != i) {
+                    m_data[kept] = std::move(m_data[i]);
+                }
+                kept++;
+            }
+        }
+        while (m_size > kept) {
+            removeLast();
+        }
+    }
+
+    void removeAtUnordered(uint index)
+    {
+        if (index >= size()) {
+            return;
+        }
+        if (index != size() - 1) {
+            m_data[index] = std::move(last());
+        }
+        removeLast();
+    }
+
+    bool contains(const E &e) const { return indexOf(e) >= 0; }
+
+    int indexOf(const E &e) const
+    {
+        for (int i = 0; i < m_size; i++) {
+            if (m_data[i] == e) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+private:
+    typedef typename std::aligned_storage<sizeof(E), std::alignment_of<E>::value>::type Storage;
+
+    E *inlineData() { return reinterpret_cast<E *>(m_inline); }
+    const E *inlineData() const { return reinterpret_cast<const E *>(m_inline); }
+
+    void grow() { reserve(m_capacity * 2); }
+
+    // Frees the heap block and goes back to the inline storage. The array
+    // must be empty.
+    void release()
+    {
+        if (!isInline()) {
+            ::operator delete(m_data);
+            m_data = inlineData();
+            m_capacity = N;
+        }
+    }
+
+    // Takes the elements of source, which is left empty. This array must be
+    // empty and inline.
+    void take(VSmallArray &&source)
+    {
+        if (source.isInline()) {
+            for (int i = 0; i < source.m_size; i++) {
+                new (m_data + i) E(std::move(source.m_data[i]));
+            }
+            m_size = source.m_size;
+            source.clear();
+        } else {
+            m_data = source.m_data;
+            m_size = source.m_size;
+            m_capacity = source.m_capacity;
+            source.m_data = source.inlineData();
+            source.m_size = 0;
+            source.m_capacity = N;
+        }
+    }
+
+    E *m_data;
+    int m_size;
+    int m_capacity;
+    Storage m_inline[N];
+};
+
+NV_NAMESPACE_END
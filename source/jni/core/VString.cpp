@@ -1,4 +1,6 @@
 #include "VString.h"
+#include "VStringView.h"
+#include "VUnicode.h"
 
 #include <stdarg.h>
 #include <sstream>
@@ -121,10 +123,7 @@ void VString::assign(const char16_t *str, uint size)
         return;
     }
 
-    resize(size);
-    for (uint i = 0; i < size; i++) {
-        operator [](i) = str[i];
-    }
+    basic_string::assign(str, size);
 }
 
 VString VString::toUpper() const
@@ -255,74 +254,26 @@ std::string VString::toStdString() const
 
 VByteArray VString::toUtf8() const
 {
-    VByteArray utf8;
-    uint code = 0;
-    for (const char16_t &in : *this) {
-        if (in >= 0xd800 && in <= 0xdbff) {
-            code = ((in - 0xd800) << 10) + 0x10000;
-        } else {
-            if (in >= 0xdc00 && in <= 0xdfff) {
-                code |= in - 0xdc00;
-            } else {
-                code = in;
-            }
-
-            if (code <= 0x7f) {
-                utf8.append(static_cast<char>(code));
-            } else if (code <= 0x7ff) {
-                utf8.append(static_cast<char>(0xc0 | ((code >> 6) & 0x1f)));
-                utf8.append(static_cast<char>(0x80 | (code & 0x3f)));
-            } else if (code <= 0xffff) {
-                utf8.append(static_cast<char>(0xe0 | ((code >> 12) & 0x0f)));
-                utf8.append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
-                utf8.append(static_cast<char>(0x80 | (code & 0x3f)));
-            } else {
-                utf8.append(static_cast<char>(0xf0 | ((code >> 18) & 0x07)));
-                utf8.append(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
-                utf8.append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
-                utf8.append(static_cast<char>(0x80 | (code & 0x3f)));
-            }
-            code = 0;
-        }
-    }
-    return utf8;
+    return VStringView(*this).toUtf8();
 }
 
 VString VString::fromUtf8(const VByteArray &utf8)
 {
-    VString utf16;
-    unsigned int code = 0;
-    int following = 0;
-    for (const uchar &ch : utf8) {
-        if (ch <= 0x7f) {
-            code = ch;
-            following = 0;
-        } else if (ch <= 0xbf) {
-            if (following > 0) {
-                code = (code << 6) | (ch & 0x3f);
-                --following;
-            }
-        } else if (ch <= 0xdf) {
-            code = ch & 0x1f;
-            following = 1;
-        } else if (ch <= 0xef) {
-            code = ch & 0x0f;
-            following = 2;
-        } else {
-            code = ch & 0x07;
-            following = 3;
-        }
+    return fromUtf8(utf8.data(), utf8.size());
+}
 
-        if (following == 0) {
-            if (code > 0xffff) {
-                utf16.append(static_cast<char16_t>(0xd800 + (code >> 10)));
-                utf16.append(static_cast<char16_t>(0xdc00 + (code & 0x03ff)));
-            } else {
-                utf16.append(static_cast<char16_t>(code));
-            }
-            code = 0;
-        }
+VString VString::fromUtf8(const char *utf8, uint size)
+{
+    // A byte never turns into more than one unit, so short text is decoded
+    // in one pass on the stack
+    char16_t buffer[256];
+    if (size <= 256) {
+        return VString(buffer, VUnicode::ToUtf16(utf8, size, buffer));
     }
+
+    VString utf16;
+    utf16.resize(VUnicode::Utf16Length(utf8, size));
+    VUnicode::ToUtf16(utf8, size, &utf16[0]);
     return utf16;
 }
 
@@ -455,37 +406,4 @@ void VString::stripTrailing(const char *str)
     }
 }
 
-// ***** Implement hash static functions
-
-/*// Hash function
-uint VString::BernsteinHashFunction(const void* pdataIn, uint size, uint seed)
-{
-    const UByte*    pdata   = (const UByte*) pdataIn;
-    uint           h       = seed;
-    while (size > 0)
-    {
-        size--;
-        h = ((h << 5) + h) ^ (unsigned) pdata[size];
-    }
-
-    return h;
-}
-
-// Hash function, case-insensitive
-uint VString::BernsteinHashFunctionCIS(const void* pdataIn, uint size, uint seed)
-{
-    const UByte*    pdata = (const UByte*) pdataIn;
-    uint           h = seed;
-    while (size > 0)
-    {
-        size--;
-        h = ((h << 5) + h) ^ OVR_tolower(pdata[size]);
-    }
-
-    // Alternative: "sdbm" hash function, suggested at same web page above.
-    // h = 0;
-    // for bytes { h = (h << 16) + (h << 6) - hash + *p; }
-    return h;
-}*/
-
 NV_NAMESPACE_END
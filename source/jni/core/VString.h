@@ -81,8 +81,10 @@ public:
 
     std::string toStdString() const;
 
+    // Malformed input becomes U+FFFD, see VUnicode
     VByteArray toUtf8() const;
     static VString fromUtf8(const VByteArray &utf8);
+    static VString fromUtf8(const char *utf8, uint size);
 
     VByteArray toLatin1() const;
     static VString fromLatin1(const VByteArray &latin1);
@@ -2,18 +2,87 @@
 
 #include "vglobal.h"
 #include "VString.h"
-#include "VMap.h"
+#include "VStringView.h"
+#include "VHash.h"
+
+#include <ctype.h>
 
 NV_NAMESPACE_BEGIN
 
+// Bernstein's hash over UTF-16 units. A const char * is hashed and compared
+// unit by unit the way VString(const char *) reads it, and a VByteArrayView
+// as UTF-8, so either is found without building a VString.
+struct VStringHashTraits
+{
+    static uint Hash(const VString &key) { return Hash(VStringView(key)); }
+
+    static uint Hash(VStringView key)
+    {
+        uint hash = 5381;
+        for (char16_t ch : key) {
+            hash = ((hash << 5) + hash) ^ ch;
+        }
+        return hash;
+    }
+
+    static uint Hash(const char *key)
+    {
+        uint hash = 5381;
+        for (; *key; key++) {
+            hash = ((hash << 5) + hash) ^ (char16_t) *key;
+        }
+        return hash;
+    }
+
+    static uint Hash(VByteArrayView key) { return Hash(VDecodedUtf8(key).view()); }
+
+    static bool Equal(const VString &key, const VString &other) { return key == other; }
+    static bool Equal(const VString &key, const char *other) { return key == other; }
+    static bool Equal(const VString &key, VStringView other) { return VStringView(key) == other; }
+    static bool Equal(const VString &key, VByteArrayView other) { return VStringView(key) == VDecodedUtf8(other).view(); }
+};
+
+// The same, ignoring the case of ASCII letters
+struct VStringCaseHashTraits
+{
+    static uint Hash(const VString &key) { return Hash(VStringView(key)); }
+
+    static uint Hash(VStringView key)
+    {
+        uint hash = 5381;
+        for (char16_t ch : key) {
+            hash = ((hash << 5) + hash) ^ Lower(ch);
+        }
+        return hash;
+    }
+
+    static uint Hash(const char *key)
+    {
+        uint hash = 5381;
+        for (; *key; key++) {
+            hash = ((hash << 5) + hash) ^ Lower((char16_t) *key);
+        }
+        return hash;
+    }
+
+    static uint Hash(VByteArrayView key) { return Hash(VDecodedUtf8(key).view()); }
+
+    static bool Equal(const VString &key, const VString &other) { return key.icompare(other) == 0; }
+    static bool Equal(const VString &key, const char *other) { return key.icompare(other) == 0; }
+    static bool Equal(const VString &key, VStringView other) { return VStringView(key).icompare(other) == 0; }
+    static bool Equal(const VString &key, VByteArrayView other) { return VStringView(key).icompare(VDecodedUtf8(other).view()) == 0; }
+
+    static char16_t Lower(char16_t ch) { return ch < 128 ? (char16_t) tolower(ch) : ch; }
+};
+
+template<class T>
+class VStringHash : public VHash<VString, T, VStringHashTraits>
+{
+};
+
 template<class T>
-class VStringHash : public VMap<VString, T>
+class VStringCaseHash : public VHash<VString, T, VStringCaseHashTraits>
 {
-public:
-    typedef T ValueType;
-    typedef std::map<VString, T> SelfType;
-    typedef typename std::map<VString, T>::iterator Iterator;
-    typedef typename std::map<VString, T>::const_iterator ConstIterator;
 };
 
 NV_NAMESPACE_END
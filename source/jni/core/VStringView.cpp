@@ -0,0 +1,195 @@
+#include "VStringView.h"
+#include "VUnicode.h"
+
+#include <ctype.h>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+    // Takes 8-bit text only when it is ASCII, which widens to the same units
+    template<class T>
+    int RangeCompare(const char16_t *str1, uint size1, const T *str2, uint size2)
+    {
+        const uint size = size1 < size2 ? size1 : size2;
+        for (uint i = 0; i < size; i++) {
+            const char16_t ch1 = str1[i];
+            const char16_t ch2 = str2[i];
+            if (ch1 != ch2) {
+                return ch1 < ch2 ? -1 : 1;
+            }
+        }
+        return size1 == size2 ? 0 : (size1 < size2 ? -1 : 1);
+    }
+
+    template<class T>
+    int RangeCaseCompare(const char16_t *str1, uint size1, const T *str2, uint size2)
+    {
+        const uint size = size1 < size2 ? size1 : size2;
+        for (uint i = 0; i < size; i++) {
+            char16_t ch1 = str1[i];
+            char16_t ch2 = str2[i];
+            if (ch1 != ch2) {
+                ch1 = ch1 < 128 ? tolower(ch1) : ch1;
+                ch2 = ch2 < 128 ? tolower(ch2) : ch2;
+                if (ch1 != ch2) {
+                    return ch1 < ch2 ? -1 : 1;
+                }
+            }
+        }
+        return size1 == size2 ? 0 : (size1 < size2 ? -1 : 1);
+    }
+
+    template<class C>
+    int FindForward(const C *data, uint size, C ch, uint from)
+    {
+        for (uint i = from; i < size; i++) {
+            if (data[i] == ch) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    template<class C>
+    int FindBackward(const C *data, uint size, C ch)
+    {
+        for (uint i = size; i > 0; i--) {
+            if (data[i - 1] == ch) {
+                return i - 1;
+            }
+        }
+        return -1;
+    }
+
+    // ASCII, by far the most common, is compared in place
+    bool IsAscii(VByteArrayView text)
+    {
+        for (char ch : text) {
+            if ((uchar) ch >= 0x80) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int VByteArrayView::indexOf(char ch, uint from) const
+{
+    return FindForward(m_data, m_size, ch, from);
+}
+
+int VByteArrayView::lastIndexOf(char ch) const
+{
+    return FindBackward(m_data, m_size, ch);
+}
+
+int VByteArrayView::compare(VByteArrayView other) const
+{
+    const uint size = m_size < other.m_size ? m_size : other.m_size;
+    const int ret = size ? memcmp(m_data, other.m_data, size) : 0;
+    if (ret != 0) {
+        return ret < 0 ? -1 : 1;
+    }
+    return m_size == other.m_size ? 0 : (m_size < other.m_size ? -1 : 1);
+}
+
+VString VByteArrayView::toString() const
+{
+    return VString::fromUtf8(m_data, m_size);
+}
+
+VStringView::VStringView(const char16_t *str)
+    : m_data(str)
+    , m_size(0)
+{
+    if (str) {
+        while (str[m_size]) {
+            m_size++;
+        }
+    }
+}
+
+int VStringView::indexOf(char16_t ch, uint from) const
+{
+    return FindForward(m_data, m_size, ch, from);
+}
+
+int VStringView::lastIndexOf(char16_t ch) const
+{
+    return FindBackward(m_data, m_size, ch);
+}
+
+bool VStringView::startsWith(VStringView prefix) const
+{
+    return prefix.m_size <= m_size && left(prefix.m_size).compare(prefix) == 0;
+}
+
+bool VStringView::endsWith(VStringView postfix) const
+{
+    return postfix.m_size <= m_size && right(postfix.m_size).compare(postfix) == 0;
+}
+
+int VStringView::compare(VStringView other) const
+{
+    return RangeCompare(m_data, m_size, other.m_data, other.m_size);
+}
+
+int VStringView::compare(VByteArrayView other) const
+{
+    if (IsAscii(other)) {
+        return RangeCompare(m_data, m_size, other.data(), other.size());
+    }
+    return compare(VDecodedUtf8(other).view());
+}
+
+int VStringView::icompare(VStringView other) const
+{
+    return RangeCaseCompare(m_data, m_size, other.m_data, other.m_size);
+}
+
+int VStringView::icompare(VByteArrayView other) const
+{
+    if (IsAscii(other)) {
+        return RangeCaseCompare(m_data, m_size, other.data(), other.size());
+    }
+    return icompare(VDecodedUtf8(other).view());
+}
+
+VByteArray VStringView::toUtf8() const
+{
+    // A unit never turns into more than three bytes, so short text is
+    // encoded in one pass on the stack
+    char buffer[768];
+    if (m_size <= 256) {
+        return VByteArray(buffer, VUnicode::ToUtf8(m_data, m_size, buffer));
+    }
+
+    VByteArray utf8;
+    utf8.resize(VUnicode::Utf8Length(m_data, m_size));
+    VUnicode::ToUtf8(m_data, m_size, &utf8[0]);
+    return utf8;
+}
+
+uint VStringView::toUtf8(char *buffer, uint capacity) const
+{
+    // Nothing to measure if even three bytes per unit fit
+    const uint length = m_size * 3 <= capacity ? 0 : VUnicode::Utf8Length(m_data, m_size);
+    if (length > capacity) {
+        return length;
+    }
+    return VUnicode::ToUtf8(m_data, m_size, buffer);
+}
+
+std::ostream &operator << (std::ostream &out, VStringView view)
+{
+    char buffer[256];
+    const uint length = view.toUtf8(buffer, sizeof(buffer));
+    if (length <= sizeof(buffer)) {
+        out.write(buffer, length);
+    } else {
+        out << view.toUtf8();
+    }
+    return out;
+}
+
+NV_NAMESPACE_END
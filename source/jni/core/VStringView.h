@@ -0,0 +1,158 @@
+#pragma once
+
+#include "vglobal.h"
+#include "VString.h"
+#include "VByteArray.h"
+#include "VUnicode.h"
+
+#include <string.h>
+#include <ostream>
+
+NV_NAMESPACE_BEGIN
+
+// 8-bit text owned by someone else, such as a literal or a VByteArray. It
+// is not terminated, holds UTF-8 and must not outlive what it points to.
+class VByteArrayView
+{
+public:
+    typedef const char *ConstIterator;
+
+    constexpr VByteArrayView() : m_data(nullptr), m_size(0) {}
+    VByteArrayView(const char *str) : m_data(str), m_size(str ? strlen(str) : 0) {}
+    constexpr VByteArrayView(const char *data, uint size) : m_data(data), m_size(size) {}
+    VByteArrayView(const std::string &bytes) : m_data(bytes.data()), m_size(bytes.size()) {}
+
+    const char *data() const { return m_data; }
+    uint size() const { return m_size; }
+    int length() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    ConstIterator begin() const { return m_data; }
+    ConstIterator end() const { return m_data + m_size; }
+
+    char at(uint i) const { return m_data[i]; }
+    char operator [] (uint i) const { return m_data[i]; }
+    char first() const { return m_data[0]; }
+    char last() const { return m_data[m_size - 1]; }
+
+    VByteArrayView mid(uint from, uint length = 0) const { return VByteArrayView(m_data + from, length ? length : m_size - from); }
+    VByteArrayView left(uint count) const { return VByteArrayView(m_data, count); }
+    VByteArrayView right(uint count) const { return VByteArrayView(m_data + m_size - count, count); }
+
+    int indexOf(char ch, uint from = 0) const;
+    int lastIndexOf(char ch) const;
+
+    bool startsWith(VByteArrayView prefix) const { return prefix.m_size <= m_size && memcmp(m_data, prefix.m_data, prefix.m_size) == 0; }
+    bool endsWith(VByteArrayView postfix) const { return postfix.m_size <= m_size && memcmp(end() - postfix.m_size, postfix.m_data, postfix.m_size) == 0; }
+
+    int compare(VByteArrayView other) const;
+
+    bool operator == (VByteArrayView other) const { return m_size == other.m_size && memcmp(m_data, other.m_data, m_size) == 0; }
+    bool operator != (VByteArrayView other) const { return !(*this == other); }
+    bool operator < (VByteArrayView other) const { return compare(other) < 0; }
+
+    VByteArray toByteArray() const { return VByteArray(m_data, m_size); }
+    VString toString() const;
+
+    friend std::ostream &operator << (std::ostream &out, VByteArrayView view) { out.write(view.m_data, view.m_size); return out; }
+
+private:
+    const char *m_data;
+    uint m_size;
+};
+
+// UTF-16 text owned by someone else, usually a VString. It is not terminated
+// and must not outlive what it points to.
+class VStringView
+{
+public:
+    typedef const char16_t *ConstIterator;
+
+    constexpr VStringView() : m_data(nullptr), m_size(0) {}
+    VStringView(const char16_t *str);
+    constexpr VStringView(const char16_t *data, uint size) : m_data(data), m_size(size) {}
+    VStringView(const std::u16string &str) : m_data(str.data()), m_size(str.size()) {}
+
+    const char16_t *data() const { return m_data; }
+    uint size() const { return m_size; }
+    int length() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    ConstIterator begin() const { return m_data; }
+    ConstIterator end() const { return m_data + m_size; }
+
+    char16_t at(uint i) const { return m_data[i]; }
+    char16_t operator [] (uint i) const { return m_data[i]; }
+    char16_t first() const { return m_data[0]; }
+    char16_t last() const { return m_data[m_size - 1]; }
+
+    VStringView mid(uint from, uint length = 0) const { return VStringView(m_data + from, length ? length : m_size - from); }
+    VStringView left(uint count) const { return VStringView(m_data, count); }
+    VStringView right(uint count) const { return VStringView(m_data + m_size - count, count); }
+
+    int indexOf(char16_t ch, uint from = 0) const;
+    int lastIndexOf(char16_t ch) const;
+
+    bool startsWith(VStringView prefix) const;
+    bool endsWith(VStringView postfix) const;
+
+    int compare(VStringView other) const;
+    // Compares with UTF-8 text as VString::fromUtf8() decodes it
+    int compare(VByteArrayView other) const;
+
+    // Ignores the case of ASCII letters
+    int icompare(VStringView other) const;
+    int icompare(VByteArrayView other) const;
+
+    bool operator == (VStringView other) const { return m_size == other.m_size && compare(other) == 0; }
+    bool operator != (VStringView other) const { return !(*this == other); }
+    bool operator < (VStringView other) const { return compare(other) < 0; }
+
+    bool operator == (VByteArrayView other) const { return compare(other) == 0; }
+    bool operator != (VByteArrayView other) const { return !(*this == other); }
+
+    VString toString() const { return VString(m_data, m_size); }
+    VByteArray toUtf8() const;
+
+    // Writes the text as UTF-8 to buffer without terminating it. Returns the
+    // number of bytes it takes, which may be more than capacity, in which
+    // case nothing is written.
+    uint toUtf8(char *buffer, uint capacity) const;
+
+    friend std::ostream &operator << (std::ostream &out, VStringView view);
+
+private:
+    const char16_t *m_data;
+    uint m_size;
+};
+
+// A VByteArrayView decoded as UTF-8 the way VString::fromUtf8() does it, so
+// text built from UTF-8 is found through views of the same bytes. Short text
+// is decoded on the stack.
+class VDecodedUtf8
+{
+public:
+    explicit VDecodedUtf8(VByteArrayView utf8)
+    {
+        // A byte never turns into more than one unit
+        if (utf8.size() <= StackSize) {
+            m_view = VStringView(m_buffer, VUnicode::ToUtf16(utf8.data(), utf8.size(), m_buffer));
+        } else {
+            m_string = VString::fromUtf8(utf8.data(), utf8.size());
+            m_view = VStringView(m_string);
+        }
+    }
+
+    VStringView view() const { return m_view; }
+
+private:
+    enum { StackSize = 128 };
+
+    char16_t m_buffer[StackSize];
+    VString m_string;
+    VStringView m_view;
+
+    NV_DISABLE_COPY(VDecodedUtf8)
+};
+
+NV_NAMESPACE_END
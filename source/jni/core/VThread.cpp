@@ -1,11 +1,19 @@
 #include "VThread.h"
 #include "VMap.h"
 #include "VMutex.h"
+#include "VSignal.h"
 #include "VLog.h"
 
 #include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 
 NV_NAMESPACE_BEGIN
 
@@ -45,6 +53,9 @@ private:
     mutable VMutex m_mutex;
 };
 
+// Android's THREAD_PRIORITY_URGENT_DISPLAY, the best a normal app may ask for
+const int UrgentNice = -8;
+
 } //anonymous namespace
 
 struct VThread::Private
@@ -62,10 +73,19 @@ struct VThread::Private
     std::atomic<int> suspendCount;
 
     pthread_t handle;
+    std::atomic<int> systemId;
+
+    // Applied as the thread starts, if set before. settingsMutex also orders
+    // the publication of systemId so that no setting is lost or reverted
+    uint affinity;
+    VThread::SchedulingPolicy policy;
+    int realtimePriority;
+    VMutex settingsMutex;
 
     static VThreadList pool;
 
-    VMutex exitMutex;
+    // Set while the thread is not running
+    VSignal finished;
 
     Private(VThread *self)
         : self(self)
@@ -78,6 +98,11 @@ struct VThread::Private
         , threadFlags(0)
         , suspendCount(0)
         , handle(0)
+        , systemId(0)
+        , affinity(0)
+        , policy(VThread::NormalScheduling)
+        , realtimePriority(0)
+        , finished(true)
     {
     }
 
@@ -106,6 +131,18 @@ struct VThread::Private
     static void *StartFunction(void *data)
     {
         Private *d = (Private *) data;
+        {
+            VMutex::Locker locker(&d->settingsMutex);
+            const int tid = VThread::currentThreadSystemId();
+            d->systemId = tid;
+            if (d->affinity) {
+                VThread::SetAffinity(tid, d->affinity);
+            }
+            if (d->policy != VThread::NormalScheduling) {
+                VThread::SetRealtime(tid, d->policy, d->realtimePriority);
+            }
+        }
+
         int result = d->run();
         // Signal the thread as done and release it atomically.
         d->threadFlags &= ~(uint) Private::Started;
@@ -165,6 +202,49 @@ void VThread::setName(const char *name)
     }
 }
 
+uint VThread::affinity() const
+{
+    int tid;
+    {
+        VMutex::Locker locker(&d->settingsMutex);
+        tid = d->systemId;
+        if (tid == 0) {
+            if (d->affinity) {
+                return d->affinity;
+            }
+            // The mask has a bit per CPU and holds no more than 32 of them
+            const int count = CpuCount();
+            return count >= 32 ? ~0u : (1u << count) - 1;
+        }
+    }
+
+    unsigned long mask = 0;
+    if (syscall(__NR_sched_getaffinity, tid, sizeof(mask), &mask) < 0) {
+        vWarn("VThread::affinity() failed. Error:" << strerror(errno));
+    }
+    return (uint) mask;
+}
+
+bool VThread::setAffinity(uint cpuMask)
+{
+    VMutex::Locker locker(&d->settingsMutex);
+    d->affinity = cpuMask;
+    return d->systemId == 0 || SetAffinity(d->systemId, cpuMask);
+}
+
+bool VThread::setRealtime(SchedulingPolicy policy, int priority)
+{
+    VMutex::Locker locker(&d->settingsMutex);
+    d->policy = policy;
+    d->realtimePriority = priority;
+    return d->systemId == 0 || SetRealtime(d->systemId, policy, priority);
+}
+
+VThread::CpuStats VThread::cpuStats() const
+{
+    return d->systemId == 0 ? CpuStats() : GetCpuStats(d->systemId);
+}
+
 bool VThread::start()
 {
     if (state() != NotRunning) {
@@ -174,8 +254,11 @@ bool VThread::start()
 
     d->exitCode = 0;
     d->suspendCount = 0;
-    d->threadFlags = 0;
-    d->exitMutex.lock();
+    d->settingsMutex.lock();
+    d->systemId = 0;
+    d->settingsMutex.unlock();
+    d->threadFlags = Private::Started;
+    d->finished.reset();
 
     pthread_attr_t attr;
     pthread_attr_init(&attr);
@@ -189,6 +272,7 @@ bool VThread::start()
     pthread_attr_destroy(&attr);
     if (result) {
         d->threadFlags = 0;
+        d->finished.set();
         return false;
     }
 
@@ -209,17 +293,19 @@ void VThread::exit(int exitCode)
 
     d->pool.remove(this);
 
+    // The thread object may be deleted as soon as the waiters are released,
+    // set() touches nothing of it after storing the state
+    d->finished.set();
     pthread_exit((void *) exitCode);
-    d->exitMutex.unlock();
 }
 
 bool VThread::wait()
 {
-    bool result = d->exitMutex.tryLock();
-    if (result) {
-        d->exitMutex.unlock();
+    if (pthread_equal(pthread_self(), d->handle)) {
+        vWarn("VThread::wait() - a thread can't wait for itself");
+        return false;
     }
-    return result;
+    return d->finished.wait();
 }
 
 bool VThread::suspend()
@@ -258,6 +344,17 @@ uint VThread::id() const
     return (uint) d->handle;
 }
 
+int VThread::systemId() const
+{
+    return d->systemId;
+}
+
+int VThread::CpuCount()
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int) count : 1;
+}
+
 int VThread::GetOSPriority(VThread::Priority priority)
 {
     const int minPriority = sched_get_priority_min(SCHED_NORMAL);
@@ -275,6 +372,120 @@ int VThread::GetOSPriority(VThread::Priority priority)
     }
 }
 
+uint VThread::BigCoreMask()
+{
+    static const uint mask = []{
+        const long count = sysconf(_SC_NPROCESSORS_CONF);
+        uint all = 0;
+        uint big = 0;
+        long maxFrequency = 0;
+        for (int i = 0; i < count && i < 32; i++) {
+            all |= 1u << i;
+
+            // Offline cores may not report any frequency
+            char path[80];
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+            FILE *file = fopen(path, "r");
+            if (file == nullptr) {
+                continue;
+            }
+            long frequency = 0;
+            if (fscanf(file, "%ld", &frequency) == 1) {
+                if (frequency > maxFrequency) {
+                    maxFrequency = frequency;
+                    big = 0;
+                }
+                if (frequency == maxFrequency) {
+                    big |= 1u << i;
+                }
+            }
+            fclose(file);
+        }
+        return big ? big : (all ? all : 1u);
+    }();
+    return mask;
+}
+
+bool VThread::SetAffinity(int tid, uint cpuMask)
+{
+    // Bionic has no pthread_setaffinity_np, so go to the kernel by tid
+    unsigned long mask = cpuMask;
+    if (syscall(__NR_sched_setaffinity, tid, sizeof(mask), &mask) != 0) {
+        vWarn("VThread::SetAffinity(" << tid << ", " << cpuMask << ") failed. Error:" << strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool VThread::SetRealtime(int tid, SchedulingPolicy policy, int priority)
+{
+    sched_param param;
+    param.sched_priority = 0;
+    if (policy == NormalScheduling) {
+        return sched_setscheduler(tid, SCHED_NORMAL, &param) == 0;
+    }
+
+    param.sched_priority = priority;
+    if (sched_setscheduler(tid, policy == FifoScheduling ? SCHED_FIFO : SCHED_RR, &param) == 0) {
+        return true;
+    }
+
+    // Fall back to the lowest nice value the rlimit allows
+    const int error = errno;
+    int nice = UrgentNice;
+    while (nice < 0 && setpriority(PRIO_PROCESS, tid, nice) != 0) {
+        nice++;
+    }
+    vWarn("VThread::SetRealtime(" << tid << ") failed. Error:" << strerror(error) << ". Running at nice " << nice);
+    return false;
+}
+
+VThread::CpuStats VThread::GetCpuStats(int tid)
+{
+    CpuStats stats;
+    char path[64];
+    char line[512];
+
+    snprintf(path, sizeof(path), "/proc/self/task/%d/stat", tid);
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        return stats;
+    }
+    if (fgets(line, sizeof(line), file)) {
+        // The fields of proc(5) follow the name, which may hold spaces
+        char *fields = strrchr(line, ')');
+        if (fields) {
+            const double tick = 1.0 / sysconf(_SC_CLK_TCK);
+            char *save = nullptr;
+            int field = 3;
+            for (char *token = strtok_r(fields + 1, " ", &save); token; token = strtok_r(nullptr, " ", &save), field++) {
+                if (field == 14) {
+                    stats.userTime = strtoull(token, nullptr, 10) * tick;
+                } else if (field == 15) {
+                    stats.systemTime = strtoull(token, nullptr, 10) * tick;
+                } else if (field == 39) {
+                    stats.lastCpu = atoi(token);
+                    break;
+                }
+            }
+        }
+    }
+    fclose(file);
+
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", tid);
+    file = fopen(path, "r");
+    if (file == nullptr) {
+        return stats;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "voluntary_ctxt_switches: %llu", &stats.voluntarySwitches) != 1) {
+            sscanf(line, "nonvoluntary_ctxt_switches: %llu", &stats.involuntarySwitches);
+        }
+    }
+    fclose(file);
+    return stats;
+}
+
 bool VThread::Sleep(uint secs)
 {
     sleep(secs);
@@ -297,4 +508,9 @@ uint VThread::currentThreadId()
     return (uint) pthread_self();
 }
 
+int VThread::currentThreadSystemId()
+{
+    return gettid();
+}
+
 NV_NAMESPACE_END
@@ -27,6 +27,33 @@ public:
         IdlePriority,
     };
 
+    enum SchedulingPolicy
+    {
+        NormalScheduling,
+        FifoScheduling,
+        RoundRobinScheduling
+    };
+
+    // What the kernel reports about a thread in /proc/self/task
+    struct CpuStats
+    {
+        CpuStats()
+            : userTime(0.0)
+            , systemTime(0.0)
+            , voluntarySwitches(0)
+            , involuntarySwitches(0)
+            , lastCpu(-1)
+        {
+        }
+
+        // Seconds spent in user and kernel mode
+        double userTime;
+        double systemTime;
+        ulonglong voluntarySwitches;
+        ulonglong involuntarySwitches;
+        int lastCpu;
+    };
+
     VThread();
     VThread(Function function, void *data = nullptr);
 
@@ -40,6 +67,17 @@ public:
 
     void setName(const char *name);
 
+    // Bit n allows core n. A mask set before start() is applied as the
+    // thread starts.
+    uint affinity() const;
+    bool setAffinity(uint cpuMask);
+
+    // Asks for a realtime policy, which needs CAP_SYS_NICE. Without it the
+    // thread gets the lowest nice value allowed and false is returned.
+    bool setRealtime(SchedulingPolicy policy = FifoScheduling, int priority = 1);
+
+    CpuStats cpuStats() const;
+
     virtual bool start();
     virtual void exit(int exitCode = 0);
 
@@ -52,15 +90,27 @@ public:
     bool isSuspended() const;
     State state() const;
     uint id() const;
+    // Linux tid, 0 until the thread runs
+    int systemId() const;
 
     static int CpuCount();
     static int GetOSPriority(Priority priority);
 
+    // The cores with the highest maximum frequency, all of them on a
+    // symmetric CPU
+    static uint BigCoreMask();
+
+    // The same for any thread of the process by its Linux tid
+    static bool SetAffinity(int tid, uint cpuMask);
+    static bool SetRealtime(int tid, SchedulingPolicy policy, int priority);
+    static CpuStats GetCpuStats(int tid);
+
     static bool Sleep(uint secs);
     static bool MSleep(uint msecs);
 
     static VThread *currentThread();
     static uint currentThreadId();
+    static int currentThreadSystemId();
 
 protected:
     virtual int run();
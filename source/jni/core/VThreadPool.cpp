@@ -0,0 +1,267 @@
+#include "VThreadPool.h"
+#include "VArray.h"
+#include "VDeque.h"
+#include "VMutex.h"
+#include "VSemaphore.h"
+
+#include <atomic>
+#include <sched.h>
+
+NV_NAMESPACE_BEGIN
+
+struct VThreadPool::Private
+{
+    struct Worker
+    {
+        Worker(Private *pool, int index)
+            : pool(pool)
+            , index(index)
+            , thread(Main, this)
+            , mutex(false)
+            , size(0)
+        {
+        }
+
+        Private *pool;
+        int index;
+        VThread thread;
+
+        VMutex mutex;
+        VDeque<Task> tasks;
+        // Lets other workers skip an empty deque without locking it
+        std::atomic<int> size;
+
+        static int Main(void *data)
+        {
+            Worker *self = static_cast<Worker *>(data);
+            current = self;
+            self->pool->work(self);
+            current = nullptr;
+            return 0;
+        }
+    };
+
+    static thread_local Worker *current;
+
+    VArray<Worker *> workers;
+    std::atomic<bool> stopping;
+    std::atomic<int> pending;
+    std::atomic<int> idle;
+    std::atomic<uint> nextWorker;
+    VSemaphore wakeup;
+
+    Private()
+        : stopping(false)
+        , pending(0)
+        , idle(0)
+        , nextWorker(0)
+    {
+    }
+
+    Worker *self() const
+    {
+        return current && current->pool == this ? current : nullptr;
+    }
+
+    template<typename T>
+    void push(T &&task)
+    {
+        Worker *worker = self();
+        if (worker == nullptr) {
+            worker = workers[nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size()];
+        }
+
+        worker->mutex.lock();
+        worker->tasks.append(std::forward<T>(task));
+        worker->size.fetch_add(1);
+        worker->mutex.unlock();
+
+        // Pairs with the idle check in work()
+        pending.fetch_add(1);
+        if (idle.load() > 0) {
+            wakeup.post();
+        }
+    }
+
+    bool take(Worker *worker, bool stealing, Task &task)
+    {
+        if (worker->size.load() <= 0) {
+            return false;
+        }
+
+        worker->mutex.lock();
+        bool found = !worker->tasks.isEmpty();
+        if (found) {
+            task = stealing ? worker->tasks.takeFirst() : worker->tasks.takeLast();
+            worker->size.fetch_sub(1);
+            pending.fetch_sub(1);
+        }
+        worker->mutex.unlock();
+        return found;
+    }
+
+    bool take(Worker *self, Task &task)
+    {
+        if (self && take(self, false, task)) {
+            return true;
+        }
+
+        const int workerNum = workers.length();
+        const int start = self ? self->index + 1 : (int) (nextWorker.load(std::memory_order_relaxed) % workerNum);
+        for (int i = 0; i < workerNum; i++) {
+            Worker *victim = workers[(start + i) % workerNum];
+            if (victim != self && take(victim, true, task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(Worker *self)
+    {
+        forever {
+            Task task;
+            if (take(self, task)) {
+                task();
+                continue;
+            }
+
+            if (stopping.load()) {
+                break;
+            }
+
+            idle.fetch_add(1);
+            if (pending.load() > 0 || stopping.load()) {
+                idle.fetch_sub(1);
+                continue;
+            }
+            wakeup.wait();
+            idle.fetch_sub(1);
+        }
+    }
+};
+
+thread_local VThreadPool::Private::Worker *VThreadPool::Private::current = nullptr;
+
+VThreadPool::VThreadPool(int workerNum)
+    : d(new Private)
+{
+    if (workerNum < 1) {
+        workerNum = 1;
+    }
+
+    for (int i = 0; i < workerNum; i++) {
+        Private::Worker *worker = new Private::Worker(d, i);
+        // Image decoders need more than the default stack
+        worker->thread.setStackSize(512 * 1024);
+        d->workers.append(worker);
+    }
+
+    for (Private::Worker *worker : d->workers) {
+        worker->thread.start();
+    }
+}
+
+VThreadPool::~VThreadPool()
+{
+    // Workers finish the queued tasks before they quit
+    d->stopping = true;
+    for (int i = 0; i < d->workers.length(); i++) {
+        d->wakeup.post();
+    }
+
+    for (Private::Worker *worker : d->workers) {
+        worker->thread.wait();
+        delete worker;
+    }
+    delete d;
+}
+
+int VThreadPool::workerCount() const
+{
+    return d->workers.length();
+}
+
+void VThreadPool::run(const Task &task)
+{
+    d->push(task);
+}
+
+void VThreadPool::run(Task &&task)
+{
+    d->push(std::move(task));
+}
+
+bool VThreadPool::runPendingTask()
+{
+    Task task;
+    if (d->take(d->self(), task)) {
+        task();
+        return true;
+    }
+    return false;
+}
+
+void VThreadPool::parallelFor(int begin, int end, const std::function<void(int)> &body, int grain)
+{
+    if (begin >= end) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    // Helpers which start after every chunk is claimed only touch next, so the
+    // range outlives this call but body doesn't need to.
+    struct Range
+    {
+        std::atomic<int> next;
+        std::atomic<int> finished;
+        int end;
+        int grain;
+        const std::function<void(int)> *body;
+    };
+
+    std::shared_ptr<Range> range(new Range);
+    range->next = begin;
+    range->finished = 0;
+    range->end = end;
+    range->grain = grain;
+    range->body = &body;
+
+    auto work = [range]{
+        forever {
+            const int first = range->next.fetch_add(range->grain);
+            if (first >= range->end) {
+                break;
+            }
+            const int last = std::min(first + range->grain, range->end);
+            for (int i = first; i < last; i++) {
+                (*range->body)(i);
+            }
+            range->finished.fetch_add(last - first, std::memory_order_release);
+        }
+    };
+
+    const int chunkNum = (end - begin + grain - 1) / grain;
+    const int helperNum = std::min(chunkNum - 1, workerCount());
+    for (int i = 0; i < helperNum; i++) {
+        run(work);
+    }
+    work();
+
+    const int total = end - begin;
+    while (range->finished.load(std::memory_order_acquire) < total) {
+        if (!runPendingTask()) {
+            sched_yield();
+        }
+    }
+}
+
+VThreadPool *VThreadPool::instance()
+{
+    static VThreadPool pool;
+    return &pool;
+}
+
+NV_NAMESPACE_END
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "VThread.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+NV_NAMESPACE_BEGIN
+
+// Runs tasks on a fixed set of VThreads. Every worker owns a deque: it takes
+// its own tasks from the back and steals from the front of the others' deques
+// when it runs dry.
+class VThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    VThreadPool(int workerNum = VThread::CpuCount());
+    ~VThreadPool();
+
+    int workerCount() const;
+
+    // Tasks run from a worker are queued on its own deque
+    void run(const Task &task);
+    void run(Task &&task);
+
+    // Don't wait for the future from inside a task, use parallelFor() instead
+    template<typename Function>
+    std::future<typename std::result_of<Function()>::type> submit(Function function)
+    {
+        typedef typename std::result_of<Function()>::type Result;
+        std::shared_ptr<std::packaged_task<Result()>> task(new std::packaged_task<Result()>(std::move(function)));
+        std::future<Result> result = task->get_future();
+        run([task]{
+            (*task)();
+        });
+        return result;
+    }
+
+    // Calls body(i) for every i in [begin, end) in chunks of grain indices and
+    // returns once all of them are done. The calling thread takes part, so it
+    // is safe to call from a task.
+    void parallelFor(int begin, int end, const std::function<void(int)> &body, int grain = 1);
+
+    // Runs a queued task in the calling thread. Returns false if there was none.
+    bool runPendingTask();
+
+    // Shared pool with one worker per core
+    static VThreadPool *instance();
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VThreadPool)
+};
+
+NV_NAMESPACE_END
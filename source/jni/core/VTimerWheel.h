@@ -0,0 +1,205 @@
+#pragma once
+
+#include "VArray.h"
+
+#include <algorithm>
+#include <limits.h>
+
+NV_NAMESPACE_BEGIN
+
+// Hierarchical timer wheel keyed by integer ticks.
+// Level n holds the timers due in the current block of 64^(n + 1) ticks, one
+// slot per block of 64^n ticks. When the current tick enters a new block, the
+// matching slot of the level above is cascaded down. Timers beyond the last
+// level wait in an overflow list.
+template <class T>
+class VTimerWheel
+{
+public:
+    VTimerWheel(ulonglong tick = 0)
+        : m_current(tick)
+        , m_size(0)
+    {
+        for (int i = 0; i < LevelNum; i++) {
+            m_occupied[i] = 0;
+        }
+    }
+
+    // The first tick which hasn't expired yet
+    ulonglong currentTick() const { return m_current; }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // Timers due before the current tick expire on the next advance(). An
+    // empty wheel first skips to now, so that the next advance() doesn't walk
+    // every block that went by while it was idle.
+    void insert(ulonglong tick, const T &value, ulonglong now = 0)
+    {
+        skipTo(now);
+        Timer timer;
+        timer.tick = tick;
+        timer.value = value;
+        place(std::move(timer));
+        m_size++;
+    }
+
+    void insert(ulonglong tick, T &&value, ulonglong now = 0)
+    {
+        skipTo(now);
+        Timer timer;
+        timer.tick = tick;
+        timer.value = std::move(value);
+        place(std::move(timer));
+        m_size++;
+    }
+
+    // Returns ULLONG_MAX if there is no timer
+    ulonglong nextTick() const
+    {
+        for (int level = 0; level < LevelNum; level++) {
+            if (m_occupied[level]) {
+                // Occupied slots never lie behind the current one
+                const int index = __builtin_ctzll(m_occupied[level]);
+                return earliest(m_slots[level][index]);
+            }
+        }
+        return earliest(m_overflow);
+    }
+
+    // Hands every timer due at or before tick to output, in tick order
+    template <typename Output>
+    void advance(ulonglong tick, Output output)
+    {
+        while (m_current <= tick) {
+            if (m_size == 0) {
+                m_current = tick + 1;
+                break;
+            }
+
+            const ulonglong blockEnd = m_current | SlotMask;
+            const ulonglong last = std::min(tick, blockEnd);
+            for (ulonglong i = m_current & SlotMask; i <= (last & SlotMask); i++) {
+                if (m_occupied[0] & (1ULL << i)) {
+                    VArray<Timer> &slot = m_slots[0][i];
+                    m_size -= slot.length();
+                    m_occupied[0] &= ~(1ULL << i);
+                    for (Timer &timer : slot) {
+                        output(std::move(timer.value));
+                    }
+                    slot.clear();
+                }
+            }
+
+            m_current = last + 1;
+            if (last == blockEnd) {
+                cascade();
+            }
+        }
+    }
+
+    // Hands every timer to output, due or not, and empties the wheel
+    template <typename Output>
+    void clear(Output output)
+    {
+        for (int level = 0; level < LevelNum; level++) {
+            for (VArray<Timer> &slot : m_slots[level]) {
+                for (Timer &timer : slot) {
+                    output(std::move(timer.value));
+                }
+                slot.clear();
+            }
+            m_occupied[level] = 0;
+        }
+        for (Timer &timer : m_overflow) {
+            output(std::move(timer.value));
+        }
+        m_overflow.clear();
+        m_size = 0;
+    }
+
+private:
+    enum
+    {
+        SlotBits = 6,
+        SlotNum = 1 << SlotBits,
+        SlotMask = SlotNum - 1,
+        LevelNum = 4
+    };
+
+    struct Timer
+    {
+        ulonglong tick;
+        T value;
+    };
+
+    static ulonglong earliest(const VArray<Timer> &timers)
+    {
+        ulonglong result = ULLONG_MAX;
+        for (const Timer &timer : timers) {
+            result = std::min(result, timer.tick);
+        }
+        return result;
+    }
+
+    void skipTo(ulonglong tick)
+    {
+        if (m_size == 0 && tick > m_current) {
+            m_current = tick;
+        }
+    }
+
+    void place(Timer &&timer)
+    {
+        const ulonglong tick = std::max(timer.tick, m_current);
+        for (int level = 0; level < LevelNum; level++) {
+            const int shift = SlotBits * (level + 1);
+            if ((tick >> shift) == (m_current >> shift)) {
+                const int index = (tick >> (SlotBits * level)) & SlotMask;
+                m_slots[level][index].append(std::move(timer));
+                m_occupied[level] |= 1ULL << index;
+                return;
+            }
+        }
+        m_overflow.append(std::move(timer));
+    }
+
+    // Called when m_current enters a new block of level 0
+    void cascade()
+    {
+        int level = 1;
+        while (level < LevelNum && ((m_current >> (SlotBits * level)) & SlotMask) == 0) {
+            level++;
+        }
+
+        VArray<Timer> timers;
+        if (level == LevelNum) {
+            timers.swap(m_overflow);
+            level--;
+        }
+
+        for (; level >= 1; level--) {
+            const int index = (m_current >> (SlotBits * level)) & SlotMask;
+            if (m_occupied[level] & (1ULL << index)) {
+                VArray<Timer> &slot = m_slots[level][index];
+                for (Timer &timer : slot) {
+                    timers.append(std::move(timer));
+                }
+                slot.clear();
+                m_occupied[level] &= ~(1ULL << index);
+            }
+        }
+
+        for (Timer &timer : timers) {
+            place(std::move(timer));
+        }
+    }
+
+    ulonglong m_current;
+    int m_size;
+    ulonglong m_occupied[LevelNum];
+    VArray<Timer> m_slots[LevelNum][SlotNum];
+    VArray<Timer> m_overflow;
+};
+
+NV_NAMESPACE_END
@@ -0,0 +1,391 @@
+#include "VUnicode.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+const uint Invalid = 0xffffffff;
+
+inline bool IsHighSurrogate(uint unit) { return (unit & 0xfc00) == 0xd800; }
+inline bool IsLowSurrogate(uint unit) { return (unit & 0xfc00) == 0xdc00; }
+
+#if defined(__SSE2__)
+
+// Whether the 16 bytes at p are all ASCII
+inline bool IsAscii16(const uchar *p)
+{
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) == 0;
+}
+
+// Whether the 16 units at p are all ASCII
+inline bool IsAscii16(const char16_t *p)
+{
+    const __m128i *in = reinterpret_cast<const __m128i *>(p);
+    const __m128i units = _mm_or_si128(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+    const __m128i high = _mm_and_si128(units, _mm_set1_epi16((short) 0xff80));
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xffff;
+}
+
+inline void Widen16(const uchar *in, char16_t *out)
+{
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    __m128i *units = reinterpret_cast<__m128i *>(out);
+    _mm_storeu_si128(units, _mm_unpacklo_epi8(bytes, _mm_setzero_si128()));
+    _mm_storeu_si128(units + 1, _mm_unpackhi_epi8(bytes, _mm_setzero_si128()));
+}
+
+inline void Narrow16(const char16_t *in, uchar *out)
+{
+    const __m128i *units = reinterpret_cast<const __m128i *>(in);
+    const __m128i bytes = _mm_packus_epi16(_mm_loadu_si128(units), _mm_loadu_si128(units + 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), bytes);
+}
+
+// The UTF-8 size of the 8 units at p, or -1 if there is a surrogate among them
+inline int Utf8Length8(const char16_t *p)
+{
+    const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i top = _mm_and_si128(units, _mm_set1_epi16((short) 0xf800));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(top, _mm_set1_epi16((short) 0xd800)))) {
+        return -1;
+    }
+    const int ascii = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16((short) 0xff80)), zero));
+    const int twoBytes = _mm_movemask_epi8(_mm_cmpeq_epi16(top, zero));
+    // Each unit takes one byte, a second one from 0x80 and a third from 0x800.
+    // The masks have two bits per unit.
+    return 24 - (__builtin_popcount(ascii) + __builtin_popcount(twoBytes)) / 2;
+}
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+inline bool IsZero(uint16x8_t v)
+{
+    const uint64x2_t lanes = vreinterpretq_u64_u16(v);
+    return (vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) == 0;
+}
+
+// Whether the 16 bytes at p are all ASCII
+inline bool IsAscii16(const uchar *p)
+{
+    const uint8x16_t bytes = vld1q_u8(p);
+    const uint8x8_t high = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+    return (vget_lane_u64(vreinterpret_u64_u8(high), 0) & 0x8080808080808080ull) == 0;
+}
+
+// Whether the 16 units at p are all ASCII
+inline bool IsAscii16(const char16_t *p)
+{
+    const uint16_t *in = reinterpret_cast<const uint16_t *>(p);
+    const uint16x8_t units = vorrq_u16(vld1q_u16(in), vld1q_u16(in + 8));
+    return IsZero(vandq_u16(units, vdupq_n_u16(0xff80)));
+}
+
+inline void Widen16(const uchar *in, char16_t *out)
+{
+    const uint8x16_t bytes = vld1q_u8(in);
+    uint16_t *units = reinterpret_cast<uint16_t *>(out);
+    vst1q_u16(units, vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(units + 8, vmovl_u8(vget_high_u8(bytes)));
+}
+
+inline void Narrow16(const char16_t *in, uchar *out)
+{
+    const uint16_t *units = reinterpret_cast<const uint16_t *>(in);
+    vst1q_u8(out, vcombine_u8(vmovn_u16(vld1q_u16(units)), vmovn_u16(vld1q_u16(units + 8))));
+}
+
+// The UTF-8 size of the 8 units at p, or -1 if there is a surrogate among them
+inline int Utf8Length8(const char16_t *p)
+{
+    const uint16x8_t units = vld1q_u16(reinterpret_cast<const uint16_t *>(p));
+    const uint16x8_t top = vandq_u16(units, vdupq_n_u16(0xf800));
+    if (!IsZero(vceqq_u16(top, vdupq_n_u16(0xd800)))) {
+        return -1;
+    }
+    // Each unit takes one byte, a second one from 0x80 and a third from 0x800
+    const uint16x8_t extra = vaddq_u16(vshrq_n_u16(vtstq_u16(units, vdupq_n_u16(0xff80)), 15),
+                                       vshrq_n_u16(vtstq_u16(units, vdupq_n_u16(0xf800)), 15));
+    const uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(extra));
+    return 8 + (int) (vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+}
+
+#else
+
+inline bool IsAscii16(const uchar *p)
+{
+    vuint64 words[2];
+    memcpy(words, p, sizeof(words));
+    return ((words[0] | words[1]) & 0x8080808080808080ull) == 0;
+}
+
+inline bool IsAscii16(const char16_t *p)
+{
+    vuint64 words[4];
+    memcpy(words, p, sizeof(words));
+    return ((words[0] | words[1] | words[2] | words[3]) & 0xff80ff80ff80ff80ull) == 0;
+}
+
+inline void Widen16(const uchar *in, char16_t *out)
+{
+    for (int i = 0; i < 16; i++) {
+        out[i] = in[i];
+    }
+}
+
+inline void Narrow16(const char16_t *in, uchar *out)
+{
+    for (int i = 0; i < 16; i++) {
+        out[i] = (uchar) in[i];
+    }
+}
+
+inline int Utf8Length8(const char16_t *p)
+{
+    int length = 0;
+    for (int i = 0; i < 8; i++) {
+        const uint unit = p[i];
+        if ((unit & 0xf800) == 0xd800) {
+            return -1;
+        }
+        length += 1 + (unit >= 0x80) + (unit >= 0x800);
+    }
+    return length;
+}
+
+#endif
+
+// Decodes the character at p and moves past it. A malformed sequence gives
+// Invalid and only its longest valid prefix is skipped, so the byte which
+// broke it starts the next character.
+inline uint DecodeUtf8(const uchar *&p, const uchar *end)
+{
+    const uint lead = *p++;
+    if (lead < 0x80) {
+        return lead;
+    }
+
+    // Most of the characters outside ASCII in this SDK's text are CJK, which
+    // take three bytes
+    if (lead >= 0xe1 && lead <= 0xec && end - p >= 2) {
+        const uint second = p[0];
+        const uint third = p[1];
+        if ((second & 0xc0) == 0x80 && (third & 0xc0) == 0x80) {
+            p += 2;
+            return ((lead & 0x0f) << 12) | ((second & 0x3f) << 6) | (third & 0x3f);
+        }
+    }
+
+    uint code;
+    int following;
+    uint lower = 0x80;
+    uint upper = 0xbf;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        code = lead & 0x1f;
+        following = 1;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        // No overlong forms and no surrogates
+        code = lead & 0x0f;
+        following = 2;
+        if (lead == 0xe0) {
+            lower = 0xa0;
+        } else if (lead == 0xed) {
+            upper = 0x9f;
+        }
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        // No overlong forms and nothing beyond U+10FFFF
+        code = lead & 0x07;
+        following = 3;
+        if (lead == 0xf0) {
+            lower = 0x90;
+        } else if (lead == 0xf4) {
+            upper = 0x8f;
+        }
+    } else {
+        return Invalid;
+    }
+
+    for (; following > 0; following--) {
+        if (p == end || *p < lower || *p > upper) {
+            return Invalid;
+        }
+        code = (code << 6) | (*p++ & 0x3f);
+        lower = 0x80;
+        upper = 0xbf;
+    }
+    return code;
+}
+
+// Decodes the character at p and moves past it, giving Invalid for an
+// unpaired surrogate
+inline uint DecodeUtf16(const char16_t *&p, const char16_t *end)
+{
+    const uint unit = *p++;
+    if ((unit & 0xf800) != 0xd800) {
+        return unit;
+    }
+    if (IsHighSurrogate(unit) && p != end && IsLowSurrogate(*p)) {
+        return 0x10000 + ((unit - 0xd800) << 10) + (*p++ - 0xdc00);
+    }
+    return Invalid;
+}
+
+inline uchar *EncodeUtf8(uint code, uchar *out)
+{
+    if (code < 0x80) {
+        *out++ = code;
+    } else if (code < 0x800) {
+        *out++ = 0xc0 | (code >> 6);
+        *out++ = 0x80 | (code & 0x3f);
+    } else if (code < 0x10000) {
+        *out++ = 0xe0 | (code >> 12);
+        *out++ = 0x80 | ((code >> 6) & 0x3f);
+        *out++ = 0x80 | (code & 0x3f);
+    } else {
+        *out++ = 0xf0 | (code >> 18);
+        *out++ = 0x80 | ((code >> 12) & 0x3f);
+        *out++ = 0x80 | ((code >> 6) & 0x3f);
+        *out++ = 0x80 | (code & 0x3f);
+    }
+    return out;
+}
+
+inline char16_t *EncodeUtf16(uint code, char16_t *out)
+{
+    if (code < 0x10000) {
+        *out++ = code;
+    } else {
+        code -= 0x10000;
+        *out++ = 0xd800 + (code >> 10);
+        *out++ = 0xdc00 + (code & 0x3ff);
+    }
+    return out;
+}
+
+}
+
+namespace VUnicode {
+
+uint Utf8Length(const char16_t *utf16, uint size)
+{
+    const char16_t *p = utf16;
+    const char16_t *end = utf16 + size;
+    uint length = 0;
+    while (p < end) {
+        if (end - p >= 8) {
+            const int block = Utf8Length8(p);
+            if (block >= 0) {
+                length += block;
+                p += 8;
+                continue;
+            }
+        }
+
+        const uint unit = *p;
+        if (unit < 0x80) {
+            length += 1;
+            p++;
+        } else if (unit < 0x800) {
+            length += 2;
+            p++;
+        } else {
+            // A replacement character takes three bytes as well
+            const uint code = DecodeUtf16(p, end);
+            length += code != Invalid && code > 0xffff ? 4 : 3;
+        }
+    }
+    return length;
+}
+
+uint Utf16Length(const char *utf8, uint size)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(utf8);
+    const uchar *end = p + size;
+    uint length = 0;
+    while (p < end) {
+        if (*p < 0x80) {
+            // Only look for a run of ASCII where one may start
+            if (end - p >= 16 && IsAscii16(p)) {
+                length += 16;
+                p += 16;
+            } else {
+                length++;
+                p++;
+            }
+        } else {
+            const uint code = DecodeUtf8(p, end);
+            length += code != Invalid && code > 0xffff ? 2 : 1;
+        }
+    }
+    return length;
+}
+
+uint ToUtf8(const char16_t *utf16, uint size, char *utf8)
+{
+    const char16_t *p = utf16;
+    const char16_t *end = utf16 + size;
+    uchar *out = reinterpret_cast<uchar *>(utf8);
+    while (p < end) {
+        if (*p < 0x80) {
+            if (end - p >= 16 && IsAscii16(p)) {
+                Narrow16(p, out);
+                p += 16;
+                out += 16;
+            } else {
+                *out++ = *p++;
+            }
+        } else {
+            const uint code = DecodeUtf16(p, end);
+            out = EncodeUtf8(code == Invalid ? ReplacementCharacter : code, out);
+        }
+    }
+    return out - reinterpret_cast<uchar *>(utf8);
+}
+
+uint ToUtf16(const char *utf8, uint size, char16_t *utf16)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(utf8);
+    const uchar *end = p + size;
+    char16_t *out = utf16;
+    while (p < end) {
+        if (*p < 0x80) {
+            if (end - p >= 16 && IsAscii16(p)) {
+                Widen16(p, out);
+                p += 16;
+                out += 16;
+            } else {
+                *out++ = *p++;
+            }
+        } else {
+            const uint code = DecodeUtf8(p, end);
+            out = EncodeUtf16(code == Invalid ? ReplacementCharacter : code, out);
+        }
+    }
+    return out - utf16;
+}
+
+bool IsValidUtf8(const char *utf8, uint size)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(utf8);
+    const uchar *end = p + size;
+    while (p < end) {
+        if (*p < 0x80) {
+            p += end - p >= 16 && IsAscii16(p) ? 16 : 1;
+        } else if (DecodeUtf8(p, end) == Invalid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+NV_NAMESPACE_END
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "vglobal.h"
+
+NV_NAMESPACE_BEGIN
+
+// Transcoding between UTF-8 and UTF-16. Runs of ASCII are handled 16 bytes at
+// a time with SSE2 or NEON, falling back to plain C++ elsewhere.
+//
+// Malformed input is never rejected. Every invalid UTF-8 subsequence and
+// every unpaired surrogate becomes one U+FFFD, as the Unicode standard
+// recommends, so the lengths below are exact for any input.
+namespace VUnicode {
+
+const char16_t ReplacementCharacter = 0xfffd;
+
+// The number of units the other encoding takes, so the output is allocated
+// once
+uint Utf8Length(const char16_t *utf16, uint size);
+uint Utf16Length(const char *utf8, uint size);
+
+// Write exactly as many units as the functions above count and return it
+uint ToUtf8(const char16_t *utf16, uint size, char *utf8);
+uint ToUtf16(const char *utf8, uint size, char16_t *utf16);
+
+bool IsValidUtf8(const char *utf8, uint size);
+
+}
+
+NV_NAMESPACE_END
@@ -1,31 +1,54 @@
 #include "VVariant.h"
 
 #include "VLog.h"
+#include "VMessagePack.h"
+#include "VObjectPool.h"
 
+#include <limits.h>
+#include <new>
 #include <sstream>
+#include <string.h>
 
 NV_NAMESPACE_BEGIN
 
+namespace {
+
+// Arrays are the one payload still kept outside the variant. The pool is never
+// destroyed, as static variants may hold arrays until the process exits.
+VObjectPool<VVariantArray> &ArrayPool()
+{
+    static VObjectPool<VVariantArray> *pool = new VObjectPool<VVariantArray>("VVariantArray");
+    return *pool;
+}
+
+}
+
+// Scalars are copied as 8 bytes, so the ones narrower than that clear the
+// rest first
 VVariant::VVariant()
     : m_type(Null)
 {
+    m_value.ubdecimal = 0;
 }
 
 VVariant::VVariant(bool value)
     : m_type(Boolean)
 {
+    m_value.ubdecimal = 0;
     m_value.boolean = value;
 }
 
 VVariant::VVariant(int value)
     : m_type(Int)
 {
+    m_value.ubdecimal = 0;
     m_value.decimal = value;
 }
 
 VVariant::VVariant(uint value)
     : m_type(UInt)
 {
+    m_value.ubdecimal = 0;
     m_value.udecimal = value;
 }
 
@@ -44,6 +67,7 @@ VVariant::VVariant(ulonglong value)
 VVariant::VVariant(float value)
     : m_type(Float)
 {
+    m_value.ubdecimal = 0;
     m_value.real = value;
 }
 
@@ -69,99 +93,72 @@ VVariant::VVariant(const void *pointer)
 VVariant::VVariant(const char *str)
     : m_type(String)
 {
-    m_value.str = new VString(str);
+    const uint size = str ? strlen(str) : 0;
+    if (size <= ShortStringSize) {
+        // Widened like VString does
+        m_shortString = true;
+        m_shortSize = size;
+        for (uint i = 0; i < size; i++) {
+            m_value.units[i] = str[i];
+        }
+    } else {
+        m_shortString = false;
+        new (m_value.data) VString(str);
+    }
 }
 
 VVariant::VVariant(const VString &str)
     : m_type(String)
 {
-    m_value.str = new VString(str);
+    setString(str.data(), str.size());
+    if (!m_shortString) {
+        new (m_value.data) VString(str);
+    }
 }
 
 VVariant::VVariant(VString &&str)
     : m_type(String)
 {
-    m_value.str = new VString(std::move(str));
+    setString(str.data(), str.size());
+    if (!m_shortString) {
+        new (m_value.data) VString(std::move(str));
+    }
 }
 
 VVariant::VVariant(const VVariantArray &array)
     : m_type(Array)
 {
-    m_value.array = new VVariantArray(array);
+    m_value.array = ArrayPool().create(array);
 }
 
 VVariant::VVariant(VVariantArray &&array)
     : m_type(Array)
 {
-    m_value.array = new VVariantArray(std::move(array));
+    m_value.array = ArrayPool().create(std::move(array));
 }
 
 VVariant::VVariant(const VVariantMap &map)
     : m_type(Map)
 {
-    m_value.map = new VVariantMap(map);
+    new (m_value.data) VVariantMap(map);
 }
 
 VVariant::VVariant(VVariantMap &&map)
     : m_type(Map)
 {
-    m_value.map = new VVariantMap(std::move(map));
+    new (m_value.data) VVariantMap(std::move(map));
 }
 
 VVariant::VVariant(const Function &function)
     : m_type(Closure)
 {
-    m_value.function = new Function(function);
+    new (m_value.data) Function(function);
 }
 
 VVariant::VVariant(VVariant::Function &&function)
     : m_type(Closure)
 {
-    m_value.function = new Function(std::move(function));
-}
-
-VVariant::VVariant(const VVariant &var)
-    : m_type(var.m_type)
-{
-    switch (m_type) {
-    case Null:
-    case Boolean:
-    case Int:
-    case UInt:
-    case LongLong:
-    case ULongLong:
-    case Float:
-    case Double:
-    case Pointer:
-        m_value = var.m_value;
-        break;
-    case String:
-        m_value.str = new VString(*(var.m_value.str));
-        break;
-    case Array:
-        m_value.array = new VVariantArray(*(var.m_value.array));
-        break;
-    case Map:
-        m_value.map = new VVariantMap(*(var.m_value.map));
-        break;
-    case Closure:
-        m_value.function = new Function(*(var.m_value.function));
-        break;
-    default:
-        vAssert("VVariant Does not support such a type.");
-    }
-}
-
-VVariant::VVariant(VVariant &&var)
-    : m_type(var.m_type)
-    , m_value(var.m_value)
-{
-    var.m_type = Null;
-}
-
-VVariant::~VVariant()
-{
-    release();
+    new (m_value.data) Function(std::move(function));
 }
 
 bool VVariant::toBool() const
@@ -186,11 +183,11 @@ bool VVariant::toBool() const
     case Pointer:
         return m_value.pointer;
     case String:
-        return !m_value.str->isEmpty();
+        return size() > 0;
     case Array:
         return !m_value.array->isEmpty();
     case Map:
-        return !m_value.map->isEmpty();
+        return !object<VVariantMap>().isEmpty();
     default:
         vAssert(false)
         return false;
@@ -217,11 +214,11 @@ int VVariant::toInt() const
     case Double:
         return static_cast<int>(m_value.dreal);
     case String:
-        return m_value.str->toInt();
+        return toString().toInt();
     case Array:
         return m_value.array->length();
     case Map:
-        return static_cast<int>(m_value.map->size());
+        return static_cast<int>(object<VVariantMap>().size());
     default:
         vWarn("VVariant cast an unexpected type to int");
         return 0;
@@ -248,11 +245,11 @@ uint VVariant::toUInt() const
     case Double:
         return static_cast<uint>(m_value.dreal);
     case String:
-        return m_value.str->toInt();
+        return toString().toInt();
     case Array:
         return m_value.array->size();
     case Map:
-        return m_value.map->size();
+        return object<VVariantMap>().size();
     default:
         vWarn("VVariant cast an unexpected type to uint");
         return 0;
@@ -315,11 +312,22 @@ void *VVariant::toPointer() const
     return m_value.pointer;
 }
 
-const VString &VVariant::toString() const
+VString VVariant::toString() const
 {
     vAssert(m_type == String);
-    static VString EmptyString;
-    return m_type == String ? *(m_value.str) : EmptyString;
+    if (m_type != String) {
+        return VString();
+    }
+    return m_shortString ? VString(m_value.units, m_shortSize) : object<VString>();
+}
+
+VStringView VVariant::toStringView() const
+{
+    vAssert(m_type == String);
+    if (m_type != String) {
+        return VStringView();
+    }
+    return m_shortString ? VStringView(m_value.units, m_shortSize) : VStringView(object<VString>());
 }
 
 const VVariantArray &VVariant::toArray() const
@@ -333,7 +341,7 @@ const VVariantMap &VVariant::toMap() const
 {
     vAssert(m_type == Map);
     static VVariantMap EmptyMap;
-    return m_type == Map ? *(m_value.map) : EmptyMap;
+    return m_type == Map ? object<VVariantMap>() : EmptyMap;
 }
 
 const VVariant &VVariant::at(uint index) const
@@ -345,20 +353,12 @@ const VVariant &VVariant::at(uint index) const
 const VVariant &VVariant::value(const VString &key) const
 {
     vAssert(m_type == Map);
-    return m_value.map->value(key);
+    return object<VVariantMap>().value(key);
 }
 
 int VVariant::length() const
 {
-    if (m_type == Array) {
-        return m_value.array->length();
-    } else if (m_type == Map) {
-        return (int) m_value.map->size();
-    } else if (m_type == String) {
-        return m_value.str->length();
-    }
-    vAssert(false);
-    return 0;
+    return (int) size();
 }
 
 uint VVariant::size() const
@@ -366,9 +366,9 @@ uint VVariant::size() const
     if (m_type == Array) {
         return m_value.array->size();
     } else if (m_type == Map) {
-        return m_value.map->size();
+        return object<VVariantMap>().size();
     } else if (m_type == String) {
-        return m_value.str->size();
+        return m_shortString ? m_shortSize : object<VString>().size();
     }
     vAssert(false);
     return 0;
@@ -377,70 +377,244 @@ uint VVariant::size() const
 void VVariant::execute() const
 {
     vAssert(isClosure());
-    (*(m_value.function))();
+    object<Function>()();
 }
 
-void VVariant::release()
+VByteArray VVariant::toBinary() const
+{
+    VMessagePackWriter writer;
+    writeBinary(writer);
+    return writer.data();
+}
+
+VVariant VVariant::FromBinary(const VByteArray &data)
+{
+    return FromBinary(data.data(), data.size());
+}
+
+VVariant VVariant::FromBinary(const char *data, uint size)
+{
+    VMessagePackReader reader(data, size);
+    VVariant value;
+    if (!value.readBinary(reader)) {
+        // The reader accepts keys of any type, which maps here can't have
+        if (reader.error()) {
+            vError("VVariant: " << reader.error() << " at offset " << reader.errorOffset());
+        } else {
+            vError("VVariant: Expect string key before offset " << reader.offset());
+        }
+        return VVariant();
+    }
+    return value;
+}
+
+void VVariant::writeBinary(VMessagePackWriter &writer) const
 {
     switch (m_type) {
+    case Boolean:
+        writer.writeBool(m_value.boolean);
+        break;
+    case Int:
+        writer.writeInt(m_value.decimal);
+        break;
+    case UInt:
+        writer.writeUInt(m_value.udecimal);
+        break;
+    case LongLong:
+        writer.writeInt(m_value.bdecimal);
+        break;
+    case ULongLong:
+        writer.writeUInt(m_value.ubdecimal);
+        break;
+    case Float:
+        writer.writeFloat(m_value.real);
+        break;
+    case Double:
+        writer.writeDouble(m_value.dreal);
+        break;
     case String:
-        delete m_value.str;
+        writer.writeString(VByteArrayView(toStringView().toUtf8()));
         break;
     case Array:
-        delete m_value.array;
+        writer.startArray(m_value.array->size());
+        for (const VVariant &element : *m_value.array) {
+            element.writeBinary(writer);
+        }
         break;
     case Map:
-        delete m_value.map;
-        break;
-    case Closure:
-        delete m_value.function;
+        writer.startMap(object<VVariantMap>().size());
+        for (const VVariantMap::value_type &pair : object<VVariantMap>()) {
+            writer.writeString(pair.first);
+            pair.second.writeBinary(writer);
+        }
         break;
     default:
+        writer.writeNil();
         break;
     }
 }
 
-VVariant &VVariant::operator=(const VVariant &var)
+bool VVariant::readBinary(VMessagePackReader &reader)
+{
+    if (!reader.next()) {
+        return false;
+    }
+
+    switch (reader.type()) {
+    case VMessagePackReader::Nil:
+        *this = VVariant();
+        return true;
+    case VMessagePackReader::Boolean:
+        *this = VVariant(reader.toBool());
+        return true;
+    case VMessagePackReader::Int: {
+        const long long value = reader.toLongLong();
+        *this = value >= INT_MIN && value <= INT_MAX ? VVariant((int) value) : VVariant(value);
+        return true;
+    }
+    case VMessagePackReader::UInt: {
+        const ulonglong value = reader.toULongLong();
+        *this = value <= UINT_MAX ? VVariant((uint) value) : VVariant(value);
+        return true;
+    }
+    case VMessagePackReader::Float:
+        *this = VVariant((float) reader.toDouble());
+        return true;
+    case VMessagePackReader::Double:
+        *this = VVariant(reader.toDouble());
+        return true;
+    case VMessagePackReader::String: {
+        const VByteArrayView str = reader.toString();
+        *this = VVariant(VString::fromUtf8(str.data(), str.size()));
+        return true;
+    }
+    case VMessagePackReader::Array: {
+        const uint size = reader.size();
+        VVariantArray array;
+        array.reserve(size);
+        for (uint i = 0; i < size; i++) {
+            VVariant element;
+            if (!element.readBinary(reader)) {
+                return false;
+            }
+            array.append(std::move(element));
+        }
+        *this = VVariant(std::move(array));
+        return true;
+    }
+    case VMessagePackReader::Map: {
+        const uint size = reader.size();
+        VVariantMap map;
+        map.reserve(size);
+        for (uint i = 0; i < size; i++) {
+            if (!reader.next() || reader.type() != VMessagePackReader::String) {
+                return false;
+            }
+            const VByteArrayView key = reader.toString();
+            VVariant element;
+            if (!element.readBinary(reader)) {
+                return false;
+            }
+            map.insert(VString::fromUtf8(key.data(), key.size()), std::move(element));
+        }
+        *this = VVariant(std::move(map));
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void VVariant::setString(const char16_t *units, uint size)
 {
-    release();
-    m_type = var.m_type;
+    m_shortString = size <= ShortStringSize;
+    if (m_shortString) {
+        m_shortSize = size;
+        memcpy(m_value.units, units, size * sizeof(char16_t));
+    }
+}
+
+void VVariant::copy(const VVariant &source)
+{
+    static_assert(sizeof(VString) <= InlineSize && sizeof(VVariantMap) <= InlineSize && sizeof(Function) <= InlineSize,
+                  "VVariant values must fit in its inline buffer");
+
+    m_type = source.m_type;
     switch (m_type) {
-    case Null:
-    case Boolean:
-    case Int:
-    case UInt:
-    case LongLong:
-    case ULongLong:
-    case Float:
-    case Double:
-    case Pointer:
-        m_value = var.m_value;
-        break;
     case String:
-        m_value.str = new VString(*(var.m_value.str));
+        m_shortString = source.m_shortString;
+        if (m_shortString) {
+            m_shortSize = source.m_shortSize;
+            m_value = source.m_value;
+        } else {
+            new (m_value.data) VString(source.object<VString>());
+        }
         break;
     case Array:
-        m_value.array = new VVariantArray(*(var.m_value.array));
+        m_value.array = ArrayPool().create(*(source.m_value.array));
         break;
     case Map:
-        m_value.map = new VVariantMap(*(var.m_value.map));
+        new (m_value.data) VVariantMap(source.object<VVariantMap>());
         break;
     case Closure:
-        m_value.function = new Function(*(var.m_value.function));
+        new (m_value.data) Function(source.object<Function>());
         break;
     default:
-        vAssert("VVariant Does not support such a type.");
+        m_value = source.m_value;
+        break;
     }
-    return *this;
 }
 
-VVariant &VVariant::operator=(VVariant &&source)
+// Moving never allocates: short strings and scalars are copied, the rest
+// hand over their buffers
+void VVariant::move(VVariant &source)
 {
-    release();
     m_type = source.m_type;
-    m_value = source.m_value;
+    switch (m_type) {
+    case String:
+        m_shortString = source.m_shortString;
+        if (m_shortString) {
+            m_shortSize = source.m_shortSize;
+            m_value = source.m_value;
+        } else {
+            new (m_value.data) VString(std::move(source.object<VString>()));
+        }
+        break;
+    case Map:
+        new (m_value.data) VVariantMap(std::move(source.object<VVariantMap>()));
+        break;
+    case Closure:
+        new (m_value.data) Function(std::move(source.object<Function>()));
+        break;
+    default:
+        m_value = source.m_value;
+        source.m_type = Null;
+        return;
+    }
+    source.release();
     source.m_type = Null;
-    return *this;
+}
+
+void VVariant::release()
+{
+    switch (m_type) {
+    case String:
+        if (!m_shortString) {
+            object<VString>().~VString();
+        }
+        break;
+    case Array:
+        ArrayPool().destroy(m_value.array);
+        break;
+    case Map:
+        object<VVariantMap>().~VVariantMap();
+        break;
+    case Closure:
+        object<Function>().~Function();
+        break;
+    default:
+        break;
+    }
 }
 
 NV_NAMESPACE_END
@@ -1,16 +1,22 @@
 #pragma once
 
 #include "VString.h"
+#include "VStringView.h"
 #include "VArray.h"
-#include "VMap.h"
+#include "VSmallArray.h"
+#include "VFlatMap.h"
 
 #include <functional>
+#include <string.h>
 
 NV_NAMESPACE_BEGIN
 
 class VVariant;
-typedef VArray<VVariant> VVariantArray;
-typedef VMap<VString, VVariant> VVariantMap;
+class VMessagePackWriter;
+class VMessagePackReader;
+// Event payloads rarely hold more than a few values
+typedef VSmallArray<VVariant, 4> VVariantArray;
+typedef VFlatMap<VString, VVariant> VVariantMap;
 
 class VVariant
 {
@@ -63,10 +69,34 @@ public:
     VVariant(const Function &function);
     VVariant(Function &&function);
 
-    VVariant(const VVariant &var);
-    VVariant(VVariant &&var);
-
-    ~VVariant();
+    // Scalars are copied inline, the other types own memory
+    VVariant(const VVariant &var)
+        : m_type(var.m_type)
+    {
+        if (m_type < String) {
+            memcpy(&m_value, &var.m_value, sizeof(ulonglong));
+        } else {
+            copy(var);
+        }
+    }
+
+    VVariant(VVariant &&var)
+        : m_type(var.m_type)
+    {
+        if (m_type < String) {
+            memcpy(&m_value, &var.m_value, sizeof(ulonglong));
+            var.m_type = Null;
+        } else {
+            move(var);
+        }
+    }
+
+    ~VVariant()
+    {
+        if (m_type >= String) {
+            release();
+        }
+    }
 
     Type type() const { return m_type; }
 
@@ -91,7 +121,9 @@ public:
     double toDouble() const;
     void *toPointer() const;
 
-    const VString &toString() const;
+    VString toString() const;
+    // Points into the variant, so short strings are read without allocating
+    VStringView toStringView() const;
 
     const VVariantArray &toArray() const;
     const VVariantMap &toMap() const;
@@ -101,7 +133,7 @@ public:
     const VVariant &at(uint index) const;
     const VVariant &operator[](uint index) const { return at(index); }
 
-    VVariant &operator[](const VString &key) { return (*(m_value.map))[key]; }
+    VVariant &operator[](const VString &key) { return object<VVariantMap>()[key]; }
 
     const VVariant &value(const VString &key) const;
     const VVariant &operator[](const VString &key) const { return value(key); }
@@ -112,13 +144,63 @@ public:
     void execute() const;
     void operator()() const { execute(); }
 
-    VVariant &operator=(const VVariant &source);
-    VVariant &operator=(VVariant &&source);
+    // MessagePack, where integers read back as the narrowest of Int or
+    // LongLong, UInt or ULongLong holding them. Pointers and closures can't
+    // be stored and are written as null.
+    VByteArray toBinary() const;
+    static VVariant FromBinary(const VByteArray &data);
+    static VVariant FromBinary(const char *data, uint size);
+
+    VVariant &operator=(const VVariant &source)
+    {
+        if (m_type < String && source.m_type < String) {
+            m_type = source.m_type;
+            memcpy(&m_value, &source.m_value, sizeof(ulonglong));
+        } else if (this != &source) {
+            release();
+            copy(source);
+        }
+        return *this;
+    }
+
+    VVariant &operator=(VVariant &&source)
+    {
+        if (m_type < String && source.m_type < String) {
+            m_type = source.m_type;
+            memcpy(&m_value, &source.m_value, sizeof(ulonglong));
+            source.m_type = Null;
+        } else if (this != &source) {
+            release();
+            move(source);
+        }
+        return *this;
+    }
 
 private:
+    // Strings of up to ShortStringSize units are kept as units, longer ones,
+    // maps and closures are built in place. Arrays are made of variants, so
+    // they can't fit and are boxed.
+    enum
+    {
+        InlineSize = 32,
+        ShortStringSize = InlineSize / sizeof(char16_t)
+    };
+
+    template<class T> T &object() { return *reinterpret_cast<T *>(m_value.data); }
+    template<class T> const T &object() const { return *reinterpret_cast<const T *>(m_value.data); }
+
+    void setString(const char16_t *units, uint size);
+    void copy(const VVariant &source);
+    void move(VVariant &source);
     void release();
 
+    void writeBinary(VMessagePackWriter &writer) const;
+    bool readBinary(VMessagePackReader &reader);
+
     VVariant::Type m_type;
+    // Whether a String is in m_value.units, and how many of them
+    bool m_shortString;
+    uchar m_shortSize;
 
     union Value
     {
@@ -130,10 +212,9 @@ private:
         float real;
         double dreal;
         void *pointer;
-        VString *str;
         VVariantArray *array;
-        VVariantMap *map;
-        Function *function;
+        char16_t units[ShortStringSize];
+        char data[InlineSize];
     };
     Value m_value;
 };
@@ -19,23 +19,23 @@ VDir::VDir(const VPath &path)
 
 bool VDir::reach()
 {
-    return chdir(m_path.toUtf8().data()) == 0;
+    return chdir(VNativePath(m_path)) == 0;
 }
 
 bool VDir::exists() const
 {
-    return access(m_path.toUtf8().data(), F_OK) == 0;
+    return access(VNativePath(m_path), F_OK) == 0;
 }
 
 bool VDir::contains(const VString &path)
 {
     VString fullPath = m_path + path;
-    return access(fullPath.toUtf8().data(), F_OK) == 0;
+    return access(VNativePath(fullPath), F_OK) == 0;
 }
 
 void VDir::makeDir()
 {
-    char *path = strdup(m_path.toUtf8().data());
+    char *path = strdup(VNativePath(m_path));
     int mode = S_IRUSR | S_IWUSR;
 
     for (char *currentChar = path + 1; *currentChar; ++currentChar) {
@@ -56,18 +56,18 @@ void VDir::makeDir()
 
 bool VDir::isReadable() const
 {
-    return access(m_path.toUtf8().data(), R_OK) == 0;
+    return access(VNativePath(m_path), R_OK) == 0;
 }
 
 bool VDir::isWritable() const
 {
-    return access(m_path.toUtf8().data(), W_OK) == 0;
+    return access(VNativePath(m_path), W_OK) == 0;
 }
 
 VArray<VString> VDir::entryList() const
 {
     VArray<VString> entries;
-    DIR *dir = opendir(m_path.toUtf8().data());
+    DIR *dir = opendir(VNativePath(m_path));
     if (dir != NULL) {
         struct dirent *entry;
         while ((entry = readdir(dir)) != NULL) {
@@ -1,5 +1,6 @@
 #include "VFile.h"
 #include "VLog.h"
+#include "VPath.h"
 
 #include <fstream>
 
@@ -62,7 +63,7 @@ bool VFile::open(VIODevice::OpenMode mode)
     if (mode & Truncate) {
         std_mode |= std::ios_base::trunc;
     }
-    d->data.open(d->path.toUtf8(), std_mode);
+    d->data.open(VNativePath(d->path), std_mode);
 
     return d->data.is_open() && VIODevice::open(mode);
 }
@@ -77,19 +78,34 @@ bool VFile::exists() const
     return Exists(d->path);
 }
 
-bool VFile::Exists(const VString &path)
+bool VFile::Exists(VStringView path)
 {
-    return access(path.toUtf8().data(), F_OK) == 0;
+    return access(VNativePath(path), F_OK) == 0;
 }
 
-bool VFile::IsReadable(const VString &path)
+bool VFile::Exists(VByteArrayView path)
 {
-    return access(path.toUtf8().data(), R_OK) == 0;
+    return access(VNativePath(path), F_OK) == 0;
 }
 
-bool VFile::IsWritable(const VString &path)
+bool VFile::IsReadable(VStringView path)
 {
-    return access(path.toUtf8().data(), W_OK) == 0;
+    return access(VNativePath(path), R_OK) == 0;
+}
+
+bool VFile::IsReadable(VByteArrayView path)
+{
+    return access(VNativePath(path), R_OK) == 0;
+}
+
+bool VFile::IsWritable(VStringView path)
+{
+    return access(VNativePath(path), W_OK) == 0;
+}
+
+bool VFile::IsWritable(VByteArrayView path)
+{
+    return access(VNativePath(path), W_OK) == 0;
 }
 
 vint64 VFile::readData(char *data, vint64 maxSize)
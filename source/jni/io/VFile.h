@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VIODevice.h"
+#include "VStringView.h"
 
 NV_NAMESPACE_BEGIN
 
@@ -18,10 +19,13 @@ public:
     void close() override;
 
     bool exists() const;
-    static bool Exists(const VString &path);
+    static bool Exists(VStringView path);
+    static bool Exists(VByteArrayView path);
 
-    static bool IsReadable(const VString &path);
-    static bool IsWritable(const VString &path);
+    static bool IsReadable(VStringView path);
+    static bool IsReadable(VByteArrayView path);
+    static bool IsWritable(VStringView path);
+    static bool IsWritable(VByteArrayView path);
 
 protected:
     vint64 readData(char *data, vint64 maxSize) override;
@@ -0,0 +1,254 @@
+#include "VJsonWriter.h"
+#include "VJson.h"
+
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+
+NV_NAMESPACE_BEGIN
+
+namespace {
+
+const uint BufferSize = 4096;
+
+}
+
+struct VJsonWriter::Private
+{
+    VIODevice *device;
+    VByteArray buffer;
+    // Whether a comma goes before the next key or value
+    bool separate;
+    bool failed;
+
+    Private(VIODevice *device)
+        : device(device)
+        , separate(false)
+        , failed(false)
+    {
+        buffer.reserve(BufferSize);
+    }
+
+    void put(char ch)
+    {
+        buffer += ch;
+    }
+
+    void put(const char *data, uint size)
+    {
+        buffer.append(data, size);
+    }
+
+    void startItem()
+    {
+        if (separate) {
+            put(',');
+            separate = false;
+        }
+    }
+
+    void endItem()
+    {
+        separate = true;
+        if (buffer.size() >= BufferSize) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (!buffer.empty()) {
+            if (device->write(buffer.data(), buffer.size()) != (vint64) buffer.size()) {
+                failed = true;
+            }
+            buffer.clear();
+        }
+    }
+
+    void putString(VByteArrayView str)
+    {
+        put('"');
+        const char *start = str.begin();
+        for (const char *i = start; i != str.end(); i++) {
+            const uchar ch = *i;
+            if (ch != '"' && ch != '\\' && ch >= 0x20) {
+                continue;
+            }
+            put(start, i - start);
+            start = i + 1;
+            put('\\');
+            switch (ch) {
+            case '"':
+            case '\\':
+                put(ch);
+                break;
+            case '\n':
+                put('n');
+                break;
+            case '\t':
+                put('t');
+                break;
+            case '\r':
+                put('r');
+                break;
+            case '\b':
+                put('b');
+                break;
+            case '\f':
+                put('f');
+                break;
+            default: {
+                char escape[6];
+                snprintf(escape, sizeof(escape), "u%04x", ch);
+                put(escape, 5);
+                break;
+            }
+            }
+        }
+        put(start, str.end() - start);
+        put('"');
+    }
+
+    void putNumber(double value)
+    {
+        if (std::isnan(value) || std::isinf(value)) {
+            put("null", 4);
+            return;
+        }
+
+        // 15 digits are enough for most values, 17 for all of them
+        char str[32];
+        int length = snprintf(str, sizeof(str), "%.15g", value);
+        if (strtod(str, nullptr) != value) {
+            length = snprintf(str, sizeof(str), "%.17g", value);
+        }
+        put(str, length);
+    }
+};
+
+VJsonWriter::VJsonWriter(VIODevice *device)
+    : d(new Private(device))
+{
+}
+
+VJsonWriter::~VJsonWriter()
+{
+    d->flush();
+    delete d;
+}
+
+void VJsonWriter::startObject()
+{
+    d->startItem();
+    d->put('{');
+}
+
+void VJsonWriter::endObject()
+{
+    d->put('}');
+    d->endItem();
+}
+
+void VJsonWriter::startArray()
+{
+    d->startItem();
+    d->put('[');
+}
+
+void VJsonWriter::endArray()
+{
+    d->put(']');
+    d->endItem();
+}
+
+void VJsonWriter::writeKey(VByteArrayView name)
+{
+    d->startItem();
+    d->putString(name);
+    d->put(':');
+}
+
+void VJsonWriter::writeKey(const VString &name)
+{
+    writeKey(VByteArrayView(name.toUtf8()));
+}
+
+void VJsonWriter::writeNull()
+{
+    d->startItem();
+    d->put("null", 4);
+    d->endItem();
+}
+
+void VJsonWriter::writeBool(bool value)
+{
+    d->startItem();
+    if (value) {
+        d->put("true", 4);
+    } else {
+        d->put("false", 5);
+    }
+    d->endItem();
+}
+
+void VJsonWriter::writeNumber(double value)
+{
+    d->startItem();
+    d->putNumber(value);
+    d->endItem();
+}
+
+void VJsonWriter::writeString(VByteArrayView value)
+{
+    d->startItem();
+    d->putString(value);
+    d->endItem();
+}
+
+void VJsonWriter::writeString(const VString &value)
+{
+    writeString(VByteArrayView(value.toUtf8()));
+}
+
+void VJsonWriter::write(const VJson &value)
+{
+    switch (value.type()) {
+    case VJson::Null:
+        writeNull();
+        break;
+    case VJson::Boolean:
+        writeBool(value.toBool());
+        break;
+    case VJson::Number:
+        writeNumber(value.toDouble());
+        break;
+    case VJson::String:
+        writeString(value.toString());
+        break;
+    case VJson::Array:
+        startArray();
+        for (const VJson &element : value.toArray()) {
+            write(element);
+        }
+        endArray();
+        break;
+    case VJson::Object:
+        startObject();
+        for (const VJsonObject::value_type &pair : value.toObject()) {
+            writeKey(pair.first);
+            write(pair.second);
+        }
+        endObject();
+        break;
+    }
+}
+
+bool VJsonWriter::flush()
+{
+    d->flush();
+    const bool succeeded = !d->failed;
+    d->failed = false;
+    return succeeded;
+}
+
+NV_NAMESPACE_END
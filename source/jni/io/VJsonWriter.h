@@ -0,0 +1,50 @@
+#pragma once
+
+#include "VIODevice.h"
+#include "VStringView.h"
+
+NV_NAMESPACE_BEGIN
+
+class VJson;
+
+// Writes compact JSON to a device as it is produced, a few kilobytes at a
+// time, so no tree has to be built first. Keys go before each value in an
+// object, and every start needs its end.
+//
+// Strings escape ", \ and the control characters, as strict JSON requires.
+class VJsonWriter
+{
+public:
+    VJsonWriter(VIODevice *device);
+    // Flushes what is left
+    ~VJsonWriter();
+
+    void startObject();
+    void endObject();
+    void startArray();
+    void endArray();
+
+    void writeKey(const char *name) { writeKey(VByteArrayView(name)); }
+    void writeKey(VByteArrayView name);
+    void writeKey(const VString &name);
+
+    void writeNull();
+    void writeBool(bool value);
+    // Shortest form that reads back the same, NaN and infinity as null
+    void writeNumber(double value);
+    void writeString(const char *value) { writeString(VByteArrayView(value)); }
+    void writeString(VByteArrayView value);
+    void writeString(const VString &value);
+
+    // A whole tree, where one is at hand
+    void write(const VJson &value);
+
+    // Returns false if the device did not take everything
+    bool flush();
+
+private:
+    NV_DECLARE_PRIVATE
+    NV_DISABLE_COPY(VJsonWriter)
+};
+
+NV_NAMESPACE_END
@@ -47,7 +47,13 @@ bool VResource::exists() const
     return d->exists;
 }
 
-bool VResource::Exist(const VString &path)
+bool VResource::Exist(VStringView path)
+{
+    const VZipFile &zip = vApp->apkFile();
+    return zip.contains(path);
+}
+
+bool VResource::Exist(VByteArrayView path)
 {
     const VZipFile &zip = vApp->apkFile();
     return zip.contains(path);
@@ -58,7 +64,7 @@ const VPath &VResource::path() const
     return d->path;
 }
 
-VByteArray VResource::data() const
+const VByteArray &VResource::data() const
 {
     return d->data;
 }
@@ -13,10 +13,12 @@ public:
     ~VResource();
 
     bool exists() const;
-    static bool Exist(const VString &path);
+    static bool Exist(VStringView path);
+    static bool Exist(VByteArrayView path);
 
     const VPath &path() const;
-    VByteArray data() const;
+    // Shared with the resource, not copied
+    const VByteArray &data() const;
 
     uint size() const;
     int length() const;
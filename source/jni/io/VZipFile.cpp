@@ -1,5 +1,6 @@
 #include "VZipFile.h"
 #include "VString.h"
+#include "VStringHash.h"
 #include "VLog.h"
 
 #include <3rdparty/minizip/unzip.h>
@@ -9,6 +10,149 @@ NV_NAMESPACE_BEGIN
 struct VZipFile::Private
 {
     unzFile handle;
+
+    // Where every entry is, by its case-insensitive name. unzLocateFile()
+    // would read through the central directory on every lookup.
+    VStringCaseHash<unz_file_pos> entries;
+
+    void indexEntries()
+    {
+        entries.clear();
+        char name[512];
+        for (int ret = unzGoToFirstFile(handle); ret == UNZ_OK; ret = unzGoToNextFile(handle)) {
+            unz_file_pos pos;
+            if (unzGetCurrentFileInfo(handle, nullptr, name, sizeof(name), nullptr, 0, nullptr, 0) == UNZ_OK
+                    && unzGetFilePos(handle, &pos) == UNZ_OK) {
+                // The first one wins, as with unzLocateFile()
+                const VString key = VString::fromUtf8(name);
+                if (!entries.contains(key)) {
+                    entries.insert(key, pos);
+                }
+            }
+        }
+    }
+
+    template<class Name>
+    bool locate(const Name &filePath)
+    {
+        if (handle == nullptr) {
+            return false;
+        }
+        VStringCaseHash<unz_file_pos>::Iterator entry = entries.find(filePath);
+        return entry != entries.end() && unzGoToFilePos(handle, &entry->second) == UNZ_OK;
+    }
+
+    template<class Name>
+    bool contains(const Name &filePath)
+    {
+        if (!locate(filePath)) {
+            vInfo("File '" << filePath << "' not found in apk!");
+            return false;
+        }
+
+        const int openRet = unzOpenCurrentFile(handle);
+        if (openRet != UNZ_OK) {
+            vWarn("Error opening file '" << filePath << "' from apk!");
+            return false;
+        }
+
+        unzCloseCurrentFile(handle);
+        return true;
+    }
+
+    // Opens the entry for readEntry() and tells its uncompressed size
+    template<class Name>
+    bool openEntry(const Name &filePath, uint &size)
+    {
+        if (handle == nullptr) {
+            vError("VZipFile is not open");
+            return false;
+        }
+
+        if (!locate(filePath)) {
+            vWarn("File '" << filePath << "' not found in apk!");
+            return false;
+        }
+
+        unz_file_info info;
+        const int getRet = unzGetCurrentFileInfo(handle, &info, NULL, 0, NULL, 0, NULL, 0);
+        if (getRet != UNZ_OK) {
+            vWarn("File info error reading '" << filePath << "' from apk!");
+            return false;
+        }
+        const int openRet = unzOpenCurrentFile(handle);
+        if (openRet != UNZ_OK) {
+            vWarn("Error opening file '" << filePath << "' from apk!");
+            return false;
+        }
+
+        size = info.uncompressed_size;
+        return true;
+    }
+
+    template<class Name>
+    bool readEntry(const Name &filePath, void *buffer, uint size)
+    {
+        const int readRet = unzReadCurrentFile(handle, buffer, size);
+        unzCloseCurrentFile(handle);
+        if (readRet <= 0) {
+            vWarn("Error reading file '" << filePath << "' from apk!");
+            return false;
+        }
+        return true;
+    }
+
+    template<class Name>
+    bool read(const Name &filePath, void *&buffer, uint &length)
+    {
+        if (!openEntry(filePath, length)) {
+            return false;
+        }
+
+        buffer = malloc(length);
+        if (!readEntry(filePath, buffer, length)) {
+            free(buffer);
+            buffer = NULL;
+            length = 0;
+            return false;
+        }
+        return true;
+    }
+
+    template<class Name>
+    bool read(const Name &filePath, VIODevice *output)
+    {
+        uint size;
+        if (!openEntry(filePath, size)) {
+            return false;
+        }
+
+        void *buffer = malloc(size);
+        if (!readEntry(filePath, buffer, size)) {
+            free(buffer);
+            return false;
+        }
+
+        output->write(static_cast<char *>(buffer), size);
+        free(buffer);
+        return true;
+    }
+
+    template<class Name>
+    VByteArray read(const Name &filePath)
+    {
+        uint size;
+        if (!openEntry(filePath, size)) {
+            return VByteArray();
+        }
+
+        VByteArray buffer;
+        buffer.resize(size);
+        if (!readEntry(filePath, &buffer[0], size)) {
+            return VByteArray();
+        }
+        return buffer;
+    }
 };
 
 VZipFile::VZipFile()
@@ -34,7 +178,11 @@ bool VZipFile::open(const VString &packageName)
     VByteArray latin1 = packageName.toLatin1();
     vInfo("VZipFile is opening" << latin1);
     d->handle = unzOpen(latin1.c_str());
-    return d->handle != nullptr;
+    if (d->handle == nullptr) {
+        return false;
+    }
+    d->indexEntries();
+    return true;
 }
 
 bool VZipFile::isOpen() const
@@ -46,146 +194,49 @@ void VZipFile::close()
 {
     if (d->handle) {
         unzClose(d->handle);
+        d->handle = nullptr;
     }
+    d->entries.clear();
 }
 
-bool VZipFile::contains(const VString &filePath) const
+bool VZipFile::contains(VStringView filePath) const
 {
-    VByteArray path = filePath.toUtf8();
-    const int locateRet = unzLocateFile(d->handle, path.c_str(), 2/* case insensitive */);
-    if (locateRet != UNZ_OK) {
-        vInfo("File '" << path << "' not found in apk!");
-        return false;
-    }
-
-    const int openRet = unzOpenCurrentFile(d->handle);
-    if (openRet != UNZ_OK) {
-        vWarn("Error opening file '" << path << "' from apk!");
-        return false;
-    }
-
-    unzCloseCurrentFile(d->handle);
-    return true;
+    return d->contains(filePath);
 }
 
-bool VZipFile::read(const VString &filePath, void *&buffer, uint &length) const
+bool VZipFile::contains(VByteArrayView filePath) const
 {
-    if (d->handle == nullptr) {
-        vError("VZipFile is not open");
-        return false;
-    }
-
-    VByteArray path = filePath.toUtf8();
-    const int locateRet = unzLocateFile(d->handle, path.data(), 2 /* case insensitive */);
-    if (locateRet != UNZ_OK) {
-        vWarn("File '" << path << "' not found in apk!");
-        return false;
-    }
-
-    unz_file_info info;
-    const int getRet = unzGetCurrentFileInfo(d->handle, &info, NULL, 0, NULL, 0, NULL, 0);
-    if (getRet != UNZ_OK) {
-        vWarn("File info error reading '" << path << "' from apk!");
-        return false;
-    }
-    const int openRet = unzOpenCurrentFile(d->handle);
-    if (openRet != UNZ_OK) {
-        vWarn("Error opening file '" << path << "' from apk!");
-        return false;
-    }
-
-    length = info.uncompressed_size;
-    buffer = malloc(length);
-
-    const int readRet = unzReadCurrentFile(d->handle, buffer, length);
-    unzCloseCurrentFile(d->handle);
-    if (readRet <= 0) {
-        vWarn("Error reading file '" << path << "' from apk!");
-        free(buffer);
-        buffer = NULL;
-        length = 0;
-        return false;
-    }
-    return true;
+    return d->contains(filePath);
 }
 
-bool VZipFile::read(const VString &filePath, VIODevice *output) const
+bool VZipFile::read(VStringView filePath, void *&buffer, uint &length) const
 {
-    if (d->handle == nullptr) {
-        vError("VZipFile is not open");
-        return false;
-    }
-
-    VByteArray path = filePath.toUtf8();
-    const int locateRet = unzLocateFile(d->handle, path.data(), 2 /* case insensitive */);
-    if (locateRet != UNZ_OK) {
-        vWarn("File '" << path << "' not found in apk!");
-        return false;
-    }
-
-    unz_file_info info;
-    const int getRet = unzGetCurrentFileInfo(d->handle, &info, NULL, 0, NULL, 0, NULL, 0);
-    if (getRet != UNZ_OK) {
-        vWarn("File info error reading '" << path << "' from apk!");
-        return false;
-    }
-    const int openRet = unzOpenCurrentFile(d->handle);
-    if (openRet != UNZ_OK) {
-        vWarn("Error opening file '" << path << "' from apk!");
-        return false;
-    }
-
-    void *buffer = malloc(info.uncompressed_size);
-    const int readRet = unzReadCurrentFile(d->handle, buffer, info.uncompressed_size);
-    unzCloseCurrentFile(d->handle);
-    if (readRet <= 0) {
-        free(buffer);
-        vWarn("Error reading file '" << path << "' from apk!");
-        return false;
-    }
-
-    output->write(static_cast<char *>(buffer), info.uncompressed_size);
-    free(buffer);
-
-    return true;
+    return d->read(filePath, buffer, length);
 }
 
-VByteArray VZipFile::read(const VString &filePath) const
+bool VZipFile::read(VByteArrayView filePath, void *&buffer, uint &length) const
 {
-    if (d->handle == nullptr) {
-        vError("VZipFile is not open");
-        return VByteArray();
-    }
+    return d->read(filePath, buffer, length);
+}
 
-    VByteArray path = filePath.toUtf8();
-    const int locateRet = unzLocateFile(d->handle, path.data(), 2 /* case insensitive */);
-    if (locateRet != UNZ_OK) {
-        vWarn("File '" << path << "' not found in apk!");
-        return VByteArray();
-    }
+bool VZipFile::read(VStringView filePath, VIODevice *output) const
+{
+    return d->read(filePath, output);
+}
 
-    unz_file_info info;
-    const int getRet = unzGetCurrentFileInfo(d->handle, &info, NULL, 0, NULL, 0, NULL, 0);
-    if (getRet != UNZ_OK) {
-        vWarn("File info error reading '" << path << "' from apk!");
-        return VByteArray();
-    }
-    const int openRet = unzOpenCurrentFile(d->handle);
-    if (openRet != UNZ_OK) {
-        vWarn("Error opening file '" << path << "' from apk!");
-        return VByteArray();
-    }
+bool VZipFile::read(VByteArrayView filePath, VIODevice *output) const
+{
+    return d->read(filePath, output);
+}
 
-    VByteArray buffer;
-    buffer.resize(info.uncompressed_size);
-    const int readRet = unzReadCurrentFile(d->handle, &buffer[0], info.uncompressed_size);
-    unzCloseCurrentFile(d->handle);
-    if (readRet <= 0) {
-        vWarn("Error reading file '" << path << "' from apk!");
-        return VByteArray();
-    }
+VByteArray VZipFile::read(VStringView filePath) const
+{
+    return d->read(filePath);
+}
 
-    return buffer;
+VByteArray VZipFile::read(VByteArrayView filePath) const
+{
+    return d->read(filePath);
 }
 
 NV_NAMESPACE_END
@@ -2,11 +2,10 @@
 
 #include "VIODevice.h"
 #include "VByteArray.h"
+#include "VStringView.h"
 
 NV_NAMESPACE_BEGIN
 
-class VString;
-
 class VZipFile
 {
 public:
@@ -18,11 +17,17 @@ public:
     bool isOpen() const;
     void close();
 
-    bool contains(const VString &filePath) const;
-
-    bool read(const VString &filePath, void *&buffer, uint &length) const;
-    bool read(const VString &filePath, VIODevice *output) const;
-    VByteArray read(const VString &filePath) const;
+    // Entries are looked up by views, so literal names are neither
+    // converted nor copied
+    bool contains(VStringView filePath) const;
+    bool contains(VByteArrayView filePath) const;
+
+    bool read(VStringView filePath, void *&buffer, uint &length) const;
+    bool read(VByteArrayView filePath, void *&buffer, uint &length) const;
+    bool read(VStringView filePath, VIODevice *output) const;
+    bool read(VByteArrayView filePath, VIODevice *output) const;
+    VByteArray read(VStringView filePath) const;
+    VByteArray read(VByteArrayView filePath) const;
 
 private:
     NV_DECLARE_PRIVATE
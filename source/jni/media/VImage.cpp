@@ -1,22 +1,28 @@
 #include "VImage.h"
+#include "VThreadPool.h"
 
+#include <atomic>
 #include <math.h>
 #include <3rdparty/stb/stb_image.h>
 #include <3rdparty/stb/stb_image_write.h>
 
 NV_NAMESPACE_BEGIN
 
+// Shared by the copies of an image until one of them changes the pixels
 struct VImage::Private
 {
+    std::atomic<int> ref;
     uchar *data;
     int width;
     int height;
     int compress;
 
     Private()
-        : data(nullptr)
+        : ref(1)
+        , data(nullptr)
         , width(0)
         , height(0)
+        , compress(4)
     {
     }
 
@@ -29,17 +35,55 @@ struct VImage::Private
 
     void load(const VPath &path)
     {
-        data = stbi_load(path.toUtf8().data(), &width, &height, &compress, 4);
+        data = stbi_load(VNativePath(path), &width, &height, &compress, 4);
     }
 
     void load(const VByteArray &encoded)
     {
         data = stbi_load_from_memory(reinterpret_cast<const uchar *>(encoded.data()), encoded.size(), &width, &height, &compress, 4);
     }
+
+    // Empty images share this one, which is never freed
+    static Private *SharedNull()
+    {
+        static Private null;
+        null.ref++;
+        return &null;
+    }
+
+    static Private *Ref(Private *d)
+    {
+        d->ref++;
+        return d;
+    }
+
+    static void Release(Private *d)
+    {
+        if (d && --d->ref == 0) {
+            delete d;
+        }
+    }
+
+    // Gives the new pixels to d, or to a new private if other images share it
+    static Private *Replace(Private *d, uchar *data, int width, int height)
+    {
+        if (d->ref.load() > 1) {
+            Private *detached = new Private;
+            detached->compress = d->compress;
+            Release(d);
+            d = detached;
+        } else {
+            free(d->data);
+        }
+        d->data = data;
+        d->width = width;
+        d->height = height;
+        return d;
+    }
 };
 
 VImage::VImage()
-    : d(new Private)
+    : d(Private::SharedNull())
 {
 }
 
@@ -50,18 +94,14 @@ VImage::VImage(const VPath &path)
 }
 
 VImage::VImage(const VImage &source)
-    : d(new Private)
+    : d(Private::Ref(source.d))
 {
-    d->data = (uchar *) malloc(source.length());
-    memcpy(d->data, source.data(), source.length());
-    d->width = source.width();
-    d->height = source.height();
 }
 
 VImage::VImage(VImage &&source)
     : d(source.d)
 {
-    source.d = nullptr;
+    source.d = Private::SharedNull();
 }
 
 VImage::VImage(uchar *decoded, int width, int height)
@@ -80,33 +120,47 @@ VImage::VImage(const VByteArray &encoded)
 
 VImage::~VImage()
 {
-    delete d;
+    Private::Release(d);
+}
+
+VImage &VImage::operator=(const VImage &source)
+{
+    Private *old = d;
+    d = Private::Ref(source.d);
+    Private::Release(old);
+    return *this;
+}
+
+VImage &VImage::operator=(VImage &&source)
+{
+    std::swap(d, source.d);
+    return *this;
 }
 
 bool VImage::load(const VPath &path)
 {
-    d->load(path);
+    *this = VImage(path);
     return isValid();
 }
 
 bool VImage::load(const VByteArray &data)
 {
-    d->load(data);
+    *this = VImage(data);
     return isValid();
 }
 
 bool VImage::write(const VPath &path) const
 {
-    if (path.endsWith(".png")) {
-        stbi_write_png(path.toUtf8().data(), d->width, d->height, d->compress, d->data, 0);
+    if (VStringView(path).endsWith(u".png")) {
+        stbi_write_png(VNativePath(path), d->width, d->height, d->compress, d->data, 0);
         return true;
     }
-    if (path.endsWith(".bmp")) {
-        stbi_write_bmp(path.toUtf8().data(), d->width, d->height, d->compress, d->data);
+    if (VStringView(path).endsWith(u".bmp")) {
+        stbi_write_bmp(VNativePath(path), d->width, d->height, d->compress, d->data);
         return true;
     }
-    if (path.endsWith(".tga")) {
-        stbi_write_tga(path.toUtf8().data(), d->width, d->height, d->compress, d->data);
+    if (VStringView(path).endsWith(u".tga")) {
+        stbi_write_tga(VNativePath(path), d->width, d->height, d->compress, d->data);
         return true;
     }
     return false;
@@ -233,19 +287,23 @@ void VImage::resize(int newWidth, int newHeight, Filter filter)
         table[i] = SRGBToLinear(i * (1.0f / 255.0f));
     }
 
-    for (int y = 0; y < d->height; y++) {
+    // Rows are independent, spread them over the worker threads
+    VThreadPool *pool = VThreadPool::instance();
+    const int rowsPerTask = 16;
+
+    pool->parallelFor(0, d->height, [&](int y) {
         for (int x = 0; x < d->width; x++) {
             for (int c = 0; c < 4; c++) {
                 srcLinear[(y * d->width + x) * 4 + c] = table[d->data[(y * d->width + x) * 4 + c]];
             }
         }
-    }
+    }, rowsPerTask);
 
     auto FracFloat = [](float x){
         return x - floorf(x);
     };
 
-    for (int y = 0; y < newHeight; y++) {
+    pool->parallelFor(0, newHeight, [&](int y) {
         const int srcY = (y * d->height * 2 + offsetY) / (newHeight * 2);
         const float fracY = FracFloat(((float) y * d->height * 2.0f + offsetY) / (newHeight * 2.0f));
 
@@ -285,24 +343,21 @@ void VImage::resize(int newWidth, int newHeight, Filter filter)
             scaledLinear[(y * newWidth + x) * 4 + 2] = fB;
             scaledLinear[(y * newWidth + x) * 4 + 3] = fA;
         }
-    }
+    }, rowsPerTask);
 
-    for (int y = 0; y < newHeight; y++) {
+    pool->parallelFor(0, newHeight, [&](int y) {
         for (int x = 0; x < newWidth; x++) {
             for (int c = 0; c < 4; c++) {
                 const float gamma = LinearToSRGB( scaledLinear[ ( y * newWidth + x ) * 4 + c ] );
                 scaled[(y * newWidth + x) * 4 + c] = ( unsigned char ) std::min(std::max(0, (int) (gamma * 255.0f + 0.5f)), 255);
             }
         }
-    }
+    }, rowsPerTask);
 
     free(scaledLinear);
     free(srcLinear);
 
-    free(d->data);
-    d->data = scaled;
-    d->width = newWidth;
-    d->height = newHeight;
+    d = Private::Replace(d, scaled, newWidth, newHeight);
 }
 
 void VImage::quarter(bool srgb)
@@ -319,8 +374,8 @@ void VImage::quarter(bool srgb)
     const int newWidth = std::max(1, width >> 1);
     const int newHeight = std::max(1, height >> 1);
     uchar *out = (uchar *) malloc(newWidth * newHeight * 4);
-    uchar *out_p = out;
-    for (int y = 0; y < newHeight; y++) {
+    VThreadPool::instance()->parallelFor(0, newHeight, [&](int y) {
+        uchar *out_p = out + y * newWidth * 4;
         const uchar *in_p = d->data + y * 2 * width * 4;
         for (int x = 0; x < newWidth; x++) {
             for (int i = 0; i < 4; i++) {
@@ -338,11 +393,8 @@ void VImage::quarter(bool srgb)
             out_p += 4;
             in_p += 8;
         }
-    }
-    free(d->data);
-    d->data = out;
-    d->width = newWidth;
-    d->height = newHeight;
+    }, 16);
+    d = Private::Replace(d, out, newWidth, newHeight);
 }
 
 bool VImage::operator==(const VImage &source) const
@@ -350,6 +402,9 @@ bool VImage::operator==(const VImage &source) const
     if (width() != source.width() || height() != source.height()) {
         return false;
     }
+    if (d == source.d) {
+        return true;
+    }
 
     const uchar *data = source.data();
     for (uint i = 0, max = length(); i < max; i++) {
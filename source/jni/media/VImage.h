@@ -25,6 +25,10 @@ public:
     VImage(const VByteArray &encoded);
     ~VImage();
 
+    // Copies share the pixels until one of them is changed
+    VImage &operator=(const VImage &source);
+    VImage &operator=(VImage &&source);
+
     bool load(const VPath &path);
     bool load(const VByteArray &data);
 
@@ -1,16 +1,16 @@
 #include "VSoundManager.h"
 
-#include "VJson.h"
+#include "VJsonReader.h"
 #include "VLog.h"
 #include "VResource.h"
 #include "VStandardPath.h"
 #include "VModule.h"
-#include "VMap.h"
+#include "VStringHash.h"
 #include "App.h"
 
 #include <list>
 #include <fstream>
-#include <sstream>
+#include <iterator>
 
 NV_NAMESPACE_BEGIN
 
@@ -32,33 +32,111 @@ NV_ADD_MODULE(VSoundModule)
 
 struct VSoundManager::Private
 {
-    VMap<VString, VString> soundMap;
+    VStringHash<VString> soundMap;
 
-    void loadSoundAssetsFromJsonObject(const VString &url, const VJson &dataFile)
+    // Literal names are looked up without converting them to VString
+    template<class Name>
+    bool getSound(const Name &soundName, VString &outSound) const
     {
-        vAssert(dataFile.isObject());
-
-        // Read in sounds - add to map
-        VJson sounds = dataFile.value("Sounds");
-        vAssert(sounds.isObject());
-
-        const VJsonObject &pairs = sounds.toObject();
-        for (const std::pair<VString, VJson> &pair : pairs) {
-            const VJson &sound = pair.second;
-            vAssert(sound.isString());
-
-            VString fullPath = url + sound.toString();
-
-            // Do we already have this sound?
-            if (soundMap.contains(pair.first)) {
-                vInfo("SoundManger - adding Duplicate sound" << pair.first << "with asset" << fullPath);
-                soundMap[pair.first] = fullPath;
-            // add new sound
-            } else {
-                vInfo("SoundManger read in:" << pair.first << "->" << fullPath);
-                soundMap[pair.first] = fullPath;
+        VStringHash<VString>::ConstIterator soundMapping = soundMap.find(soundName);
+        if (soundMapping != soundMap.end()) {
+            outSound = soundMapping->second;
+            return true;
+        }
+        vWarn("OvrSoundManager::GetSound failed to find" << soundName);
+        return false;
+    }
+
+    void addSound(const VString &name, const VString &fullPath)
+    {
+        // Do we already have this sound?
+        if (soundMap.contains(name)) {
+            vInfo("SoundManger - adding Duplicate sound" << name << "with asset" << fullPath);
+        } else {
+            vInfo("SoundManger read in:" << name << "->" << fullPath);
+        }
+        soundMap[name] = fullPath;
+    }
+
+    // Adds the entries of the "Sounds" object as they are read, with no tree in
+    // between. Anything but a string in there stops reading.
+    class SoundJsonHandler : public VJsonHandler
+    {
+    public:
+        SoundJsonHandler(Private *manager, const VString &url)
+            : m_manager(manager)
+            , m_url(url)
+            , m_depth(0)
+            , m_soundsKey(false)
+            , m_inSounds(false)
+            , m_soundsFound(false)
+        {
+        }
+
+        bool soundsFound() const { return m_soundsFound; }
+
+        bool null() override { return !m_inSounds; }
+        bool boolean(bool) override { return !m_inSounds; }
+        bool number(double) override { return !m_inSounds; }
+
+        bool string(VByteArrayView value) override
+        {
+            if (m_inSounds) {
+                m_manager->addSound(m_name, m_url + VString::fromUtf8(value.data(), value.size()));
+            }
+            return m_depth > 0;
+        }
+
+        bool key(VByteArrayView name) override
+        {
+            if (m_depth == 1) {
+                m_soundsKey = name == "Sounds";
+            } else if (m_inSounds) {
+                m_name = VString::fromUtf8(name.data(), name.size());
+            }
+            return true;
+        }
+
+        bool startObject() override
+        {
+            if (m_inSounds) {
+                return false;
+            }
+            m_depth++;
+            if (m_depth == 2 && m_soundsKey) {
+                m_inSounds = m_soundsFound = true;
             }
+            return true;
         }
+
+        bool endObject() override
+        {
+            m_depth--;
+            m_inSounds = false;
+            return true;
+        }
+
+        bool startArray() override { return !m_inSounds && m_depth > 0; }
+
+    private:
+        Private *m_manager;
+        VString m_url;
+        int m_depth;
+        bool m_soundsKey;
+        bool m_inSounds;
+        bool m_soundsFound;
+        VString m_name;
+    };
+
+    bool loadSoundAssetsFromBuffer(const VString &url, const char *data, uint size)
+    {
+        VJsonReader reader(data, size);
+        SoundJsonHandler handler(this, url);
+        if (!reader.parse(&handler)) {
+            vWarn("VSoundManager: " << reader.error() << " at offset " << reader.errorOffset());
+            return false;
+        }
+        return handler.soundsFound();
     }
 
     void loadSoundAssetsFromPackage(const VString &url, const VString &jsonFilePath)
@@ -68,15 +146,10 @@ struct VSoundManager::Private
             vFatal("VSoundManager::LoadSoundAssetsFromPackage failed to read" << jsonFilePath);
         }
 
-        std::stringstream buffer;
-        buffer << jsonFile.data();
-        VJson data;
-        buffer >> data;
-        if (data.isNull()) {
+        const VByteArray &data = jsonFile.data();
+        if (!loadSoundAssetsFromBuffer(url, data.data(), data.size())) {
             vFatal("OvrSoundManager::LoadSoundAssetsFromPackage failed json parse on" << jsonFilePath);
         }
-
-        loadSoundAssetsFromJsonObject(url, data);
     }
 };
 
@@ -106,14 +179,13 @@ void VSoundManager::loadSoundAssets()
 	VString foundPath;
     if (GetFullPath(searchPaths, DEV_SOUNDS_RELATIVE, foundPath)) {
         std::ifstream fp(foundPath.toStdString(), std::ios::binary);
-		VJson dataFile;
-		fp >> dataFile;
-        if (dataFile.isNull()) {
-            vFatal("OvrSoundManager::LoadSoundAssets failed to load JSON meta file:" << foundPath);
-		}
+        const std::string data((std::istreambuf_iterator<char>(fp)), std::istreambuf_iterator<char>());
 
-        foundPath.stripTrailing("sound_assets.json");
-        d->loadSoundAssetsFromJsonObject(foundPath, dataFile);
+        VString url = foundPath;
+        url.stripTrailing("sound_assets.json");
+        if (!d->loadSoundAssetsFromBuffer(url, data.data(), data.size())) {
+            vFatal("OvrSoundManager::LoadSoundAssets failed to load JSON meta file:" << foundPath);
+        }
 
     // if that fails, we are in release - load sounds from vrlib/res/raw and the assets folder
     } else {
@@ -125,27 +197,29 @@ void VSoundManager::loadSoundAssets()
 		}
 	}
 
-    if (d->soundMap.empty()) {
+    if (d->soundMap.isEmpty()) {
         vFatal("SoundManger - failed to load any sound definition files!");
 	}
 }
 
-bool  VSoundManager::hasSound(const VString &soundName)
+bool VSoundManager::hasSound(const VString &soundName)
 {
-    auto soundMapping = d->soundMap.find(soundName);
-    return soundMapping != d->soundMap.end();
+    return d->soundMap.contains(soundName);
 }
 
-bool  VSoundManager::getSound(const VString &soundName, VString & outSound)
+bool VSoundManager::hasSound(const char *soundName)
 {
-    std::map<VString, VString>::const_iterator soundMapping = d->soundMap.find(soundName);
-    if (soundMapping != d->soundMap.end()) {
-        outSound = soundMapping->second;
-		return true;
-    } else {
-        vWarn("OvrSoundManager::GetSound failed to find" << soundName);
-	}
-	return false;
+    return d->soundMap.contains(soundName);
+}
+
+bool VSoundManager::getSound(const VString &soundName, VString &outSound)
+{
+    return d->getSound(soundName, outSound);
+}
+
+bool VSoundManager::getSound(const char *soundName, VString &outSound)
+{
+    return d->getSound(soundName, outSound);
 }
 
 NV_NAMESPACE_END
@@ -13,7 +13,9 @@ public:
 
     void loadSoundAssets();
     bool hasSound(const VString &soundName);
+    bool hasSound(const char *soundName);
     bool getSound(const VString &soundName, VString &outSound);
+    bool getSound(const char *soundName, VString &outSound);
 
 private:
     VSoundManager();
@@ -26,11 +26,12 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
-#include <sstream>
 
 #include "VPath.h"
-#include "VJson.h"
+#include "VJsonReader.h"
 #include "VZipFile.h"
+#include "VHash.h"
+#include "VSmallArray.h"
 #include "VLog.h"
 #include "App.h"
 
@@ -133,7 +134,8 @@ public:
 	float MaxAscent; // maximum ascent of any character
 	float MaxDescent; // maximum descent of any character
     VArray<FontGlyphType> Glyphs; // info about each glyph in the font
-    VArray<int32_t> CharCodeMap; // index by character code to get the index of a glyph for the character
+    VHash<uint32_t, int> CharCodeMap; // index of the glyph for each character code
+    mutable VHash<uint32_t, bool> MissingCharCodes; // codes already warned about
 
 private:
     bool LoadFromPackage(const VZipFile &packageFile, const VString &fileName);
@@ -338,7 +340,7 @@ private:
 		bool TrackRoll; // if true, when billboarded, roll with the camera
 	};
 
-	VArray<VertexBlockType> VertexBlocks; // each pointer in the array points to an allocated block ov
+	VSmallArray<VertexBlockType, 16> VertexBlocks; // each pointer in the array points to an allocated block ov
 
 	// We cast BitmapFont to BitmapFontLocal internally so that we do not have to expose
 	// a lot of BitmapFontLocal methods in the BitmapFont interface just so BitmapFontSurfaceLocal
@@ -410,19 +412,9 @@ bool FontInfoType::LoadFromPackage(const VZipFile &packageFile, const VString &f
 		return false;
 	}
 
-	size_t fsize;
-
-	unsigned char * buffer = NULL;
-	// copy to a zero-terminated buffer for JSON parser
-	fsize = length + 1;
-	buffer = new unsigned char[fsize];
-	memcpy(buffer, packageBuffer, length);
-	buffer[length] = '\0';
-	free(packageBuffer);
-
 	// try to load from the buffer -- this may fail due to an invalid version
-	bool r = LoadFromBuffer(buffer, fsize);
-	delete[] buffer;
+	bool r = LoadFromBuffer(packageBuffer, length);
+	free(packageBuffer);
 	return r;
 }
 
@@ -438,59 +430,179 @@ bool FontInfoType::Load(const VZipFile &languagePackageFile, const VString &file
     return LoadFromPackage(apk, fileName);
 }
 
+//==============================
+// FontJsonHandler
+// Fills in the font as the JSON is read, with no tree in between. Glyphs are
+// kept in file units, since the header fields they are scaled by may come
+// after them.
+class FontJsonHandler : public VJsonHandler {
+public:
+	enum HeaderField {
+		Version, NumGlyphs, NaturalWidth, NaturalHeight, HorizontalPad, VerticalPad,
+		FontHeight, CenterOffset, TweakScale, FontName, CommandLine, ImageFileName, Glyphs,
+		HeaderFieldCount
+	};
+
+	FontJsonHandler(FontInfoType &font) :
+			IsObject(false), HasTweakScale(false), Font(font), Depth(0), Field(-1), InGlyphs(false) {
+		for (double &value : Header) {
+			value = 0.0;
+		}
+		Font.Glyphs.clear();
+	}
+
+	double Header[HeaderFieldCount];
+	std::string Strings[3];
+	bool IsObject;
+	bool HasTweakScale;
+
+	bool null() override { startValue(); return true; }
+	bool boolean(bool) override { startValue(); return true; }
+
+	bool number(double value) override {
+		startValue();
+		if (Field < 0) {
+			return true;
+		}
+		if (Depth == 1 && Field < FontName) {
+			Header[Field] = value;
+			HasTweakScale = HasTweakScale || Field == TweakScale;
+		} else if (Depth == 3 && InGlyphs) {
+			FontGlyphType &g = Font.Glyphs.last();
+			switch (Field) {
+			case 0: g.CharCode = static_cast<int>(value); break;
+			case 1: g.X = value; break;
+			case 2: g.Y = value; break;
+			case 3: g.Width = value; break;
+			case 4: g.Height = value; break;
+			case 5: g.AdvanceX = value; break;
+			case 6: g.AdvanceY = value; break;
+			case 7: g.BearingX = value; break;
+			case 8: g.BearingY = value; break;
+			}
+		}
+		return true;
+	}
+
+	bool string(VByteArrayView value) override {
+		startValue();
+		if (Depth == 1 && Field >= FontName && Field < Glyphs) {
+			Strings[Field - FontName] = VString::fromUtf8(value.data(), value.size()).toLatin1();
+		}
+		return true;
+	}
+
+	bool key(VByteArrayView name) override {
+		static const char *HeaderNames[HeaderFieldCount] = {
+			"Version", "NumGlyphs", "NaturalWidth", "NaturalHeight", "HorizontalPad", "VerticalPad",
+			"FontHeight", "CenterOffset", "TweakScale", "FontName", "CommandLine", "ImageFileName", "Glyphs"
+		};
+		static const char *GlyphNames[] = {
+			"CharCode", "X", "Y", "Width", "Height", "AdvanceX", "AdvanceY", "BearingX", "BearingY"
+		};
+
+		Field = -1;
+		if (Depth == 1) {
+			Field = Find(HeaderNames, HeaderFieldCount, name);
+		} else if (Depth == 3 && InGlyphs) {
+			Field = Find(GlyphNames, sizeof(GlyphNames) / sizeof(GlyphNames[0]), name);
+		}
+		return true;
+	}
+
+	bool startObject() override {
+		startValue();
+		IsObject = IsObject || Depth == 0;
+		Depth++;
+		return true;
+	}
+
+	bool endObject() override {
+		Depth--;
+		return true;
+	}
+
+	bool startArray() override {
+		startValue();
+		InGlyphs = InGlyphs || (Depth == 1 && Field == Glyphs);
+		Depth++;
+		return true;
+	}
+
+	bool endArray() override {
+		Depth--;
+		InGlyphs = InGlyphs && Depth > 1;
+		return true;
+	}
+
+private:
+	// every element of the glyph array takes a slot, even if it isn't an object
+	void startValue() {
+		if (Depth == 2 && InGlyphs) {
+			Font.Glyphs.append(FontGlyphType());
+		}
+	}
+
+	static int Find(const char * const *names, int count, VByteArrayView name) {
+		for (int i = 0; i < count; i++) {
+			if (name == names[i]) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	FontInfoType &Font;
+	int Depth;
+	int Field;
+	bool InGlyphs;
+};
+
 //==============================
 // FontInfoType::LoadFromBuffer
 bool FontInfoType::LoadFromBuffer(void const * buffer,
 		size_t const bufferSize) {
-    NV_UNUSED(bufferSize);
-	std::stringstream s;
-	s << reinterpret_cast<char const *>(buffer);
-	VJson jsonRoot;
-	s >> jsonRoot;
-    if (jsonRoot.isNull()) {
-		vWarn("JSON Error");
+	// read straight from the package data, which needs no terminating zero
+	VJsonReader reader(static_cast<char const *>(buffer), bufferSize);
+	FontJsonHandler json(*this);
+	if (!reader.parse(&json)) {
+		vWarn("JSON Error: " << reader.error() << " at offset " << reader.errorOffset());
 		return false;
 	}
 
-	int32_t maxCharCode = -1;
-	// currently we're only supporting the first unicode plane up to 65k. If we were to support other planes
-	// we could conceivably end up with a very sparse 1,114,111 byte type for mapping character codes to
-	// glyphs and if that's the case we may just want to use a hash, or use a combination of tables for
-	// the first 65K and hashes for the other, less-frequently-used characters.
+	// Character codes are hashed, so they may come from any unicode plane
 	static const int MAX_GLYPHS = 0xffff;
 
 	// load the glyphs
-	if (jsonRoot.type() != VJson::Object)
+	if (!json.IsObject)
 		return false;
 
-	int Version = jsonRoot.value("Version").toInt();
+	int Version = static_cast<int>(json.Header[FontJsonHandler::Version]);
 	if (Version != FNT_FILE_VERSION) {
 		return false;
 	}
 
-    FontName = jsonRoot.value("FontName").toStdString();
-    CommandLine = jsonRoot.value("CommandLine").toStdString();
-    ImageFileName = jsonRoot.value("ImageFileName").toStdString();
-	const int numGlyphs = jsonRoot.value("NumGlyphs").toInt();
+	FontName = json.Strings[0];
+	CommandLine = json.Strings[1];
+	ImageFileName = json.Strings[2];
+	const int numGlyphs = static_cast<int>(json.Header[FontJsonHandler::NumGlyphs]);
 	if (numGlyphs < 0 || numGlyphs > MAX_GLYPHS) {
 		vAssert( numGlyphs > 0 && numGlyphs <= MAX_GLYPHS);
 		return false;
 	}
 
-	NaturalWidth = jsonRoot.value("NaturalWidth").toDouble();
-	NaturalHeight = jsonRoot.value("NaturalHeight").toDouble();
+	NaturalWidth = json.Header[FontJsonHandler::NaturalWidth];
+	NaturalHeight = json.Header[FontJsonHandler::NaturalHeight];
 
 	// we scale everything after loading integer values from the JSON file because the OVR JSON writer loses precision on floats
 	double nwScale = 1.0f / NaturalWidth;
 	double nhScale = 1.0f / NaturalHeight;
 
-	HorizontalPad = jsonRoot.value("HorizontalPad").toDouble() * nwScale;
-	VerticalPad = jsonRoot.value("VerticalPad").toDouble() * nhScale;
-	FontHeight = jsonRoot.value("FontHeight").toDouble() * nhScale;
-	CenterOffset = jsonRoot.value("CenterOffset").toDouble();
-	TweakScale =
-			jsonRoot.contains("TweakScale") ?
-					jsonRoot.value("TweakScale").toDouble() : 1.0f;
+	HorizontalPad = json.Header[FontJsonHandler::HorizontalPad] * nwScale;
+	VerticalPad = json.Header[FontJsonHandler::VerticalPad] * nhScale;
+	FontHeight = json.Header[FontJsonHandler::FontHeight] * nhScale;
+	CenterOffset = json.Header[FontJsonHandler::CenterOffset];
+	TweakScale = json.HasTweakScale ? json.Header[FontJsonHandler::TweakScale] : 1.0f;
 
     vInfo("FontName = " << FontName);
     vInfo("CommandLine = " << CommandLine);
@@ -511,54 +623,31 @@ bool FontInfoType::LoadFromBuffer(void const * buffer,
 
 	Glyphs.resize(numGlyphs);
 
-	const VJson jsonGlyphArray = jsonRoot.value("Glyphs");
-
 	double oWidth = 0.0;
 	double oHeight = 0.0;
 
-	if (jsonGlyphArray.type() == VJson::Array) {
-		const VJsonArray &elements = jsonGlyphArray.toArray();
-
-		int i = 0;
-		for (const VJson &jsonGlyph : elements) {
-			if (jsonGlyph.type() == VJson::Object) {
-				FontGlyphType & g = Glyphs[i];
-				g.CharCode = jsonGlyph.value("CharCode").toInt();
-				g.X = jsonGlyph.value("X").toDouble();
-				g.Y = jsonGlyph.value("Y").toDouble();
-				g.Width = jsonGlyph.value("Width").toDouble();
-				g.Height = jsonGlyph.value("Height").toDouble();
-				g.AdvanceX = jsonGlyph.value("AdvanceX").toDouble();
-				g.AdvanceY = jsonGlyph.value("AdvanceY").toDouble();
-				g.BearingX = jsonGlyph.value("BearingX").toDouble();
-				g.BearingY = jsonGlyph.value("BearingY").toDouble();
-
-				if (g.CharCode == 'O') {
-					oWidth = g.Width;
-					oHeight = g.Height;
-				}
-
-				g.X *= nwScale;
-				g.Y *= nhScale;
-				g.Width *= nwScale;
-				g.Height *= nhScale;
-				g.AdvanceX *= nwScale;
-				g.AdvanceY *= nhScale;
-				g.BearingX *= nwScale;
-				g.BearingY *= nhScale;
-
-				float const ascent = g.BearingY;
-				float const descent = g.Height - g.BearingY;
-				if (ascent > MaxAscent) {
-					MaxAscent = ascent;
-				}
-				if (descent > MaxDescent) {
-					MaxDescent = descent;
-				}
+	for (FontGlyphType &g : Glyphs) {
+		if (g.CharCode == 'O') {
+			oWidth = g.Width;
+			oHeight = g.Height;
+		}
 
-				maxCharCode = std::max(maxCharCode, g.CharCode);
-			}
-			i++;
+		g.X *= nwScale;
+		g.Y *= nhScale;
+		g.Width *= nwScale;
+		g.Height *= nhScale;
+		g.AdvanceX *= nwScale;
+		g.AdvanceY *= nhScale;
+		g.BearingX *= nwScale;
+		g.BearingY *= nhScale;
+
+		float const ascent = g.BearingY;
+		float const descent = g.Height - g.BearingY;
+		if (ascent > MaxAscent) {
+			MaxAscent = ascent;
+		}
+		if (descent > MaxDescent) {
+			MaxDescent = descent;
 		}
 	}
 
@@ -579,24 +668,12 @@ bool FontInfoType::LoadFromBuffer(void const * buffer,
 	ScaleFactorY = DEFAULT_SCALE_FACTOR * DEFAULT_TEXT_SCALE * heightScaleFactor
 			* TweakScale;
 
-	// This is not intended for wide or ucf character sets -- depending on the size range of
-	// character codes lookups may need to be changed to use a hash.
-	if (maxCharCode >= MAX_GLYPHS) {
-		vAssert( maxCharCode <= MAX_GLYPHS);
-		maxCharCode = MAX_GLYPHS;
-	}
-
-	// resize the array to the maximum glyph value
-	CharCodeMap.resize(maxCharCode + 1);
-
-	// init to empty value
-	for (int i = 0; i < CharCodeMap.length(); ++i) {
-		CharCodeMap[i] = -1;
-	}
-
+	CharCodeMap.clear();
+	MissingCharCodes.clear();
+	CharCodeMap.reserve(Glyphs.length());
 	for (int i = 0; i < Glyphs.length(); ++i) {
 		FontGlyphType const & g = Glyphs[i];
-		CharCodeMap[g.CharCode] = i;
+		CharCodeMap.insert(g.CharCode, i);
 	}
 
 	return true;
@@ -606,18 +683,19 @@ bool FontInfoType::LoadFromBuffer(void const * buffer,
 // FontInfoType::GlyphForCharCode
 FontGlyphType const & FontInfoType::GlyphForCharCode(
 		uint32_t const charCode) const {
-	if (charCode >= CharCodeMap.size()) {
-		static FontGlyphType emptyGlyph;
-		return emptyGlyph;
-	}
-	const int glyphIndex = CharCodeMap[charCode];
+	const int glyphIndex = CharCodeMap.value(charCode, -1);
 
 	if (glyphIndex < 0 || glyphIndex >= Glyphs.length()) {
-		vWarn("FontInfoType::GlyphForCharCode FAILED TO FIND GLYPH FOR CHARACTER!");
-		vWarn("FontInfoType::GlyphForCharCode: charCode " << charCode << " yielding " << glyphIndex);
-		vWarn("FontInfoType::GlyphForCharCode: CharCodeMap size " << CharCodeMap.size() << " Glyphs size " << Glyphs.length());
+		// Text is redrawn every frame, so each code is reported once
+		if (!MissingCharCodes.contains(charCode)) {
+			MissingCharCodes.insert(charCode, true);
+			vWarn("FontInfoType::GlyphForCharCode: no glyph for charCode " << charCode << " yielding " << glyphIndex
+					<< ", CharCodeMap size " << CharCodeMap.size() << " Glyphs size " << Glyphs.length());
+		}
 
-		return Glyphs['*'];
+		static FontGlyphType emptyGlyph;
+		const int starIndex = CharCodeMap.value('*', -1);
+		return starIndex < 0 ? emptyGlyph : Glyphs[starIndex];
 	}
 
 	vAssert( glyphIndex >= 0 && glyphIndex < Glyphs.length());
@@ -790,7 +868,7 @@ bool BitmapFontLocal::LoadImage(const VZipFile &languagePackageFile, const VStri
 		free(packageBuffer);
 	} else {
         //TODO Replace the block with VFile
-        FILE * f = fopen(imageName.toUtf8().data(), "rb");
+        FILE * f = fopen(VNativePath(imageName), "rb");
 		if (f != NULL) {
 			size_t fsize = FileSize(f);
 
@@ -11,6 +11,9 @@ NV_NAMESPACE_BEGIN
 class VEyeItem : public VItem
 {
 public:
+    // Larger than VItem, so it needs a pool of its own
+    NV_DECLARE_POOLED(VEyeItem)
+
     enum CommonParameter
     {
         DepthFormat_0,
@@ -5,10 +5,12 @@ NV_NAMESPACE_BEGIN
 struct VItem::Private
 {
     VItem *parent;
-    VArray<VItem *> children;
+    VItem::Children children;
     //VPosF pos;
     bool visible;
 
+    NV_DECLARE_POOLED(Private)
+
     Private()
         : parent(nullptr)
         , visible(true)
@@ -50,7 +52,7 @@ void VItem::removeChild(VItem *item)
     }
 }
 
-const VArray<VItem *> &VItem::children() const
+const VItem::Children &VItem::children() const
 {
     return d->children;
 }
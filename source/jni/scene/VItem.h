@@ -1,7 +1,8 @@
 #pragma once
 
 #include "vglobal.h"
-#include "VArray.h"
+#include "VObjectPool.h"
+#include "VSmallArray.h"
 //#include "VPos.h"
 
 NV_NAMESPACE_BEGIN
@@ -9,12 +10,18 @@ NV_NAMESPACE_BEGIN
 class VItem
 {
 public:
+    // Most items have a handful of children, kept without an allocation
+    typedef VSmallArray<VItem *, 4> Children;
+
+    // Scenes create and drop many items, so plain items come from a pool
+    NV_DECLARE_POOLED(VItem)
+
     VItem(VItem *parent = nullptr);
     virtual ~VItem();
 
     void addChild(VItem *item);
     void removeChild(VItem *item);
-    const VArray<VItem *> &children() const;
+    const Children &children() const;
 
     VItem *parent() const;
     void setParent(VItem *item);
@@ -0,0 +1,198 @@
+#include "test.h"
+
+#include <VAsyncTask.h>
+#include <VSemaphore.h>
+
+#include <atomic>
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+struct Load
+{
+    Load()
+        : value(0)
+        , ioThread(false)
+        , poolThread(false)
+        , glThread(false)
+        , finished(nullptr)
+        , destroyed(nullptr)
+    {
+    }
+
+    ~Load()
+    {
+        if (destroyed) {
+            (*destroyed)++;
+        }
+    }
+
+    int value;
+    bool ioThread;
+    bool poolThread;
+    bool glThread;
+    VSemaphore *finished;
+    std::atomic<int> *destroyed;
+};
+
+// Executes the events of a loop until it receives "quit"
+struct Consumer
+{
+    Consumer()
+        : loop(64)
+        , thread([this]{
+            forever {
+                loop.wait();
+                VEvent event = loop.next();
+                if (event.name == "quit") {
+                    break;
+                }
+                if (event.isExecutable()) {
+                    event.execute();
+                }
+            }
+        })
+    {
+    }
+
+    ~Consumer()
+    {
+        loop.post("quit");
+        thread.join();
+    }
+
+    bool isCurrent() const { return std::this_thread::get_id() == thread.get_id(); }
+
+    VEventLoop loop;
+    std::thread thread;
+};
+
+void test()
+{
+    {
+        Consumer io;
+        Consumer gl;
+        VThreadPool pool(2);
+        std::atomic<int> destroyed(0);
+        const std::thread::id poolThread = std::this_thread::get_id();
+
+        VAsyncTask<Load> task;
+        task.then(&io.loop, [&](Load &load) {
+            load.ioThread = io.isCurrent();
+            load.value = 1;
+            return true;
+        }).then(&pool, [&](Load &load) {
+            load.poolThread = std::this_thread::get_id() != poolThread && !io.isCurrent() && !gl.isCurrent();
+            load.value *= 10;
+            return true;
+        }).then([&](Load &load) {
+            // Stays on the pool
+            load.value += 2;
+            return load.value == 12;
+        }).then(&gl.loop, [&](Load &load) {
+            load.glThread = gl.isCurrent();
+            assert(load.ioThread && load.poolThread && load.glThread);
+            assert(load.value == 12);
+            load.finished->post();
+            return true;
+        });
+
+        VSemaphore finished;
+        for (int i = 0; i < 20; i++) {
+            Load load;
+            load.finished = &finished;
+            load.destroyed = &destroyed;
+            assert(task.start(std::move(load)));
+        }
+        for (int i = 0; i < 20; i++) {
+            finished.wait();
+        }
+
+        // Every frame is released once its last step returns
+        while (destroyed.load() < 40) {
+            std::this_thread::yield();
+        }
+    }
+
+    {
+        // A step returning false ends the run
+        Consumer io;
+        std::atomic<int> destroyed(0);
+        std::atomic<int> reached(0);
+
+        VAsyncTask<Load> task;
+        task.then(&io.loop, [&](Load &load) {
+            return load.value > 0;
+        }).then([&](Load &) {
+            reached++;
+            return true;
+        });
+
+        Load stopped;
+        stopped.destroyed = &destroyed;
+        task.start(std::move(stopped));
+
+        Load passed;
+        passed.value = 1;
+        passed.destroyed = &destroyed;
+        task.start(std::move(passed));
+
+        // The frames of both runs, the locals are still alive
+        while (destroyed.load() < 2) {
+            std::this_thread::yield();
+        }
+        assert(reached == 1);
+    }
+
+    {
+        // Nothing runs on a loop which has quit
+        VEventLoop loop(4);
+        loop.quit();
+
+        std::atomic<int> destroyed(0);
+        VAsyncTask<Load> task;
+        task.then(&loop, [](Load &) {
+            assert(false);
+            return true;
+        });
+
+        Load load;
+        load.destroyed = &destroyed;
+        assert(!task.start(std::move(load)));
+        assert(destroyed == 1);
+    }
+
+    {
+        // Runs dropped by clear() or a destroyed loop release their frames
+        std::atomic<int> destroyed(0);
+        VEventLoop *loop = new VEventLoop(4);
+        VAsyncTask<Load> task;
+        task.then(loop, [](Load &) {
+            assert(false);
+            return true;
+        });
+
+        for (int i = 0; i < 2; i++) {
+            Load load;
+            load.destroyed = &destroyed;
+            assert(task.start(std::move(load)));
+        }
+        assert(destroyed == 2);
+        loop->clear();
+        assert(!loop->next().isValid());
+        assert(destroyed == 4);
+
+        // The local is still alive
+        Load load;
+        load.destroyed = &destroyed;
+        assert(task.start(std::move(load)));
+        delete loop;
+        assert(destroyed == 5);
+    }
+}
+
+ADD_TEST(VAsyncTask, test)
+
+}
@@ -0,0 +1,63 @@
+#include "test.h"
+
+#include <VAtom.h>
+#include <VEvent.h>
+#include <VString.h>
+
+#include <sstream>
+#include <string.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+static_assert(VAtom("quit") == VAtom("quit"), "Literals are hashed at compile time");
+static_assert(VAtom("quit") != VAtom("pause"), "Different names");
+static_assert(VAtom().isNull() && !VAtom("").isNull(), "Only the default atom is null");
+
+int dispatch(const VEvent &event)
+{
+    switch (event.name) {
+    case VAtom("pause"):
+        return 1;
+    case VAtom("resume"):
+        return 2;
+    case VAtom("quit"):
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+void test()
+{
+    assert(dispatch(VEvent("pause")) == 1);
+    assert(dispatch(VEvent("resume")) == 2);
+    assert(dispatch(VEvent(VString("quit"))) == 3);
+    assert(dispatch(VEvent("surfaceChanged")) == 0);
+
+    // Runtime strings give the same atoms as literals
+    const char *name = "loaded pano";
+    assert(VAtom::Intern(name) == VAtom("loaded pano"));
+    assert(VAtom::Intern(VString("loaded pano")) == VAtom("loaded pano"));
+    assert(VAtom::Intern("loaded pano").id() == VAtom::Hash(name));
+
+    // The names are kept for printing only
+    assert(strcmp(VAtom("loaded pano").name(), "loaded pano") == 0);
+    assert(strcmp(VAtom("never interned").name(), "") == 0);
+    assert(strcmp(VAtom().name(), "") == 0);
+
+    VEvent event("touch");
+    assert(event.isValid());
+    assert(event.name == "touch");
+    assert(event.name != "key");
+    std::ostringstream out;
+    out << event.name;
+    assert(out.str() == "touch");
+
+    assert(!VEvent().isValid());
+}
+
+ADD_TEST(VAtom, test)
+
+}
@@ -2,6 +2,7 @@
 #include "VCircularQueue.h"
 
 #include <time.h>
+#include <algorithm>
 #include <deque>
 
 NV_USING_NAMESPACE
@@ -51,6 +52,36 @@ void test()
         assert(vqr.at(2) == 2);
     }
 
+    {
+        // A capacity which isn't a power of two, around the wrap of the ring
+        VCircularQueue<int> queue(5);
+        for (int i = 0; i < 13; i++) {
+            queue.append(i);
+            assert(queue.size() == (uint) std::min(i + 1, 5));
+            assert(queue.first() == std::max(0, i - 4) && queue.last() == i);
+        }
+        assert(queue.isFull());
+
+        const int range[7] = {20, 21, 22, 23, 24, 25, 26};
+        queue.appendRange(range, 2);
+        assert(queue.size() == 5 && queue.at(0) == 10 && queue.at(4) == 21);
+        queue.appendRange(range, 7);
+        for (int i = 0; i < 5; i++) {
+            assert(queue[i] == 22 + i);
+        }
+
+        int out[8] = {0};
+        assert(queue.copyOut(out, 1, 8) == 4);
+        assert(out[0] == 23 && out[3] == 26 && out[4] == 0);
+        assert(queue.copyOut(out, 5, 1) == 0);
+
+        queue.clear();
+        assert(queue.isEmpty());
+        queue.appendRange(range, 3);
+        queue.prepend(19);
+        assert(queue.size() == 4 && queue.first() == 19 && queue.last() == 22);
+    }
+
 
     constexpr int loopMax = 1000000;
     //performance
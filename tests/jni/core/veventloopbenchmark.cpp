@@ -0,0 +1,128 @@
+#include "test.h"
+
+#include <VEventLoop.h>
+#include <VMutex.h>
+#include <VSemaphore.h>
+#include <VTimer.h>
+
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// The mutex and semaphore based queue VEventLoop used to be, kept as a baseline
+class MutexEventLoop
+{
+public:
+    MutexEventLoop(int capacity)
+        : m_capacity(capacity)
+        , m_events(new VEvent[capacity])
+        , m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    ~MutexEventLoop()
+    {
+        delete[] m_events;
+    }
+
+    bool post(const VEvent &event)
+    {
+        m_mutex.lock();
+        if (m_tail - m_head >= m_capacity) {
+            m_mutex.unlock();
+            return false;
+        }
+        m_events[m_tail % m_capacity] = event;
+        m_tail++;
+        m_mutex.unlock();
+
+        m_posted.post();
+        return true;
+    }
+
+    VEvent next()
+    {
+        m_mutex.lock();
+        if (m_tail <= m_head) {
+            m_mutex.unlock();
+            return VEvent();
+        }
+        VEvent event = std::move(m_events[m_head % m_capacity]);
+        m_head++;
+        m_mutex.unlock();
+        return event;
+    }
+
+    void wait()
+    {
+        m_mutex.lock();
+        if (m_tail > m_head) {
+            m_mutex.unlock();
+            return;
+        }
+        m_mutex.unlock();
+        m_posted.wait();
+    }
+
+private:
+    int m_capacity;
+    VEvent *m_events;
+    int m_head;
+    int m_tail;
+    VMutex m_mutex;
+    VSemaphore m_posted;
+};
+
+template<class Loop>
+double measure(int producerNum, int eventNum)
+{
+    Loop loop(1024);
+    VEvent event("benchmark");
+    event.data = 1;
+
+    const double start = VTimer::Seconds();
+    std::thread *producers[8];
+    for (int i = 0; i < producerNum; i++) {
+        producers[i] = new std::thread([&]{
+            for (int j = 0; j < eventNum; j++) {
+                while (!loop.post(event)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int received = 0;
+    while (received < producerNum * eventNum) {
+        loop.wait();
+        if (loop.next().isValid()) {
+            received++;
+        }
+    }
+    const double elapsed = VTimer::Seconds() - start;
+
+    for (int i = 0; i < producerNum; i++) {
+        producers[i]->join();
+        delete producers[i];
+    }
+
+    return received / elapsed;
+}
+
+void test()
+{
+    const int eventNum = 50000;
+    for (int producerNum = 1; producerNum <= 8; producerNum++) {
+        const double lockFree = measure<VEventLoop>(producerNum, eventNum);
+        const double locked = measure<MutexEventLoop>(producerNum, eventNum);
+        vInfo(producerNum << " producer(s): " << (long long) lockFree << " events/sec, "
+              << (long long) locked << " events/sec with mutex");
+    }
+}
+
+ADD_BENCHMARK(VEventLoopBenchmark, test)
+
+}
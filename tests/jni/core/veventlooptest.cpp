@@ -2,13 +2,20 @@
 
 #include <VEventLoop.h>
 #include <VSemaphore.h>
+#include <VTimer.h>
 
+#include <atomic>
 #include <thread>
 
 NV_USING_NAMESPACE
 
 namespace {
 
+void Count(void *context)
+{
+    (*static_cast<int *>(context))++;
+}
+
 void test()
 {
     {
@@ -72,6 +79,209 @@ void test()
         assert(result == 10);
         release.wait();
     }
+
+    {
+        VEventLoop loop(2);
+        assert(loop.post("first"));
+        assert(loop.post("second"));
+        assert(!loop.post("third"));
+        assert(loop.next().name == "first");
+        assert(loop.post("third"));
+
+        loop.clear();
+        assert(!loop.next().isValid());
+        assert(loop.post("fourth"));
+        assert(loop.next().name == "fourth");
+        assert(!loop.next().isValid());
+    }
+
+    {
+        VEventLoop loop(8);
+        VArray<VEvent> events;
+        for (int i = 0; i < 6; i++) {
+            events.append(VEvent("batch"));
+            events.last().data = i;
+        }
+        assert(loop.postBatch(events) == 6);
+        assert(loop.postBatch(events) == 2);
+
+        VArray<VEvent> received;
+        assert(loop.drain(received, 4) == 4);
+        assert(loop.drain(received) == 4);
+        assert(loop.drain(received) == 0);
+        assert(received.length() == 8);
+        for (int i = 0; i < 6; i++) {
+            assert(received[i].data.toInt() == i);
+        }
+        assert(received[6].data.toInt() == 0);
+        assert(received[7].data.toInt() == 1);
+
+        assert(loop.postBatch(std::move(events)) == 6);
+        loop.clear();
+        assert(loop.post("last"));
+        received.clear();
+        assert(loop.drain(received) == 1);
+        assert(received.first().name == "last");
+    }
+
+    {
+        VEventLoop loop(8);
+        loop.post(VEvent("low"), VEventLoop::LowPriority);
+        loop.post("normal");
+        loop.post(VEvent("high"), VEventLoop::HighPriority);
+        assert(loop.length() == 3);
+        assert(loop.length(VEventLoop::HighPriority) == 1);
+        assert(loop.next().name == "high");
+        assert(loop.next().name == "normal");
+        assert(loop.next().name == "low");
+        assert(loop.length() == 0);
+    }
+
+    {
+        VEventLoop loop(8);
+        for (int i = 0; i < 3; i++) {
+            VEvent event("pano");
+            event.data = i;
+            loop.coalesce(std::move(event));
+        }
+        VEvent cube("cube");
+        cube.data = 3;
+        loop.coalesce("pano", std::move(cube));
+        loop.post("other");
+
+        VArray<VEvent> events;
+        assert(loop.drain(events) == 2);
+        assert(events[0].name == "cube");
+        assert(events[0].data.toInt() == 3);
+        assert(events[1].name == "other");
+        assert(loop.coalescedCount() == 3);
+
+        loop.coalesce(VEvent("pano"));
+        assert(loop.next().name == "pano");
+    }
+
+    {
+        // Newer events supersede older ones in any lane
+        VEventLoop loop(8);
+        loop.coalesce(VEvent("pose"));
+        loop.coalesce(VEvent("pose"), VEventLoop::HighPriority);
+        VArray<VEvent> events;
+        assert(loop.drain(events) == 1 && loop.coalescedCount() == 1);
+
+        // Cleared events don't hold back later ones
+        loop.coalesce(VEvent("pose"));
+        loop.clear();
+        assert(!loop.next().isValid());
+        loop.coalesce(VEvent("pose"));
+        assert(loop.next().name == "pose");
+
+        // The newest event of each key is always delivered
+        std::atomic<bool> posted(false);
+        std::thread producer([&]{
+            for (int i = 0; i < 10000; i++) {
+                VEvent event("key");
+                event.data = i;
+                while (!loop.coalesce(VAtom::Intern(VString::number(i % 16)), std::move(event))) {
+                    std::this_thread::yield();
+                }
+            }
+            posted = true;
+        });
+        int last[16] = {};
+        uint received = 0;
+        forever {
+            const bool done = posted;
+            events.clear();
+            received += loop.drain(events);
+            for (const VEvent &event : events) {
+                last[event.data.toInt() % 16] = event.data.toInt();
+            }
+            if (done && loop.length() == 0) {
+                break;
+            }
+        }
+        producer.join();
+        for (int key = 0; key < 16; key++) {
+            assert(last[key] == 9984 + key);
+        }
+        assert(received + loop.coalescedCount() - 1 == 10000);
+    }
+
+    {
+        VEventLoop loop(8);
+        const double start = VTimer::Seconds();
+        loop.postDelayed(30, "late");
+        loop.postDelayed(10, "early");
+        assert(!loop.next().isValid());
+        assert(!loop.wait(1));
+
+        loop.wait();
+        assert(VTimer::Seconds() - start >= 0.01);
+        assert(loop.next().name == "early");
+
+        loop.postAt(start + 0.02, VEvent("middle"), VEventLoop::HighPriority);
+        assert(loop.wait(1000));
+        assert(VTimer::Seconds() - start >= 0.02);
+        assert(loop.next().name == "middle");
+
+        loop.wait();
+        assert(VTimer::Seconds() - start >= 0.03);
+        assert(loop.next().name == "late");
+        assert(!loop.wait(5));
+    }
+
+    {
+        const int producerNum = 4;
+        const int eventNum = 10000;
+        VEventLoop loop(64);
+        std::thread *producers[producerNum];
+        for (int i = 0; i < producerNum; i++) {
+            producers[i] = new std::thread([&]{
+                for (int j = 0; j < eventNum; j++) {
+                    while (!loop.post("plus", j)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        int received = 0;
+        long long sum = 0;
+        while (received < producerNum * eventNum) {
+            loop.wait();
+            VEvent event = loop.next();
+            if (event.isValid()) {
+                received++;
+                sum += event.data.toInt();
+            }
+        }
+        assert(sum == (long long) producerNum * eventNum * (eventNum - 1) / 2);
+
+        for (int i = 0; i < producerNum; i++) {
+            producers[i]->join();
+            delete producers[i];
+        }
+    }
+
+    {
+        // Callback events dropped unexecuted are disposed of exactly once
+        int disposed = 0;
+        VEvent event(Count, &disposed, Count);
+        event.name = VAtom("pose");
+        VEventLoop *loop = new VEventLoop(8);
+        loop->post(event);
+        loop->clear();
+        assert(!loop->next().isValid() && disposed == 1);
+
+        loop->coalesce(event);
+        loop->coalesce(event);
+        assert(loop->next().name == "pose" && disposed == 2);
+
+        loop->post(event);
+        loop->postDelayed(60000, VEvent(event));
+        delete loop;
+        assert(disposed == 4);
+    }
 }
 
 ADD_TEST(VEventLoop, test)
@@ -0,0 +1,79 @@
+#include "test.h"
+
+#include <VFlatMap.h>
+#include <VJson.h>
+#include <VString.h>
+
+#include <map>
+#include <sstream>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        // Same contents and order as std::map whatever the insertion order
+        VFlatMap<int, int> map;
+        std::map<int, int> reference;
+        for (int i = 0; i < 1000; i++) {
+            const int key = rand() % 500;
+            map.insert(key, i);
+            reference.insert(std::make_pair(key, i));
+        }
+        assert(map.size() == reference.size());
+        auto i = map.begin();
+        for (const std::pair<const int, int> &pair : reference) {
+            assert(i->first == pair.first && i->second == pair.second);
+            ++i;
+        }
+
+        for (int key = -1; key <= 500; key++) {
+            assert(map.contains(key) == (reference.count(key) > 0));
+        }
+
+        map.remove(reference.begin()->first);
+        assert(!map.contains(reference.begin()->first));
+        assert(map.size() == reference.size() - 1);
+    }
+
+    {
+        VFlatMap<VString, int> map;
+        map.insert("b", 2);
+        map.insert("a", 1);
+        map.insert("a", 10);
+        assert(map.value("a") == 1);
+        assert(map.value("missing") == 0);
+        assert(!map.contains("missing"));
+
+        map["c"] = 3;
+        map["a"] = 4;
+        assert(map.size() == 3);
+        assert(map.value("a") == 4 && map.value("c") == 3);
+        assert(map.begin()->first == "a" && (map.end() - 1)->first == "c");
+
+        const VFlatMap<VString, int> &constMap = map;
+        assert(constMap["b"] == 2);
+        assert(constMap.find("d") == constMap.end());
+    }
+
+    {
+        // Objects come out in key order
+        std::stringstream in("{\"gamma\": 3, \"alpha\": {\"y\": 2, \"x\": 1}, \"beta\": [1, 2]}");
+        VJson json;
+        in >> json;
+        assert(json.size() == 3);
+        assert(json.toObject().begin()->first == "alpha");
+        assert(json.value("alpha").value("x").toInt() == 1);
+        assert(json.value("gamma").toInt() == 3);
+
+        std::stringstream out;
+        out << json.value("alpha");
+        assert(out.str().find("\"x\"") < out.str().find("\"y\""));
+    }
+}
+
+ADD_TEST(VFlatMap, test)
+
+}
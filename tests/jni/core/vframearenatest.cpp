@@ -0,0 +1,119 @@
+#include "test.h"
+
+#include <VFrameArena.h>
+
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VFrameArena arena(1024);
+        char *a = static_cast<char *>(arena.allocate(3, 1));
+        double *b = static_cast<double *>(arena.allocate(sizeof(double), alignof(double)));
+        assert(reinterpret_cast<uintptr_t>(b) % alignof(double) == 0);
+        assert((char *) b >= a + 3);
+        assert(arena.owns(a) && arena.owns(b));
+
+        // The latest allocation is taken back, the others are not
+        void *c = arena.allocate(100, 4);
+        const uint used = arena.bytesUsed();
+        arena.deallocate(c, 100);
+        assert(arena.bytesUsed() == used - 100);
+        assert(arena.allocate(100, 4) == c);
+        arena.deallocate(a, 3);
+        assert(arena.bytesUsed() == used);
+
+        // Large requests go to the heap
+        void *large = arena.allocate(600);
+        assert(!arena.owns(large));
+        assert(arena.bytesUsed() == used);
+        arena.deallocate(large, 600);
+
+        arena.reset();
+        assert(arena.bytesUsed() == 0);
+        assert(arena.lastFrameBytes() == used && arena.peakBytes() == used);
+        assert(arena.frameCount() == 1);
+        assert(arena.allocate(3, 1) == a);
+    }
+
+    {
+        // A frame outgrowing the block makes the next one fit in one
+        VFrameArena arena(1024);
+        void *first = nullptr;
+        for (int i = 0; i < 10; i++) {
+            void *p = arena.allocate(400, 8);
+            assert(p != nullptr && arena.owns(p));
+            if (i == 0) {
+                first = p;
+            }
+        }
+        assert(arena.capacity() > 1024);
+        assert(arena.bytesUsed() >= 4000);
+        arena.reset();
+        assert(arena.peakBytes() >= 4000);
+        const uint capacity = arena.capacity();
+        assert(capacity >= 4000);
+        assert(!arena.owns(first));
+
+        for (int i = 0; i < 10; i++) {
+            arena.allocate(400, 8);
+        }
+        assert(arena.capacity() == capacity);
+        arena.reset();
+        arena.allocate(16);
+        arena.reset();
+        assert(arena.lastFrameBytes() == 16);
+        assert(arena.peakBytes() >= 4000);
+    }
+
+    {
+        VFrameArena arena;
+        assert(VFrameArena::current() == nullptr);
+        arena.makeCurrent();
+        assert(VFrameArena::current() == &arena);
+
+        // Containers pick up the arena of their thread
+        {
+            VFrameArray<int> numbers;
+            for (int i = 0; i < 1000; i++) {
+                numbers.append(i);
+            }
+            assert(numbers.size() == 1000 && numbers[999] == 999);
+            assert(arena.owns(numbers.data()));
+
+            VFrameString text(u"frame temporary text, too long for any small string buffer");
+            text += u" and more";
+            assert(arena.owns(text.data()));
+        }
+
+        // Growing leaves the old buffers behind, reserving doesn't
+        arena.reset();
+        {
+            VFrameArray<int> numbers;
+            numbers.reserve(1000);
+            for (int i = 0; i < 1000; i++) {
+                numbers.append(i);
+            }
+            assert(arena.bytesUsed() == 1000 * sizeof(int));
+        }
+
+        std::thread other([&]{
+            assert(VFrameArena::current() == nullptr);
+            VFrameArray<int> numbers;
+            numbers.append(1);
+            assert(!arena.owns(numbers.data()));
+        });
+        other.join();
+
+        arena.doneCurrent();
+        assert(VFrameArena::current() == nullptr);
+    }
+}
+
+ADD_TEST(VFrameArena, test)
+
+}
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#include <VFrameGraph.h>
+#include <VThreadPool.h>
+
+#include <atomic>
+#include <pthread.h>
+#include <unistd.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VFrameGraph graph;
+        graph.run();
+        assert(graph.stageCount() == 0);
+    }
+
+    {
+        // a -> (b, c) -> d, every stage checks its dependencies are done
+        VThreadPool pool(3);
+        VFrameGraph graph(&pool);
+        std::atomic<int> order[4];
+        std::atomic<int> counter(0);
+        const pthread_t caller = pthread_self();
+        bool onCaller = false;
+
+        int a = graph.addStage("a", [&]{
+            order[0] = counter++;
+        });
+        int b = graph.addStage("b", [&]{
+            order[1] = counter++;
+            assert(order[0] < order[1]);
+            usleep(2000);
+        }, {a});
+        int c = graph.addStage("c", [&]{
+            order[2] = counter++;
+            assert(order[0] < order[2]);
+        }, {a});
+        int d = graph.addStage("d", [&]{
+            order[3] = counter++;
+            assert(order[1] < order[3] && order[2] < order[3]);
+            onCaller = pthread_equal(pthread_self(), caller);
+        }, {b, c}, VFrameGraph::CallerThread);
+
+        assert(graph.stageCount() == 4);
+        assert(graph.stageName(c) == "c");
+
+        for (int frame = 0; frame < 50; frame++) {
+            counter = 0;
+            onCaller = false;
+            graph.run();
+            assert(counter == 4);
+            assert(onCaller);
+        }
+
+        // b sleeps, so it is on the critical path instead of c
+        const VArray<int> &path = graph.criticalStages();
+        assert(path.length() == 3);
+        assert(path[0] == a && path[1] == b && path[2] == d);
+        assert(graph.stageTime(b) >= 0.002);
+        assert(graph.criticalPath() >= graph.stageTime(b));
+        assert(graph.elapsed() >= graph.criticalPath() * 0.9);
+    }
+
+    {
+        // Independent stages all run, each its own critical path. A chain
+        // keeps its order however the stages are spread over the threads.
+        VThreadPool pool(4);
+        VFrameGraph graph(&pool);
+        std::atomic<int> done(0);
+        for (int i = 0; i < 4; i++) {
+            graph.addStage("sleep", [&]{
+                usleep(2000);
+                done++;
+            });
+        }
+        graph.run();
+        assert(done == 4);
+        assert(graph.criticalStages().length() == 1);
+
+        VFrameGraph chain(&pool);
+        std::atomic<int> next(0);
+        int previous = -1;
+        for (int i = 0; i < 8; i++) {
+            const VFrameGraph::Affinity affinity = i % 2 ? VFrameGraph::CallerThread : VFrameGraph::AnyThread;
+            auto job = [&next, i]{
+                assert(next == i);
+                next = i + 1;
+            };
+            previous = previous < 0 ? chain.addStage("link", job, {}, affinity)
+                                    : chain.addStage("link", job, {previous}, affinity);
+        }
+        for (int frame = 0; frame < 20; frame++) {
+            next = 0;
+            chain.run();
+            assert(next == 8);
+        }
+    }
+}
+
+ADD_TEST(VFrameGraph, test)
+
+}
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#include <VHash.h>
+#include <VStringHash.h>
+
+#include <map>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VHash<int, int> hash;
+        assert(hash.isEmpty());
+        assert(!hash.contains(1));
+        assert(hash.value(1) == 0);
+        assert(hash.value(1, -1) == -1);
+        assert(hash.begin() == hash.end());
+
+        hash.insert(1, 10);
+        hash[2] = 20;
+        hash.insert(1, 11);
+        assert(hash.size() == 2);
+        assert(hash.value(1) == 11);
+        assert(hash[2] == 20);
+        assert(hash.find(3) == hash.end());
+        assert(hash.find(2)->second == 20);
+
+        assert(hash.remove(1));
+        assert(!hash.remove(1));
+        assert(hash.size() == 1);
+        assert(!hash.contains(1));
+    }
+
+    {
+        // Against std::map through growth and removals which shift clusters
+        VHash<uint, uint> hash;
+        std::map<uint, uint> reference;
+        uint seed = 1;
+        for (int i = 0; i < 20000; i++) {
+            seed = seed * 1103515245 + 12345;
+            const uint key = (seed >> 16) % 4096;
+            if (seed & 0x100) {
+                hash.insert(key, i);
+                reference[key] = i;
+            } else {
+                assert(hash.remove(key) == (reference.erase(key) == 1));
+            }
+        }
+
+        assert(hash.size() == (int) reference.size());
+        for (const auto &pair : reference) {
+            assert(hash.value(pair.first, ~0u) == pair.second);
+        }
+        int count = 0;
+        for (const std::pair<uint, uint> &pair : hash) {
+            assert(reference.at(pair.first) == pair.second);
+            count++;
+        }
+        assert(count == hash.size());
+        assert(hash.capacity() * 3 >= hash.size() * 4);
+    }
+
+    {
+        VStringHash<int> hash;
+        hash.insert("first", 1);
+        hash.insert(VString("second"), 2);
+
+        // Found without building a VString
+        const char *name = "second";
+        assert(hash.contains(name));
+        assert(hash.value("first") == 1);
+        assert(!hash.contains("First"));
+        assert(!hash.contains("secon"));
+
+        VStringCaseHash<int> caseHash;
+        caseHash.insert("Res/Raw/Sound.WAV", 3);
+        assert(caseHash.value("res/raw/sound.wav") == 3);
+        assert(caseHash.value(VString("RES/RAW/SOUND.wav")) == 3);
+        assert(!caseHash.contains("res/raw/sound.wa"));
+        caseHash.insert("RES/RAW/SOUND.WAV", 4);
+        assert(caseHash.size() == 1);
+        assert(caseHash.value("Res/Raw/Sound.WAV") == 4);
+    }
+
+    {
+        // Views are read as UTF-8, like keys built with VString::fromUtf8()
+        const char *name = "res/caf\xc3\xa9/\xf0\x9f\x98\x80.png";
+        VStringCaseHash<int> hash;
+        hash.insert(VString::fromUtf8(name, strlen(name)), 5);
+        assert(hash.value(VByteArrayView(name)) == 5);
+        assert(hash.value(VByteArrayView("RES/CAF\xc3\xa9/\xf0\x9f\x98\x80.png")) == 5);
+        assert(!hash.contains(VByteArrayView("res/caf\xe9/\xf0\x9f\x98\x80.png")));
+
+        VByteArray longName(300, 'a');
+        longName.append(name, strlen(name));
+        VStringHash<int> longHash;
+        longHash.insert(VString::fromUtf8(longName), 6);
+        assert(longHash.value(VByteArrayView(longName.data(), longName.size())) == 6);
+    }
+}
+
+ADD_TEST(VHash, test)
+
+}
@@ -0,0 +1,228 @@
+#include "test.h"
+
+#include <VJson.h>
+#include <VJsonDocument.h>
+#include <VJsonReader.h>
+#include <VTimer.h>
+
+#include <algorithm>
+#include <sstream>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// The stream parser VJson used to have, kept as a baseline
+
+bool StreamTryRead(std::istream &in, char ch)
+{
+    char first;
+    do {
+        in.get(first);
+    } while (isspace(first));
+
+    if (first == ch)
+        return true;
+
+    in.unget();
+    return false;
+}
+
+bool StreamTryRead(std::istream &in, const char *str)
+{
+    char first;
+    do {
+        in.get(first);
+    } while (isspace(first));
+
+    const char *cur = str;
+    if (*cur != first) {
+        in.unget();
+        return false;
+    }
+
+    cur++;
+    while (*cur) {
+        if (StreamTryRead(in, *cur)) {
+            cur++;
+        } else {
+            while (cur != str) {
+                cur--;
+                in.putback(*cur);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+VJson StreamParse(std::istream &in)
+{
+    if (StreamTryRead(in, "null")) {
+        return VJson();
+    } else if (StreamTryRead(in, "false")) {
+        return VJson(false);
+    } else if (StreamTryRead(in, "true")) {
+        return VJson(true);
+    } else if (StreamTryRead(in, '"')) {
+        std::string str;
+        char ch;
+        while (!in.eof()) {
+            in.get(ch);
+            if (ch == '\\') {
+                in.get(ch);
+                if (ch == '"') {
+                    str += ch;
+                    continue;
+                }
+            } else if (ch == '"') {
+                break;
+            }
+            str += ch;
+        }
+        return VJson(VString::fromUtf8(str.data(), str.size()));
+    }
+
+    char ch;
+    in.get(ch);
+    if (ch == '-' || (ch >= '0' && ch <= '9') || ch == '.') {
+        in.unget();
+        double number;
+        in >> number;
+        return VJson(number);
+    } else if (ch == '[') {
+        VJsonArray array;
+        if (!StreamTryRead(in, ']')) {
+            do {
+                array.append(StreamParse(in));
+            } while (StreamTryRead(in, ','));
+            StreamTryRead(in, ']');
+        }
+        return VJson(std::move(array));
+    } else if (ch == '{') {
+        VJsonObject object;
+        if (!StreamTryRead(in, '}')) {
+            do {
+                VJson key = StreamParse(in);
+                StreamTryRead(in, ':');
+                object.insert(key.toString(), StreamParse(in));
+            } while (StreamTryRead(in, ','));
+            StreamTryRead(in, '}');
+        }
+        return VJson(std::move(object));
+    }
+    return VJson();
+}
+
+// Laid out like efigs.fnt: a header, then an object per glyph
+std::string FontJson(int glyphNum)
+{
+    std::stringstream s;
+    s << "{\n\t\"FontName\":\t\"efigs.fnt\",\n"
+      << "\t\"CommandLine\":\t\"OculusSans-Medium.otf ..\\\\..\\\\efigs -co -0.01 -ts 1.0\",\n"
+      << "\t\"Version\":\t1,\n\t\"ImageFileName\":\t\"efigs_sdf.ktx\",\n"
+      << "\t\"NaturalWidth\":\t8192,\n\t\"NaturalHeight\":\t2568,\n"
+      << "\t\"CenterOffset\":\t-0.01,\n\t\"TweakScale\":\t1,\n"
+      << "\t\"NumGlyphs\":\t" << glyphNum << ",\n\t\"Glyphs\":\t[{\n";
+    for (int i = 0; i < glyphNum; i++) {
+        if (i > 0) {
+            s << "\t\t}, {\n";
+        }
+        s << "\t\t\t\"CharCode\":\t" << 32 + i * 7 << ",\n"
+          << "\t\t\t\"X\":\t" << (i * 331) % 8192 << ",\n"
+          << "\t\t\t\"Y\":\t" << (i / 24) * 307 << ",\n"
+          << "\t\t\t\"Width\":\t" << 100 + i % 97 << ",\n"
+          << "\t\t\t\"Height\":\t" << 180 + i % 53 << ",\n"
+          << "\t\t\t\"AdvanceX\":\t" << 90.5 + i % 41 << ",\n"
+          << "\t\t\t\"AdvanceY\":\t0,\n"
+          << "\t\t\t\"BearingX\":\t" << -3 + i % 11 << ",\n"
+          << "\t\t\t\"BearingY\":\t" << 230.25 - i % 29 << "\n";
+    }
+    s << "\t\t}]\n}\n";
+    return s.str();
+}
+
+std::string Print(const VJson &json)
+{
+    std::stringstream s;
+    s.precision(17);
+    s << json;
+    return s.str();
+}
+
+void test()
+{
+    const std::string text = FontJson(305);
+
+    // Both give the same document
+    std::stringstream in(text);
+    const VJson expected = StreamParse(in);
+    const VJson parsed = VJson::Parse(text.data(), text.size());
+    assert(parsed.value("Glyphs").size() == 305);
+    assert(Print(parsed) == Print(expected));
+    VJsonDocument document;
+    assert(document.parse(text.data(), text.size()));
+    assert(Print(document.root()) == Print(expected));
+    const VByteArray binary = parsed.toBinary();
+    assert(Print(VJson::FromBinary(binary)) == Print(expected));
+
+    const int loops = 50;
+    double bestStream = 0.0;
+    double bestBuffer = 0.0;
+    double bestDocument = 0.0;
+    double bestTextWalk = 0.0;
+    double bestBinaryWalk = 0.0;
+    for (int run = 0; run < 5; run++) {
+        uint sink = 0;
+        double start = VTimer::Seconds();
+        for (int i = 0; i < loops; i++) {
+            std::stringstream s;
+            s << text;
+            sink += StreamParse(s).size();
+        }
+        bestStream = std::max(bestStream, loops / (VTimer::Seconds() - start));
+
+        start = VTimer::Seconds();
+        for (int i = 0; i < loops; i++) {
+            sink += VJson::Parse(text.data(), text.size()).size();
+        }
+        bestBuffer = std::max(bestBuffer, loops / (VTimer::Seconds() - start));
+
+        // Parsing and freeing, as the document is reused
+        start = VTimer::Seconds();
+        for (int i = 0; i < loops; i++) {
+            document.parse(text.data(), text.size());
+            sink += document.root().size();
+        }
+        bestDocument = std::max(bestDocument, loops / (VTimer::Seconds() - start));
+
+        // What the font and sound loaders do, walking without a tree
+        VJsonHandler handler;
+        start = VTimer::Seconds();
+        for (int i = 0; i < loops; i++) {
+            VJsonReader reader(text.data(), text.size());
+            sink += reader.parse(&handler);
+        }
+        bestTextWalk = std::max(bestTextWalk, loops / (VTimer::Seconds() - start));
+
+        start = VTimer::Seconds();
+        for (int i = 0; i < loops; i++) {
+            VJsonReader reader(binary);
+            sink += reader.parse(&handler);
+        }
+        bestBinaryWalk = std::max(bestBinaryWalk, loops / (VTimer::Seconds() - start));
+        assert(sink > 0);
+    }
+
+    const double megabytes = text.size() / (1024.0 * 1024.0);
+    vInfo("Font JSON of " << text.size() << " bytes: " << bestBuffer * megabytes << " MB/sec, "
+          << bestStream * megabytes << " MB/sec through a stream, " << bestBuffer / bestStream << "x");
+    vInfo("Into an arena: " << bestDocument * megabytes << " MB/sec, " << bestDocument / bestBuffer
+          << "x, " << document.bytesUsed() << " arena bytes");
+    vInfo("MessagePack of " << binary.size() << " bytes walked " << bestBinaryWalk / bestTextWalk
+          << "x faster than the text");
+}
+
+ADD_BENCHMARK(VJsonBenchmark, test)
+
+}
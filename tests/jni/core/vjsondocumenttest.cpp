@@ -0,0 +1,76 @@
+#include "test.h"
+
+#include <VJsonDocument.h>
+
+#include <sstream>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    const char *json = "{\"name\": \"font\", \"glyphs\": [{\"code\": 65, \"name\": \"A\"}, {\"code\": 66, \"name\": \"B\"}],"
+                       " \"empty\": {}, \"flags\": [true, false, null], \"name\": \"ignored\"}";
+
+    {
+        VJsonDocument document;
+        assert(document.parse(json, strlen(json)));
+        assert(document.bytesUsed() > 0);
+
+        const VJson &root = document.root();
+        assert(root.isObject() && root.size() == 4);
+        assert(root.value("name").toString() == u"font");
+        assert(root.contains("empty") && root.value("empty").size() == 0);
+
+        const VJson &glyphs = root.value("glyphs");
+        assert(glyphs.isArray() && glyphs.size() == 2);
+        assert(glyphs[1].value("code").toInt() == 66);
+        assert(glyphs[1].value(VString(u"name")).toStdString() == "B");
+        assert(root.value("flags").at(0).toBool() && root.value("flags").at(2).isNull());
+
+        // The elements of a container are next to each other
+        assert(&glyphs.toArray()[1] == &glyphs.toArray()[0] + 1);
+
+        // Same as the heap tree
+        std::stringstream documentText;
+        documentText << root;
+        std::stringstream heapText;
+        heapText << VJson::Parse(VByteArray(json));
+        assert(documentText.str() == heapText.str());
+
+        // Copies don't depend on the document
+        VJson copy = glyphs;
+        VJsonObject object = root.value("glyphs").at(0).toObject();
+        VJson flags;
+        flags = root.value("flags");
+        assert(document.parse("[1]", 3));
+        assert(document.root().size() == 1);
+        assert(copy.at(0).value("name").toString() == u"A");
+        assert(object.value(VString(u"code")).toInt() == 65);
+        assert(flags.size() == 3 && flags.at(0).toBool() && flags.at(2).isNull());
+    }
+
+    {
+        VJsonDocument document;
+        assert(!document.parse("[1, {\"a\": 2", 11));
+        assert(document.root().isNull());
+    }
+
+    {
+        // Large arrays don't fit in an arena block
+        std::string text = "[";
+        for (int i = 0; i < 20000; i++) {
+            text += i > 0 ? ",\"item\"" : "\"item\"";
+        }
+        text += "]";
+        VJsonDocument document;
+        assert(document.parse(text.data(), text.size()));
+        assert(document.root().size() == 20000);
+        assert(document.root().at(19999).toString() == u"item");
+    }
+}
+
+ADD_TEST(VJsonDocument, test)
+
+}
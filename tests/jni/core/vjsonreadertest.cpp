@@ -0,0 +1,74 @@
+#include "test.h"
+
+#include <VJsonReader.h>
+
+#include <string>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// Writes the events down as text
+class Recorder : public VJsonHandler
+{
+public:
+    std::string events;
+    int stopAt = -1;
+
+    bool null() override { return record("null"); }
+    bool boolean(bool value) override { return record(value ? "true" : "false"); }
+    bool number(double value) override { return record(std::to_string((int) value)); }
+    bool string(VByteArrayView value) override { return record("s:" + std::string(value.data(), value.size())); }
+    bool startObject() override { return record("{"); }
+    bool key(VByteArrayView name) override { return record("k:" + std::string(name.data(), name.size())); }
+    bool endObject() override { return record("}"); }
+    bool startArray() override { return record("["); }
+    bool endArray() override { return record("]"); }
+
+private:
+    bool record(const std::string &event)
+    {
+        if (!events.empty()) {
+            events += ' ';
+        }
+        events += event;
+        return stopAt-- != 0;
+    }
+};
+
+void test()
+{
+    {
+        const char *json = " {\"a\": [1, true, null], \"b\\\"c\": {\"d\": \"e\"}, \"f\": []} trailing";
+        VJsonReader reader(json, strlen(json));
+        Recorder recorder;
+        assert(reader.parse(&recorder));
+        assert(recorder.events == "{ k:a [ 1 true null ] k:b\"c { k:d s:e } k:f [ ] }");
+        assert(reader.error() == nullptr);
+        assert(reader.offset() == strlen(json) - 8);
+    }
+
+    {
+        // The handler stops reading
+        const char *json = "[1, 2, 3]";
+        VJsonReader reader(json, strlen(json));
+        Recorder recorder;
+        recorder.stopAt = 2;
+        assert(!reader.parse(&recorder));
+        assert(recorder.events == "[ 1 2");
+        assert(reader.error() != nullptr);
+    }
+
+    {
+        const VByteArray json("{\"a\": [1 2]}");
+        VJsonReader reader(json);
+        Recorder recorder;
+        assert(!reader.parse(&recorder));
+        assert(recorder.events == "{ k:a [ 1");
+        assert(reader.errorOffset() == 9);
+    }
+}
+
+ADD_TEST(VJsonReader, test)
+
+}
@@ -125,6 +125,53 @@ void test()
         assert(json.isObject());
         assert(json.size() == 0);
     }
+
+    {
+        // Parsed from a buffer without a terminating zero
+        const char text[] = {'[', '1', ',', ' ', '2', '5', ']'};
+        VJson json = VJson::Parse(text, 6);
+        assert(json.isNull());
+        json = VJson::Parse(text, 7);
+        assert(json.size() == 2 && json[1].toInt() == 25);
+    }
+
+    {
+        // Escapes are decoded, a backslash keeps any other character after it
+        VJson json = VJson::Parse(VByteArray("[\"a\\\"b\", \"c:\\\\d\", \"\\n\\t\\/\\u00e9\\u597d\\ud83d\\ude00\\q\"]"));
+        assert(json.at(0).toString() == u"a\"b");
+        assert(json.at(1).toString() == u"c:\\d");
+        assert(json.at(2).toString() == u"\n\t/\u00e9\u597d\U0001f600q");
+        assert(VJson::Parse(VByteArray("[\"\\u12\"]")).isNull());
+    }
+
+    {
+        const char *numbers[] = {"0", "-0", "12.5", "-0.001", "1e3", "2.5E-3", "123456789012345678",
+                                 "0.1234567890123456789", "1e-300", "4.9406564584124654e-324", "9007199254740993"};
+        for (const char *number : numbers) {
+            VJson json = VJson::Parse(VByteArray(number));
+            assert(json.isNumber());
+            assert(json.toDouble() == strtod(number, nullptr));
+        }
+    }
+
+    {
+        assert(VJson::Parse(VByteArray("{\"a\": [1, 2}")).isNull());
+        assert(VJson::Parse(VByteArray("[\"unterminated]")).isNull());
+        assert(VJson::Parse(VByteArray("{\"a\" 1}")).isNull());
+        assert(VJson::Parse(VByteArray("-")).isNull());
+        assert(VJson::Parse(VByteArray("")).isNull());
+    }
+
+    {
+        // The stream is left right after the value
+        stringstream s;
+        s << "{\"a\": true} 42";
+        VJson object;
+        VJson number;
+        s >> object >> number;
+        assert(object.value("a").toBool());
+        assert(number.toInt() == 42);
+    }
 }
 
 ADD_TEST(VJson, test)
@@ -0,0 +1,99 @@
+#include "test.h"
+
+#include <VLocklessHistory.h>
+
+#include <atomic>
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// A torn copy would break second == -first
+struct Pair
+{
+    Pair() : first(0), second(0) {}
+    Pair(double value) : first(value), second(-value) {}
+
+    double first;
+    double second;
+};
+
+Pair interpolatePair(const Pair &from, const Pair &to, double fraction)
+{
+    return Pair(from.first + (to.first - from.first) * fraction);
+}
+
+void test()
+{
+    {
+        VLocklessHistory<double, 4> history;
+        double value = -1.0;
+        assert(history.isEmpty());
+        assert(!history.sampleAt(1.0, value));
+        assert(history.state() == 0.0);
+
+        history.append(1.0, 10.0);
+        assert(history.sampleAt(0.0, value) && value == 10.0);
+        assert(history.sampleAt(5.0, value) && value == 10.0);
+
+        history.append(2.0, 20.0);
+        history.append(3.0, 40.0);
+        assert(history.size() == 3);
+        assert(history.state() == 40.0);
+        assert(history.sampleAt(1.5, value) && value == 15.0);
+        assert(history.sampleAt(2.75, value) && value == 35.0);
+        assert(history.sampleAt(3.0, value) && value == 40.0);
+        assert(history.sampleAt(0.5, value) && value == 10.0);
+
+        // The oldest ones are overwritten
+        history.append(4.0, 50.0);
+        history.append(5.0, 60.0);
+        assert(history.size() == 4);
+        assert(history.sampleAt(1.0, value) && value == 20.0);
+        assert(history.sampleAt(4.5, value) && value == 55.0);
+    }
+
+    {
+        // Readers never see a torn sample while the writer runs over them
+        VLocklessHistory<Pair, 8> history;
+        std::atomic<bool> stop(false);
+        std::thread writer([&]{
+            for (int i = 1; i <= 200000; i++) {
+                history.append(i, Pair(i));
+            }
+            stop = true;
+        });
+
+        std::thread *readers[2];
+        for (std::thread *&reader : readers) {
+            reader = new std::thread([&]{
+                double time = 0.0;
+                while (!stop) {
+                    Pair pair;
+                    if (history.sampleAt(time, pair, interpolatePair)) {
+                        assert(pair.first == -pair.second);
+                        assert(pair.first >= 1.0);
+                    }
+                    const Pair latest = history.state();
+                    assert(latest.first == -latest.second);
+                    time = latest.first - 3.5;
+                }
+            });
+        }
+
+        writer.join();
+        for (std::thread *reader : readers) {
+            reader->join();
+            delete reader;
+        }
+
+        Pair pair;
+        assert(history.sampleAt(199999.25, pair, interpolatePair));
+        assert(pair.first == 199999.25 && pair.second == -199999.25);
+    }
+}
+
+ADD_TEST(VLocklessHistory, test)
+
+}
@@ -0,0 +1,85 @@
+#include "test.h"
+
+#include <VLocklessQueue.h>
+
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VLocklessQueue<int> queue(5);
+        assert(queue.capacity() == 8);
+        for (int i = 0; i < 8; i++) {
+            assert(queue.append(i));
+        }
+        assert(!queue.append(8));
+        assert(queue.size() == 8);
+
+        int first = -1;
+        assert(queue.takeFirst(first) && first == 0);
+
+        const int range[4] = {8, 9, 10, 11};
+        assert(queue.appendRange(range, 4) == 1);
+
+        int out[16];
+        assert(queue.copyOut(out, 16) == 8);
+        for (int i = 0; i < 8; i++) {
+            assert(out[i] == i + 1);
+        }
+        assert(queue.isEmpty() && !queue.takeFirst(first));
+    }
+
+    {
+        // Samples streamed from one thread to another arrive once and in order
+        VLocklessQueue<uint> queue(64);
+        const uint sampleNum = 200000;
+        std::thread producer([&]{
+            uint next = 0;
+            uint batch[7];
+            while (next < sampleNum) {
+                if (next % 3 == 0) {
+                    if (queue.append(next)) {
+                        next++;
+                    }
+                } else {
+                    const uint count = std::min<uint>(7, sampleNum - next);
+                    for (uint i = 0; i < count; i++) {
+                        batch[i] = next + i;
+                    }
+                    next += queue.appendRange(batch, count);
+                }
+                if (queue.size() == queue.capacity()) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint expected = 0;
+        uint out[5];
+        while (expected < sampleNum) {
+            uint sample;
+            if (expected % 2 == 0 && queue.takeFirst(sample)) {
+                assert(sample == expected);
+                expected++;
+            }
+            const uint count = queue.copyOut(out, 5);
+            for (uint i = 0; i < count; i++) {
+                assert(out[i] == expected);
+                expected++;
+            }
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        assert(queue.isEmpty());
+    }
+}
+
+ADD_TEST(VLocklessQueue, test)
+
+}
@@ -0,0 +1,133 @@
+#include "test.h"
+
+#include <VJson.h>
+#include <VJsonDocument.h>
+#include <VJsonReader.h>
+#include <VMessagePack.h>
+#include <VVariant.h>
+
+#include <sstream>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+std::string Print(const VJson &json)
+{
+    std::stringstream s;
+    s << json;
+    return s.str();
+}
+
+void test()
+{
+    {
+        // Shortest encodings, from the specification
+        VMessagePackWriter writer;
+        writer.writeInt(1);
+        writer.writeInt(-1);
+        writer.writeInt(200);
+        writer.writeUInt(1);
+        writer.writeNumber(0.5);
+        writer.writeNumber(65536.0);
+        writer.writeString("ab");
+        writer.startArray(2);
+        writer.startMap(0);
+        writer.writeNil();
+        writer.writeBool(true);
+        const VByteArray expected("\x01\xff\xd1\x00\xc8\xcc\x01\xca\x3f\x00\x00\x00\xd2\x00\x01\x00\x00"
+                                  "\xa2" "ab" "\x92\x80\xc0\xc3", 24);
+        assert(writer.data() == expected);
+
+        VMessagePackReader reader(writer.data());
+        assert(reader.next() && reader.type() == VMessagePackReader::Int && reader.toLongLong() == 1);
+        assert(reader.next() && reader.toLongLong() == -1);
+        assert(reader.next() && reader.toLongLong() == 200);
+        assert(reader.next() && reader.type() == VMessagePackReader::UInt && reader.toULongLong() == 1);
+        assert(reader.next() && reader.type() == VMessagePackReader::Float && reader.toDouble() == 0.5);
+        assert(reader.next() && reader.toDouble() == 65536.0);
+        assert(reader.next() && reader.toString() == VByteArrayView("ab"));
+        assert(reader.next() && reader.type() == VMessagePackReader::Array && reader.size() == 2);
+        assert(reader.skip());
+        assert(reader.next() && reader.type() == VMessagePackReader::Boolean && reader.toBool());
+        assert(!reader.next() && reader.offset() == expected.size());
+    }
+
+    {
+        const char *text = "{\"name\": \"font\", \"scale\": 0.1, \"count\": 305, \"negative\": -3000000000,"
+                           " \"pi\": 3.141592653589793, \"glyphs\": [{\"char\": \"\\u00e9\"}, true, null, []]}";
+        const VJson json = VJson::Parse(text, strlen(text));
+        const VByteArray binary = json.toBinary();
+        assert(binary.size() < strlen(text));
+        assert(VMessagePackReader::Detect(binary.data(), binary.size()));
+        assert(!VMessagePackReader::Detect(text, strlen(text)));
+
+        const VJson decoded = VJson::FromBinary(binary);
+        assert(Print(decoded) == Print(json));
+        assert(decoded.value("pi").toDouble() == 3.141592653589793);
+        assert(decoded.value("negative").toDouble() == -3000000000.0);
+        assert(decoded.value("scale").toDouble() == 0.1);
+
+        // Text loaders take the binary form as well
+        assert(Print(VJson::Parse(binary)) == Print(json));
+        VJsonDocument document;
+        assert(document.parse(binary));
+        assert(Print(document.root()) == Print(json));
+
+        // Walked in place, skipping what isn't needed
+        VMessagePackReader reader(binary);
+        assert(reader.next() && reader.type() == VMessagePackReader::Map);
+        const uint pairs = reader.size();
+        uint glyphs = 0;
+        for (uint i = 0; i < pairs; i++) {
+            assert(reader.next() && reader.type() == VMessagePackReader::String);
+            const bool isGlyphs = reader.toString() == VByteArrayView("glyphs");
+            assert(reader.next());
+            if (isGlyphs) {
+                glyphs = reader.size();
+            }
+            assert(reader.skip());
+        }
+        assert(glyphs == 4 && reader.offset() == binary.size());
+
+        // Truncated data is an error, not a partial value
+        assert(VJson::FromBinary(binary.data(), binary.size() - 1).isNull());
+        VMessagePackReader truncated(binary.data(), 20);
+        VJsonHandler handler;
+        assert(!truncated.parse(&handler) && truncated.error() != nullptr);
+    }
+
+    {
+        VVariantMap map;
+        map.insert(VString(u"int"), -5);
+        map.insert(VString(u"uint"), 7u);
+        map.insert(VString(u"long"), 1LL << 40);
+        map.insert(VString(u"float"), 1.5f);
+        map.insert(VString(u"double"), 0.1);
+        map.insert(VString(u"name"), VString(u"a string longer than sixteen units"));
+        VVariantArray array;
+        array.append(true);
+        array.append(VVariant());
+        array.append(VString(u"short"));
+        map.insert(VString(u"array"), std::move(array));
+
+        const VVariant decoded = VVariant::FromBinary(VVariant(map).toBinary());
+        assert(decoded.isMap() && decoded.size() == map.size());
+        assert(decoded.value(VString(u"int")).isInt() && decoded.value(VString(u"int")).toInt() == -5);
+        assert(decoded.value(VString(u"uint")).isUInt() && decoded.value(VString(u"uint")).toUInt() == 7u);
+        assert(decoded.value(VString(u"long")).isLongLong() && decoded.value(VString(u"long")).toDouble() == (double) (1LL << 40));
+        assert(decoded.value(VString(u"float")).isFloat() && decoded.value(VString(u"float")).toFloat() == 1.5f);
+        assert(decoded.value(VString(u"double")).isDouble() && decoded.value(VString(u"double")).toDouble() == 0.1);
+        assert(decoded.value(VString(u"name")).toString() == VString(u"a string longer than sixteen units"));
+        const VVariant &elements = decoded.value(VString(u"array"));
+        assert(elements.size() == 3 && elements[0].toBool() && elements[1].isNull());
+        assert(elements[2].toString() == VString(u"short"));
+
+        // Keys must be strings
+        assert(VVariant::FromBinary(VByteArray("\x81\x01\x02", 3)).isNull());
+    }
+}
+
+ADD_TEST(VMessagePack, test)
+
+}
@@ -0,0 +1,249 @@
+#include "test.h"
+
+#include <VMutex.h>
+#include <VSemaphore.h>
+#include <VSignal.h>
+#include <VTimer.h>
+#include <VWaitCondition.h>
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// The pthread based primitives the V ones used to wrap, kept as a baseline
+
+class PthreadMutex
+{
+public:
+    PthreadMutex()
+        : m_lockCount(0)
+    {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&m_mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+
+    ~PthreadMutex() { pthread_mutex_destroy(&m_mutex); }
+
+    void lock()
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_lockCount++;
+        m_locker = pthread_self();
+    }
+
+    void unlock()
+    {
+        m_lockCount--;
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    pthread_mutex_t *handle() { return &m_mutex; }
+
+private:
+    pthread_mutex_t m_mutex;
+    uint m_lockCount;
+    pthread_t m_locker;
+};
+
+class PthreadSemaphore
+{
+public:
+    PthreadSemaphore() { sem_init(&m_sem, 0, 0); }
+    ~PthreadSemaphore() { sem_destroy(&m_sem); }
+
+    void wait() { sem_wait(&m_sem); }
+    void post() { sem_post(&m_sem); }
+
+private:
+    sem_t m_sem;
+};
+
+class PthreadCondition
+{
+public:
+    PthreadCondition() { pthread_cond_init(&m_condition, nullptr); }
+    ~PthreadCondition() { pthread_cond_destroy(&m_condition); }
+
+    void wait(PthreadMutex *mutex) { pthread_cond_wait(&m_condition, mutex->handle()); }
+    void notifyAll() { pthread_cond_broadcast(&m_condition); }
+
+private:
+    pthread_cond_t m_condition;
+};
+
+class PthreadSignal
+{
+public:
+    PthreadSignal()
+        : m_state(false)
+        , m_temporary(false)
+    {
+    }
+
+    void wait()
+    {
+        m_mutex.lock();
+        while (!m_state) {
+            m_condition.wait(&m_mutex);
+        }
+        if (m_temporary) {
+            m_state = m_temporary = false;
+        }
+        m_mutex.unlock();
+    }
+
+    void pulse()
+    {
+        m_mutex.lock();
+        m_state = m_temporary = true;
+        m_condition.notifyAll();
+        m_mutex.unlock();
+    }
+
+private:
+    bool m_state;
+    bool m_temporary;
+    PthreadMutex m_mutex;
+    PthreadCondition m_condition;
+};
+
+// Waits on a VWaitCondition the same way as on a PthreadCondition
+struct FutexCondition : public VWaitCondition
+{
+    void wait(VMutex *mutex) { VWaitCondition::wait(mutex); }
+};
+
+struct FutexSignal : public VSignal
+{
+    void wait() { VSignal::wait(); }
+};
+
+template<class Mutex>
+double lockRate(int threadNum, int loops)
+{
+    Mutex mutex;
+    int counter = 0;
+    std::thread *threads[8];
+
+    const double start = VTimer::Seconds();
+    for (int i = 0; i < threadNum; i++) {
+        threads[i] = new std::thread([&]{
+            for (int j = 0; j < loops; j++) {
+                mutex.lock();
+                counter++;
+                mutex.unlock();
+            }
+        });
+    }
+    for (int i = 0; i < threadNum; i++) {
+        threads[i]->join();
+        delete threads[i];
+    }
+    const double elapsed = VTimer::Seconds() - start;
+
+    assert(counter == threadNum * loops);
+    return counter / elapsed;
+}
+
+// Round trips between two threads handing a token over with ping and pong
+template<class Handoff>
+double pingPongRate(int rounds)
+{
+    Handoff ping;
+    Handoff pong;
+
+    const double start = VTimer::Seconds();
+    std::thread other([&]{
+        for (int i = 0; i < rounds; i++) {
+            ping.wait();
+            pong.post();
+        }
+    });
+    for (int i = 0; i < rounds; i++) {
+        ping.post();
+        pong.wait();
+    }
+    other.join();
+
+    return rounds / (VTimer::Seconds() - start);
+}
+
+template<class Signal>
+struct SignalHandoff : public Signal
+{
+    void post() { Signal::pulse(); }
+};
+
+// A producer raising a counter and a consumer waiting for every change
+template<class Mutex, class Condition>
+double conditionRate(int rounds)
+{
+    Mutex mutex;
+    Condition changed;
+    int produced = 0;
+    int consumed = 0;
+
+    const double start = VTimer::Seconds();
+    std::thread producer([&]{
+        for (int i = 0; i < rounds; i++) {
+            mutex.lock();
+            while (produced != consumed) {
+                changed.wait(&mutex);
+            }
+            produced++;
+            changed.notifyAll();
+            mutex.unlock();
+        }
+    });
+
+    mutex.lock();
+    while (consumed < rounds) {
+        while (produced == consumed) {
+            changed.wait(&mutex);
+        }
+        consumed++;
+        changed.notifyAll();
+    }
+    mutex.unlock();
+    producer.join();
+
+    return rounds / (VTimer::Seconds() - start);
+}
+
+void test()
+{
+    const int loops = 200000;
+    for (int threadNum = 1; threadNum <= 8; threadNum *= 2) {
+        const double futex = lockRate<VMutex>(threadNum, loops);
+        const double pthread = lockRate<PthreadMutex>(threadNum, loops);
+        vInfo("VMutex, " << threadNum << " thread(s): " << (long long) futex << " locks/sec, "
+              << (long long) pthread << " locks/sec with pthread");
+    }
+
+    const int rounds = 20000;
+    double futex = pingPongRate<VSemaphore>(rounds);
+    double pthread = pingPongRate<PthreadSemaphore>(rounds);
+    vInfo("VSemaphore ping-pong: " << (long long) futex << " round trips/sec, "
+          << (long long) pthread << " round trips/sec with pthread");
+
+    futex = pingPongRate<SignalHandoff<FutexSignal>>(rounds);
+    pthread = pingPongRate<SignalHandoff<PthreadSignal>>(rounds);
+    vInfo("VSignal ping-pong: " << (long long) futex << " round trips/sec, "
+          << (long long) pthread << " round trips/sec with pthread");
+
+    futex = conditionRate<VMutex, FutexCondition>(rounds);
+    pthread = conditionRate<PthreadMutex, PthreadCondition>(rounds);
+    vInfo("VWaitCondition handoff: " << (long long) futex << " round trips/sec, "
+          << (long long) pthread << " round trips/sec with pthread");
+}
+
+ADD_BENCHMARK(VMutexBenchmark, test)
+
+}
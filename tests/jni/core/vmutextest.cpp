@@ -2,6 +2,8 @@
 
 #include <VMutex.h>
 #include <VSemaphore.h>
+#include <VSignal.h>
+#include <VWaitCondition.h>
 #include <thread>
 
 NV_USING_NAMESPACE
@@ -45,7 +47,106 @@ void test()
 
         mutex.lock();
         assert(mutex.tryLock());
+        assert(mutex.lockCount() == 2);
+
+        bool locked = true;
+        std::thread other([&]{
+            locked = mutex.tryLock();
+        });
+        other.join();
+        assert(!locked);
+
+        mutex.unlock();
+        mutex.unlock();
+        assert(mutex.lockCount() == 0);
+    }
+
+    //Contention is counted
+    {
+        VMutex mutex(false);
+        mutex.lock();
+        std::thread waiter([&]{
+            mutex.lock();
+            mutex.unlock();
+        });
+        while (mutex.contendedCount() == 0) {
+            std::this_thread::yield();
+        }
+        mutex.unlock();
+        waiter.join();
+        assert(mutex.contendedCount() == 1);
+    }
+
+    //Wait condition releases a recursive mutex completely
+    {
+        VMutex mutex;
+        VWaitCondition condition;
+        bool ready = false;
+
+        mutex.lock();
+        mutex.lock();
+        std::thread notifier([&]{
+            VMutex::Locker locker(&mutex);
+            ready = true;
+            condition.notifyAll();
+        });
+        while (!ready) {
+            condition.wait(&mutex);
+        }
+        assert(mutex.lockCount() == 2);
         mutex.unlock();
+        mutex.unlock();
+        notifier.join();
+
+        mutex.lock();
+        assert(!condition.wait(&mutex, 10));
+        mutex.unlock();
+    }
+
+    //Signals
+    {
+        VSignal signal;
+        assert(!signal.wait(0));
+        assert(!signal.wait(10));
+
+        std::thread setter([&]{
+            signal.set();
+        });
+        assert(signal.wait());
+        assert(signal.wait(0));
+        setter.join();
+
+        signal.reset();
+        signal.pulse();
+        assert(signal.wait(0));
+        assert(!signal.wait(0));
+    }
+
+    {
+        // A reset while a waiter sleeps doesn't lose the next set()
+        VSignal signal;
+        std::thread setter([&]{
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            signal.reset();
+            signal.pulse();
+        });
+        assert(signal.wait(5000));
+        assert(!signal.wait(0));
+        setter.join();
+    }
+
+    {
+        // The waiter may delete the signal as soon as it returns, as
+        // ~VThreadPool does with the finished signal of its threads
+        for (int i = 0; i < 200; i++) {
+            VSignal *signal = new VSignal;
+            std::thread setter([signal]{
+                signal->set();
+            });
+            assert(signal->wait());
+            delete signal;
+            setter.join();
+        }
     }
 }
 
@@ -0,0 +1,113 @@
+#include "test.h"
+
+#include <VObjectPool.h>
+#include <VString.h>
+
+#include <set>
+#include <thread>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+struct Node
+{
+    NV_DECLARE_POOLED(Node)
+
+    Node(int value) : value(value), next(nullptr) {}
+    virtual ~Node() {}
+
+    int value;
+    Node *next;
+};
+
+struct BigNode : public Node
+{
+    BigNode() : Node(0) {}
+    char data[100];
+};
+
+struct PooledBigNode : public Node
+{
+    NV_DECLARE_POOLED(PooledBigNode)
+
+    PooledBigNode() : Node(0) {}
+    char data[100];
+};
+
+void test()
+{
+    {
+        VMemoryPool pool("Test", 12, 8, 4);
+        assert(pool.blockSize() == 16);
+
+        void *a = pool.allocate();
+        void *b = pool.allocate();
+        assert(a != b);
+        assert(reinterpret_cast<uintptr_t>(a) % 8 == 0 && reinterpret_cast<uintptr_t>(b) % 8 == 0);
+        assert(pool.liveCount() == 2 && pool.peakCount() == 2);
+
+        // A freed block is the next one handed out
+        pool.free(a);
+        assert(pool.liveCount() == 1 && pool.peakCount() == 2);
+        assert(pool.allocate() == a);
+
+        std::set<void *> blocks;
+        for (int i = 0; i < 100; i++) {
+            blocks.insert(pool.allocate());
+        }
+        assert(blocks.size() == 100 && !blocks.count(a) && !blocks.count(b));
+        assert(pool.liveCount() == 102 && pool.peakCount() == 102);
+        for (void *block : blocks) {
+            pool.free(block);
+        }
+        assert(pool.liveCount() == 2);
+
+        // Blocks freed on another thread are reused there
+        const uint slabs = pool.slabCount();
+        std::thread([&pool, a, b] {
+            pool.free(a);
+            pool.free(b);
+            void *c = pool.allocate();
+            assert(c == a || c == b);
+            pool.free(c);
+        }).join();
+        assert(pool.liveCount() == 0 && pool.slabCount() == slabs);
+    }
+
+    {
+        VObjectPool<VString> strings("Strings");
+        VString *str = strings.create(u"pooled");
+        assert(*str == u"pooled");
+        assert(strings.pool().liveCount() == 1);
+        strings.destroy(str);
+        assert(strings.pool().liveCount() == 0);
+    }
+
+    {
+        Node *first = new Node(1);
+        first->next = new Node(2);
+        assert(Node::objectPool().liveCount() == 2);
+
+        // Subclasses of another size don't use the pool
+        Node *big = new BigNode;
+        assert(Node::objectPool().liveCount() == 2);
+        delete big;
+
+        // Unless they declare a pool of their own
+        Node *pooledBig = new PooledBigNode;
+        assert(Node::objectPool().liveCount() == 2);
+        assert(PooledBigNode::objectPool().liveCount() == 1);
+        delete pooledBig;
+        assert(PooledBigNode::objectPool().liveCount() == 0);
+
+        delete first->next;
+        delete first;
+        assert(Node::objectPool().liveCount() == 0);
+        assert(Node::objectPool().peakCount() == 2);
+    }
+}
+
+ADD_TEST(VObjectPool, test)
+
+}
@@ -0,0 +1,111 @@
+#include "test.h"
+
+#include <VSmallArray.h>
+#include <VString.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// Counts the live instances to catch leaked or doubly destroyed elements
+struct Counted
+{
+    static int alive;
+
+    Counted(int value = 0) : value(value) { alive++; }
+    Counted(const Counted &source) : value(source.value) { alive++; }
+    Counted &operator = (const Counted &source) { value = source.value; return *this; }
+    ~Counted() { alive--; }
+
+    bool operator == (const Counted &other) const { return value == other.value; }
+
+    int value;
+};
+
+int Counted::alive = 0;
+
+void test()
+{
+    {
+        VSmallArray<int, 4> array;
+        assert(array.isEmpty() && array.isInline());
+        array << 1 << 2 << 3 << 4;
+        assert(array.isInline());
+        assert(array.length() == 4 && array.capacity() == 4);
+
+        // Spills to the heap
+        array.append(5);
+        assert(!array.isInline());
+        assert(array.length() == 5 && array.capacity() == 8);
+        assert(array.first() == 1 && array.last() == 5);
+
+        array.prepend(0);
+        assert(array.indexOf(0) == 0 && array.indexOf(5) == 5);
+        array.removeAt(1);
+        assert(array.indexOf(1) == -1 && array[1] == 2);
+        array << 2 << 2;
+        array.removeAll(2);
+        assert(array.length() == 4 && !array.contains(2));
+        array.removeOne(3);
+        array.removeAtUnordered(0);
+        assert(array.length() == 2 && array[0] == 5 && array[1] == 4);
+
+        int sum = 0;
+        for (int i : array) {
+            sum += i;
+        }
+        assert(sum == 9);
+
+        // Appending an element of the array itself while it grows
+        VSmallArray<int, 2> self;
+        self << 7 << 8;
+        self.append(self[0]);
+        assert(self.length() == 3 && self[2] == 7);
+    }
+
+    {
+        VSmallArray<Counted, 2> inlined;
+        inlined << Counted(1) << Counted(2);
+        assert(Counted::alive == 2);
+
+        VSmallArray<Counted, 2> spilled;
+        for (int i = 0; i < 10; i++) {
+            spilled.append(Counted(i));
+        }
+        assert(Counted::alive == 12);
+
+        // Moving an inline array moves its elements, a spilled one its block
+        VSmallArray<Counted, 2> moved(std::move(inlined));
+        assert(inlined.isEmpty() && moved.length() == 2 && moved[1].value == 2);
+        const Counted *block = spilled.data();
+        VSmallArray<Counted, 2> stolen(std::move(spilled));
+        assert(spilled.isEmpty() && spilled.isInline());
+        assert(stolen.data() == block && stolen.length() == 10);
+        assert(Counted::alive == 12);
+
+        VSmallArray<Counted, 2> copy(stolen);
+        assert(copy.length() == 10 && copy[9].value == 9);
+        copy = moved;
+        assert(copy.length() == 2 && copy[0].value == 1);
+        assert(Counted::alive == 14);
+
+        copy.resize(5);
+        assert(copy[4].value == 0);
+        copy.clear();
+        assert(Counted::alive == 12);
+    }
+    assert(Counted::alive == 0);
+
+    {
+        VSmallArray<VString, 2> strings;
+        strings << "one" << "two" << "three";
+        VSmallArray<VString, 2> other;
+        other = std::move(strings);
+        assert(other.length() == 3 && other[2] == "three");
+        assert(strings.isEmpty());
+    }
+}
+
+ADD_TEST(VSmallArray, test)
+
+}
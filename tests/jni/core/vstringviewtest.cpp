@@ -0,0 +1,125 @@
+#include "test.h"
+
+#include <VStringView.h>
+#include <VStringHash.h>
+#include <VPath.h>
+#include <VJson.h>
+
+#include <sstream>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VByteArrayView view("res/raw/sound.wav");
+        assert(view.size() == 17);
+        assert(view.startsWith("res/") && view.endsWith(".wav"));
+        assert(!view.startsWith("raw"));
+        assert(view.indexOf('/') == 3 && view.lastIndexOf('/') == 7);
+        assert(view.mid(8) == "sound.wav");
+        assert(view.left(3) == "res" && view.right(3) == "wav");
+        assert(view.compare("res") > 0 && view.compare("ret") < 0);
+
+        VByteArray bytes("sound");
+        assert(VByteArrayView(bytes) == "sound");
+        assert(VByteArrayView(bytes).data() == bytes.data());
+    }
+
+    {
+        VString str("assets/background.jpg");
+        VStringView view(str);
+        assert(view.data() == str.data() && view.size() == str.size());
+        assert(view.endsWith(u".jpg") && !view.endsWith(u".png"));
+        assert(view.mid(7) == "background.jpg");
+        assert(view == "assets/background.jpg" && view != "assets");
+        assert(view.icompare("ASSETS/Background.JPG") == 0);
+        assert(view.compare(VStringView(u"assets/background.jpg")) == 0);
+        assert(view.toString() == str);
+    }
+
+    {
+        // Encoded without allocating, and measured when it does not fit
+        VString str(u"\u4f60\u597d, VR \U0001f600");
+        const VByteArray utf8 = str.toUtf8();
+        assert(utf8 == "\xe4\xbd\xa0\xe5\xa5\xbd, VR \xf0\x9f\x98\x80");
+
+        char buffer[32];
+        const uint length = VStringView(str).toUtf8(buffer, sizeof(buffer));
+        assert(length == utf8.size());
+        assert(VByteArrayView(buffer, length) == utf8);
+
+        char tiny[4] = {'x', 'x', 'x', 'x'};
+        assert(VStringView(str).toUtf8(tiny, 3) == utf8.size());
+        assert(tiny[3] == 'x');
+
+        std::stringstream out;
+        out << VStringView(str) << VByteArrayView("!");
+        assert(out.str() == utf8 + "!");
+    }
+
+    {
+        VNativePath native(VStringView(u"/sdcard/Oculus/sound_assets.json"));
+        assert(strcmp(native, "/sdcard/Oculus/sound_assets.json") == 0);
+
+        VByteArray longPath(2000, 'a');
+        const VString longString(longPath);
+        VNativePath longNative((VStringView(longString)));
+        assert(strlen(longNative) == 2000);
+        VNativePath bytes(VByteArrayView("abc", 2));
+        assert(strcmp(bytes, "ab") == 0);
+    }
+
+    {
+        VStringCaseHash<int> entries;
+        entries.insert("res/raw/Sound.wav", 1);
+        entries.insert("assets/background.jpg", 2);
+        const char *name = "res/raw/sound.wav!";
+        assert(entries.value(VByteArrayView(name, 17)) == 1);
+        assert(!entries.contains(VByteArrayView(name, 16)));
+        VString key("ASSETS/BACKGROUND.JPG");
+        assert(entries.value(VStringView(key)) == 2);
+
+        VStringHash<int> exact;
+        exact.insert("Sound", 3);
+        assert(exact.contains(VByteArrayView("Sound")));
+        assert(!exact.contains(VByteArrayView("sound")));
+    }
+
+    {
+        VJsonObject object;
+        object.insert("alpha", 1);
+        object.insert("beta", 2);
+        object.insert("gamma", 3);
+        VJson json(object);
+        assert(json.value("beta").toInt() == 2);
+        assert(json.value(VByteArrayView("gamma")).toInt() == 3);
+        assert(json.value(VStringView(VString("alpha"))).toInt() == 1);
+        assert(json.contains("alpha") && !json.contains("alph") && !json.contains("delta"));
+        assert(json.value("zeta").isNull());
+    }
+
+    {
+        // Non-ASCII views hold UTF-8 and must meet the decoded text
+        const char *utf8 = "caf\xc3\xa9";
+        VString decoded = VString::fromUtf8(utf8);
+        VStringView view(decoded);
+        assert(view.compare(VByteArrayView(utf8)) == 0);
+        assert(view.icompare(VByteArrayView("CAF\xc3\xa9")) == 0);
+        assert(view == VByteArrayView(utf8));
+        assert(view.compare(VByteArrayView("caf\xe9")) != 0);
+
+        VJsonObject object;
+        object.insert(decoded, 7);
+        VJson json(object);
+        assert(json.value(VByteArrayView(utf8)).toInt() == 7);
+        assert(json.contains(VByteArrayView(utf8)));
+        assert(!json.contains(VByteArrayView("caf\xe9")));
+    }
+}
+
+ADD_TEST(VStringView, test)
+
+}
@@ -0,0 +1,84 @@
+#include "test.h"
+
+#include <VArray.h>
+#include <VThreadPool.h>
+#include <VSemaphore.h>
+
+#include <atomic>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VThreadPool pool(4);
+        assert(pool.workerCount() == 4);
+
+        std::future<int> answer = pool.submit([]{
+            return 42;
+        });
+        assert(answer.get() == 42);
+    }
+
+    {
+        VThreadPool pool(3);
+        VSemaphore done;
+        std::atomic<int> count(0);
+        for (int i = 0; i < 1000; i++) {
+            pool.run([&]{
+                count++;
+                done.post();
+            });
+        }
+        for (int i = 0; i < 1000; i++) {
+            done.wait();
+        }
+        assert(count == 1000);
+    }
+
+    {
+        VThreadPool pool(4);
+        VArray<int> values;
+        values.resize(10000);
+        pool.parallelFor(0, values.length(), [&](int i) {
+            values[i] = i * 2;
+        }, 64);
+        for (int i = 0; i < values.length(); i++) {
+            assert(values[i] == i * 2);
+        }
+    }
+
+    {
+        // Nested parallelFor must not dead-lock even with a single worker
+        VThreadPool pool(1);
+        std::atomic<int> sum(0);
+        pool.parallelFor(0, 8, [&](int i) {
+            pool.parallelFor(0, 100, [&](int j) {
+                sum += i * 100 + j;
+            });
+        });
+        assert(sum == 800 * 799 / 2);
+    }
+
+    {
+        // Queued tasks are finished before the pool is destroyed
+        std::atomic<int> count(0);
+        {
+            VThreadPool pool(2);
+            for (int i = 0; i < 100; i++) {
+                pool.run([&]{
+                    count++;
+                });
+            }
+        }
+        assert(count == 100);
+    }
+
+    assert(VThreadPool::instance()->workerCount() == VThread::CpuCount());
+}
+
+ADD_TEST(VThreadPool, test)
+
+}
@@ -0,0 +1,91 @@
+#include "test.h"
+
+#include <VSemaphore.h>
+#include <VThread.h>
+#include <VTimer.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+struct Worker
+{
+    VSemaphore started;
+    VSemaphore stop;
+    int systemId;
+};
+
+int work(void *data)
+{
+    Worker *worker = static_cast<Worker *>(data);
+    worker->systemId = VThread::currentThreadSystemId();
+
+    // Burn some user time to show up in the stats
+    const double end = VTimer::Seconds() + 0.05;
+    while (VTimer::Seconds() < end) {
+    }
+
+    worker->started.post();
+    worker->stop.wait();
+    return 0;
+}
+
+void test()
+{
+    const int cpuCount = VThread::CpuCount();
+    const uint allCores = cpuCount >= 32 ? ~0u : (1u << cpuCount) - 1;
+    const uint bigCores = VThread::BigCoreMask();
+    assert(bigCores != 0);
+    assert((bigCores & ~allCores) == 0);
+
+    Worker worker;
+    VThread thread(work, &worker);
+    assert(thread.systemId() == 0);
+    assert(thread.cpuStats().lastCpu == -1);
+
+    // Applied once the thread runs
+    assert(thread.setAffinity(1));
+    assert(thread.affinity() == 1);
+    assert(thread.start());
+    worker.started.wait();
+
+    assert(thread.systemId() == worker.systemId);
+    assert(thread.systemId() != VThread::currentThreadSystemId());
+    assert(thread.affinity() == 1);
+
+    const VThread::CpuStats stats = thread.cpuStats();
+    assert(stats.lastCpu == 0);
+    assert(stats.userTime + stats.systemTime > 0.0);
+    assert(stats.voluntarySwitches + stats.involuntarySwitches > 0);
+
+    // Also changes a running thread
+    assert(thread.setAffinity(allCores));
+    assert(thread.affinity() == allCores);
+
+    // Realtime needs a privilege, the fallback keeps the thread running
+    thread.setRealtime(VThread::FifoScheduling, 1);
+    assert(thread.cpuStats().lastCpu >= 0);
+
+    worker.stop.post();
+    assert(thread.wait());
+
+    // A mask set while the thread starts is neither lost nor reverted
+    Worker starting;
+    VThread late(work, &starting);
+    assert(late.affinity() == allCores);
+    assert(late.start());
+    assert(late.setAffinity(1));
+    starting.started.wait();
+    assert(late.affinity() == 1);
+    starting.stop.post();
+    assert(late.wait());
+
+    // Threads of our own process which are not VThreads
+    const VThread::CpuStats current = VThread::GetCpuStats(VThread::currentThreadSystemId());
+    assert(current.lastCpu >= 0);
+    assert(VThread::GetCpuStats(-1).lastCpu == -1);
+}
+
+ADD_TEST(VThread, test)
+
+}
@@ -0,0 +1,93 @@
+#include "test.h"
+
+#include <VTimerWheel.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VTimerWheel<int> wheel(100);
+        assert(wheel.isEmpty());
+        assert(wheel.nextTick() == ULLONG_MAX);
+
+        wheel.insert(105, 1);
+        wheel.insert(300, 2);
+        wheel.insert(50, 0);
+        assert(wheel.size() == 3);
+        assert(wheel.nextTick() == 50);
+
+        VArray<int> fired;
+        auto output = [&](int value) {
+            fired.append(value);
+        };
+
+        wheel.advance(104, output);
+        assert(fired.length() == 1 && fired[0] == 0);
+        assert(wheel.nextTick() == 105);
+
+        wheel.advance(299, output);
+        assert(fired.length() == 2 && fired[1] == 1);
+        assert(wheel.nextTick() == 300);
+
+        wheel.advance(300, output);
+        assert(fired.length() == 3 && fired[2] == 2);
+        assert(wheel.isEmpty());
+    }
+
+    {
+        // An idle wheel catches up on insertion, one holding timers doesn't
+        VTimerWheel<int> wheel(0);
+        wheel.insert(1000010, 1, 1000000);
+        assert(wheel.currentTick() == 1000000);
+        wheel.insert(1000005, 2, 1000003);
+        assert(wheel.currentTick() == 1000000);
+        wheel.insert(10, 3, 1000004);
+        assert(wheel.nextTick() == 10);
+
+        VArray<int> fired;
+        wheel.advance(1000005, [&](int value) {
+            fired.append(value);
+        });
+        assert(fired.length() == 2 && fired[0] == 3 && fired[1] == 2);
+        assert(wheel.nextTick() == 1000010);
+    }
+
+    {
+        // Deadlines spread across every level and the overflow list
+        VTimerWheel<ulonglong> wheel(12345);
+        VArray<ulonglong> ticks;
+        for (int i = 0; i < 2000; i++) {
+            ulonglong tick = 12345 + (rand() % 4096);
+            if (i % 4 == 1) {
+                tick += rand() % (1 << 18);
+            } else if (i % 4 == 2) {
+                tick += (ulonglong) rand() % (1 << 26);
+            }
+            ticks.append(tick);
+            wheel.insert(tick, tick);
+        }
+
+        ulonglong now = 12345;
+        ulonglong previous = 0;
+        int fired = 0;
+        while (!wheel.isEmpty()) {
+            const ulonglong next = wheel.nextTick();
+            assert(next >= now);
+            now = next + rand() % 3;
+            wheel.advance(now, [&](ulonglong tick) {
+                assert(tick <= now);
+                assert(tick >= previous);
+                previous = tick;
+                fired++;
+            });
+        }
+        assert(fired == ticks.length());
+    }
+}
+
+ADD_TEST(VTimerWheel, test)
+
+}
@@ -0,0 +1,181 @@
+#include "test.h"
+
+#include <VString.h>
+#include <VTimer.h>
+#include <VArray.h>
+
+#include <algorithm>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// The transcoders VString used to have, kept as a baseline
+
+VByteArray ScalarToUtf8(const VString &str)
+{
+    VByteArray utf8;
+    uint code = 0;
+    for (const char16_t &in : str) {
+        if (in >= 0xd800 && in <= 0xdbff) {
+            code = ((in - 0xd800) << 10) + 0x10000;
+        } else {
+            if (in >= 0xdc00 && in <= 0xdfff) {
+                code |= in - 0xdc00;
+            } else {
+                code = in;
+            }
+
+            if (code <= 0x7f) {
+                utf8.append(static_cast<char>(code));
+            } else if (code <= 0x7ff) {
+                utf8.append(static_cast<char>(0xc0 | ((code >> 6) & 0x1f)));
+                utf8.append(static_cast<char>(0x80 | (code & 0x3f)));
+            } else if (code <= 0xffff) {
+                utf8.append(static_cast<char>(0xe0 | ((code >> 12) & 0x0f)));
+                utf8.append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                utf8.append(static_cast<char>(0x80 | (code & 0x3f)));
+            } else {
+                utf8.append(static_cast<char>(0xf0 | ((code >> 18) & 0x07)));
+                utf8.append(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+                utf8.append(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                utf8.append(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+            code = 0;
+        }
+    }
+    return utf8;
+}
+
+VString ScalarFromUtf8(const VByteArray &utf8)
+{
+    VString utf16;
+    uint code = 0;
+    int following = 0;
+    for (uchar ch : utf8) {
+        if (ch <= 0x7f) {
+            code = ch;
+            following = 0;
+        } else if (ch <= 0xbf) {
+            if (following > 0) {
+                code = (code << 6) | (ch & 0x3f);
+                --following;
+            }
+        } else if (ch <= 0xdf) {
+            code = ch & 0x1f;
+            following = 1;
+        } else if (ch <= 0xef) {
+            code = ch & 0x0f;
+            following = 2;
+        } else {
+            code = ch & 0x07;
+            following = 3;
+        }
+
+        if (following == 0) {
+            if (code > 0xffff) {
+                utf16.append(static_cast<char16_t>(0xd800 + (code >> 10)));
+                utf16.append(static_cast<char16_t>(0xdc00 + (code & 0x03ff)));
+            } else {
+                utf16.append(static_cast<char16_t>(code));
+            }
+            code = 0;
+        }
+    }
+    return utf16;
+}
+
+// Megabytes of UTF-8 produced or consumed per second, the best of a few runs
+template<class Convert>
+double rate(const Convert &convert, uint bytes, int loops)
+{
+    double best = 0.0;
+    for (int run = 0; run < 5; run++) {
+        const double start = VTimer::Seconds();
+        uint sink = 0;
+        for (int i = 0; i < loops; i++) {
+            sink += convert();
+        }
+        const double elapsed = VTimer::Seconds() - start;
+        assert(sink > 0);
+        best = std::max(best, bytes * (double) loops / elapsed / 1e6);
+    }
+    return best;
+}
+
+void measure(const char *name, const VArray<VString> &texts, int loops)
+{
+    VArray<VByteArray> utf8;
+    uint bytes = 0;
+    for (const VString &text : texts) {
+        utf8.append(text.toUtf8());
+        assert(ScalarToUtf8(text) == utf8.last());
+        bytes += utf8.last().size();
+    }
+
+    const double toVector = rate([&]{
+        uint size = 0;
+        for (const VString &text : texts) {
+            size += text.toUtf8().size();
+        }
+        return size;
+    }, bytes, loops);
+    const double toScalar = rate([&]{
+        uint size = 0;
+        for (const VString &text : texts) {
+            size += ScalarToUtf8(text).size();
+        }
+        return size;
+    }, bytes, loops);
+    const double fromVector = rate([&]{
+        uint size = 0;
+        for (const VByteArray &text : utf8) {
+            size += VString::fromUtf8(text).size();
+        }
+        return size;
+    }, bytes, loops);
+    const double fromScalar = rate([&]{
+        uint size = 0;
+        for (const VByteArray &text : utf8) {
+            size += ScalarFromUtf8(text).size();
+        }
+        return size;
+    }, bytes, loops);
+
+    vInfo(name << " toUtf8: " << (int) toVector << " MB/s, " << (int) toScalar << " MB/s before");
+    vInfo(name << " fromUtf8: " << (int) fromVector << " MB/s, " << (int) fromScalar << " MB/s before");
+}
+
+void test()
+{
+    // Long texts, and names as short as the paths and JSON keys most
+    // conversions are made for
+    VArray<VString> ascii;
+    VArray<VString> cjk;
+    VArray<VString> mixed;
+    VArray<VString> names;
+    ascii.resize(1);
+    cjk.resize(1);
+    mixed.resize(1);
+    const char16_t *word = u"虚拟现实";
+    for (int i = 0; i < 4096; i++) {
+        ascii[0].append(char16_t('a' + i % 26));
+        cjk[0].append(word[i % 4]);
+        // A path with the odd localized name in it
+        mixed[0].append(i % 64 < 56 ? char16_t('a' + i % 26) : word[i % 4]);
+        if (i % 32 == 0) {
+            names.append(VString());
+        }
+        names.last().append(i % 32 < 24 ? char16_t('a' + i % 26) : word[i % 4]);
+    }
+
+    const int loops = 400;
+    measure("ASCII", ascii, loops);
+    measure("CJK", cjk, loops);
+    measure("Mixed", mixed, loops);
+    measure("Names", names, loops);
+}
+
+ADD_BENCHMARK(VUnicodeBenchmark, test)
+
+}
@@ -0,0 +1,75 @@
+#include "test.h"
+
+#include <VUnicode.h>
+#include <VString.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+VString Decode(const char *utf8)
+{
+    return VString::fromUtf8(utf8, strlen(utf8));
+}
+
+void test()
+{
+    {
+        // Every length around the 16-unit blocks, with the odd character
+        // before, inside and after them
+        for (int size = 0; size < 48; size++) {
+            for (int at = -1; at < size; at++) {
+                VString str;
+                for (int i = 0; i < size; i++) {
+                    str.append(char16_t(i == at ? 0x4f60 : 'a' + i % 26));
+                }
+                const VByteArray utf8 = str.toUtf8();
+                assert(utf8.size() == (uint) size + (at >= 0 ? 2 : 0));
+                assert(VString::fromUtf8(utf8) == str);
+            }
+        }
+    }
+
+    {
+        // One, two, three and four bytes
+        const VString str(u"aé你\U0001f600z");
+        const VByteArray utf8 = str.toUtf8();
+        assert(utf8 == "a\xc3\xa9\xe4\xbd\xa0\xf0\x9f\x98\x80z");
+        assert(VUnicode::Utf8Length(str.data(), str.size()) == utf8.size());
+        assert(VUnicode::Utf16Length(utf8.data(), utf8.size()) == str.size());
+        assert(VString::fromUtf8(utf8) == str);
+        assert(VUnicode::IsValidUtf8(utf8.data(), utf8.size()));
+    }
+
+    {
+        // Each malformed subsequence becomes one U+FFFD
+        assert(Decode("a\x80z") == u"a�z");
+        assert(Decode("\xc0\xaf") == u"��");
+        assert(Decode("\xe0\x80\xaf") == u"���");
+        assert(Decode("\xed\xa0\x80") == u"���");
+        assert(Decode("\xf4\x90\x80\x80") == u"����");
+        assert(Decode("\xe4\xbd") == u"�");
+        assert(Decode("\xe4\xbdz") == u"�z");
+        assert(Decode("\xf0\x9f\x98") == u"�");
+        assert(Decode("\xff") == u"�");
+
+        const char *invalid = "0123456789abcdef\xe4\xbd";
+        assert(!VUnicode::IsValidUtf8(invalid, strlen(invalid)));
+        assert(VUnicode::IsValidUtf8(invalid, 16));
+    }
+
+    {
+        // Unpaired surrogates become U+FFFD
+        const VString highOnly(u"a\xd83d" u"b");
+        assert(highOnly.toUtf8() == "a\xef\xbf\xbd" "b");
+        const VString lowOnly(u"\xde00");
+        assert(lowOnly.toUtf8() == "\xef\xbf\xbd");
+        const VString reversed(u"\xde00\xd83d");
+        assert(VUnicode::Utf8Length(reversed.data(), reversed.size()) == 6);
+        assert(reversed.toUtf8() == "\xef\xbf\xbd\xef\xbf\xbd");
+    }
+}
+
+ADD_TEST(VUnicode, test)
+
+}
@@ -0,0 +1,155 @@
+#include "test.h"
+
+#include <VVariant.h>
+#include <VTimer.h>
+
+#include <algorithm>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+// The layout VVariant used to have, every string and closure in its own
+// allocation, kept as a baseline
+class BoxedVariant
+{
+public:
+    typedef std::function<void()> Function;
+
+    BoxedVariant() : m_type(VVariant::Null) {}
+    BoxedVariant(int value) : m_type(VVariant::Int) { m_value.decimal = value; }
+    BoxedVariant(const char *str) : m_type(VVariant::String) { m_value.str = new VString(str); }
+    BoxedVariant(const Function &function) : m_type(VVariant::Closure) { m_value.function = new Function(function); }
+
+    BoxedVariant(const BoxedVariant &source) : m_type(VVariant::Null) { *this = source; }
+
+    BoxedVariant(BoxedVariant &&source)
+        : m_type(source.m_type)
+        , m_value(source.m_value)
+    {
+        source.m_type = VVariant::Null;
+    }
+
+    ~BoxedVariant() { release(); }
+
+    BoxedVariant &operator=(const BoxedVariant &source)
+    {
+        release();
+        m_type = source.m_type;
+        if (m_type == VVariant::String) {
+            m_value.str = new VString(*source.m_value.str);
+        } else if (m_type == VVariant::Closure) {
+            m_value.function = new Function(*source.m_value.function);
+        } else {
+            m_value = source.m_value;
+        }
+        return *this;
+    }
+
+    BoxedVariant &operator=(BoxedVariant &&source)
+    {
+        release();
+        m_type = source.m_type;
+        m_value = source.m_value;
+        source.m_type = VVariant::Null;
+        return *this;
+    }
+
+    bool isClosure() const { return m_type == VVariant::Closure; }
+    bool isString() const { return m_type == VVariant::String; }
+    int toInt() const { return m_value.decimal; }
+    uint size() const { return m_value.str->size(); }
+    void execute() const { (*m_value.function)(); }
+
+private:
+    void release()
+    {
+        if (m_type == VVariant::String) {
+            delete m_value.str;
+        } else if (m_type == VVariant::Closure) {
+            delete m_value.function;
+        }
+    }
+
+    VVariant::Type m_type;
+    union
+    {
+        int decimal;
+        VString *str;
+        Function *function;
+    } m_value;
+};
+
+// What an event loop does with a payload: copied in by post(), moved out
+// by next(), read and dropped by the handler
+template<class Variant>
+double measure(const Variant payloads[4], int loops)
+{
+    const int slotNum = 256;
+    Variant *slots = new Variant[slotNum];
+
+    double best = 0.0;
+    for (int run = 0; run < 5; run++) {
+        uint sink = 0;
+        const double start = VTimer::Seconds();
+        for (int i = 0; i < loops; i++) {
+            for (int j = 0; j < slotNum; j++) {
+                slots[j] = payloads[(i + j) & 3];
+            }
+            for (int j = 0; j < slotNum; j++) {
+                const Variant data = std::move(slots[j]);
+                if (data.isClosure()) {
+                    data.execute();
+                    sink++;
+                } else if (data.isString()) {
+                    sink += data.size();
+                } else {
+                    sink += data.toInt();
+                }
+            }
+        }
+        const double elapsed = VTimer::Seconds() - start;
+        assert(sink > 0);
+        best = std::max(best, loops * slotNum / elapsed);
+    }
+
+    delete[] slots;
+    return best;
+}
+
+template<class Variant>
+void fill(Variant payloads[5][4], uint *counter)
+{
+    // An index, a short command argument, a path and a small closure
+    const Variant kinds[4] = {Variant(42), Variant("loaded pano"),
+            Variant("/sdcard/Oculus/360Photos/sunset.jpg"), Variant([counter]{ (*counter)++; })};
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            payloads[i][j] = kinds[i];
+        }
+        payloads[4][i] = kinds[i];
+    }
+}
+
+void test()
+{
+    uint calls = 0;
+    VVariant inlined[5][4];
+    BoxedVariant boxed[5][4];
+    fill(inlined, &calls);
+    fill(boxed, &calls);
+
+    const char *names[5] = {"Int", "Short string", "Long string", "Closure", "Mixed"};
+    const int loops = 2000;
+    for (int i = 0; i < 5; i++) {
+        const double inlineRate = measure(inlined[i], loops);
+        const double boxedRate = measure(boxed[i], loops);
+        vInfo(names[i] << " payloads: " << (long long) inlineRate << " events/sec, "
+              << (long long) boxedRate << " events/sec boxed");
+    }
+    assert(calls > 0);
+}
+
+ADD_BENCHMARK(VVariantBenchmark, test)
+
+}
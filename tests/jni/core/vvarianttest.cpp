@@ -120,6 +120,52 @@ void test()
         assert(var.value("fang").toInt() == 1994);
         assert(var.value("yun").toInt() == var.value("zhe").toInt());
     }
+
+    {
+        // Short strings are kept in the variant, long ones in a VString
+        VVariant shortString("loaded pano");
+        VVariant longString(VString("a string too long to be kept inline"));
+        assert(shortString.toString() == "loaded pano" && shortString.length() == 11);
+        assert(longString.toString() == "a string too long to be kept inline");
+        assert(shortString.toStringView() == "loaded pano");
+        assert(VVariant(VString()).toString().isEmpty() && !VVariant("").toBool());
+
+        VVariant copy(shortString);
+        copy = longString;
+        assert(copy.toStringView() == longString.toStringView());
+        assert(copy.toStringView().data() != longString.toStringView().data());
+        copy = copy;
+        assert(copy.toString() == longString.toString());
+
+        const char16_t *units = longString.toStringView().data();
+        VVariant moved(std::move(longString));
+        assert(longString.isNull());
+        assert(moved.toStringView().data() == units);
+
+        moved = std::move(shortString);
+        assert(moved.toString() == "loaded pano" && shortString.isNull());
+    }
+
+    {
+        int calls = 0;
+        VVariant closure([&calls]{
+            calls++;
+        });
+        VVariant copy(closure);
+        VVariant moved(std::move(closure));
+        copy();
+        moved();
+        assert(calls == 2 && closure.isNull());
+
+        VVariantMap map;
+        map["ipd"] = 0.064;
+        VVariant var(map);
+        VVariant other;
+        other = var;
+        other["ipd"] = 0.06;
+        assert(var.value("ipd").toDouble() == 0.064);
+        assert(other.value("ipd").toDouble() == 0.06);
+    }
 }
 
 ADD_TEST(VVariant, test)
@@ -40,7 +40,12 @@ void test()
         assert(data == str);
     }
 
+    assert(VFile::Exists("test.txt"));
+    assert(VFile::IsReadable(VString("test.txt")));
+    assert(!VFile::Exists(VByteArrayView("test.txt", 6)));
+
     remove("test.txt");
+    assert(!VFile::Exists("test.txt"));
 
     {
         char bytes[1024];
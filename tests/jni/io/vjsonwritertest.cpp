@@ -0,0 +1,83 @@
+#include "test.h"
+
+#include <VBuffer.h>
+#include <VJson.h>
+#include <VJsonWriter.h>
+
+NV_USING_NAMESPACE
+
+namespace {
+
+void test()
+{
+    {
+        VBuffer buffer;
+        {
+            VJsonWriter writer(&buffer);
+            writer.startObject();
+            writer.writeKey("name");
+            writer.writeString("say \"hi\" \\ bye");
+            writer.writeKey(VString(u"values"));
+            writer.startArray();
+            writer.writeNumber(1);
+            writer.writeNumber(0.1);
+            writer.writeNumber(-2.5e-10);
+            writer.writeBool(true);
+            writer.writeNull();
+            writer.startObject();
+            writer.endObject();
+            writer.endArray();
+            writer.endObject();
+        }
+        VByteArray json = buffer.readAll();
+        assert(json == "{\"name\":\"say \\\"hi\\\" \\\\ bye\",\"values\":[1,0.1,-2.5e-10,true,null,{}]}");
+
+        // Reads back the same
+        VJson parsed = VJson::Parse(json);
+        assert(parsed.value("name").toString() == u"say \"hi\" \\ bye");
+        assert(parsed.value("values").at(1).toDouble() == 0.1);
+        assert(parsed.value("values").at(2).toDouble() == -2.5e-10);
+    }
+
+    {
+        // Control characters are escaped
+        VBuffer buffer;
+        {
+            VJsonWriter writer(&buffer);
+            writer.writeString(VByteArrayView("a\nb\tc\r\b\f\x01\x1f", 10));
+        }
+        VByteArray json = buffer.readAll();
+        assert(json == "\"a\\nb\\tc\\r\\b\\f\\u0001\\u001f\"");
+        assert(VJson::Parse(VByteArray("[") + json + "]").at(0).toStdString() == "a\nb\tc\r\b\f\x01\x1f");
+    }
+
+    {
+        // A whole tree, larger than the write buffer
+        VJsonArray array;
+        for (int i = 0; i < 1000; i++) {
+            VJsonObject object;
+            object.insert("index", i);
+            object.insert("third", i / 3.0);
+            object.insert(VString(u"いつも"), VString(u"好きです"));
+            array.append(std::move(object));
+        }
+        const VJson tree(std::move(array));
+
+        VBuffer buffer;
+        VJsonWriter writer(&buffer);
+        writer.write(tree);
+        assert(writer.flush());
+
+        const VJson parsed = VJson::Parse(buffer.readAll());
+        assert(parsed.size() == 1000);
+        for (int i = 0; i < 1000; i++) {
+            assert(parsed[i].value("index").toInt() == i);
+            assert(parsed[i].value("third").toDouble() == i / 3.0);
+            assert(parsed[i].value(u"いつも").toString() == u"好きです");
+        }
+    }
+}
+
+ADD_TEST(VJsonWriter, test)
+
+}
@@ -1,5 +1,6 @@
 #include "test.h"
 
+#include <string.h>
 #include <time.h>
 #include <iostream>
 
@@ -12,7 +13,13 @@ list<TestUnit> &Tests()
     return tests;
 }
 
-int main()
+list<TestUnit> &Benchmarks()
+{
+    static list<TestUnit> benchmarks;
+    return benchmarks;
+}
+
+static int run(bool benchmark)
 {
     vInfo("NervGear Test");
     vInfo("======================");
@@ -25,12 +32,32 @@ int main()
         vInfo(test.name << " has been tested.");
     }
 
+    if (benchmark) {
+        const list<TestUnit> &benchmarks = Benchmarks();
+        for (const TestUnit &test : benchmarks) {
+            vInfo("Benchmarking " << test.name << " ...");
+            (*test.function)();
+            vInfo(test.name << " has been benchmarked.");
+        }
+    }
+
     vInfo("======================");
     vInfo("Everything works fine!");
 
     return 0;
 }
 
+int main(int argc, char *argv[])
+{
+    bool benchmark = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        }
+    }
+    return run(benchmark);
+}
+
 #ifdef ANDROID
 
 #include <jni.h>
@@ -38,12 +65,12 @@ int main()
 extern "C" {
     jint Java_com_vrseen_unittest_MainActivity_exec(JNIEnv *, jclass, jobject)
     {
-        return main();
+        return run(false);
     }
 
     jint Java_com_vrseen_SourceTest_exec(JNIEnv *, jclass, jobject)
     {
-        return main();
+        return run(false);
     }
 }
 
@@ -45,9 +45,23 @@ void test()
     }
 
     {
+        // Copies share the pixels until one of them changes
         VImage image2 = image;
-        assert(image2.data() != image.data());
+        assert(image2.data() == image.data());
         assert(image2 == image);
+
+        const uchar *shared = image.data();
+        image2.resize(2, 2);
+        assert(image2.width() == 2 && image.width() == 1);
+        assert(image.data() == shared);
+        assert(image2.data() != shared);
+
+        VImage image3;
+        assert(!image3.isValid());
+        image3 = image;
+        assert(image3.data() == shared);
+        image3 = image2;
+        assert(image3.data() == image2.data());
     }
     assert(image.isValid());
 
@@ -56,6 +70,7 @@ void test()
         const uchar *data = image2.data();
         VImage image3 = std::move(image2);
         assert(data == image3.data());
+        assert(!image2.isValid());
 
         uchar *raw = (uchar *) malloc(image3.length());
         memcpy(raw, image3.data(), image3.length());
@@ -28,6 +28,8 @@ struct TestUnit
 };
 
 std::list<TestUnit> &Tests();
+// Timed runs, which only run when the test binary is given --benchmark
+std::list<TestUnit> &Benchmarks();
 
 #define ADD_TEST(name, test) namespace {\
     struct TestAdder\
@@ -39,3 +41,14 @@ std::list<TestUnit> &Tests();
     };\
     TestAdder adder;\
 }
+
+#define ADD_BENCHMARK(name, test) namespace {\
+    struct BenchmarkAdder\
+    {\
+        BenchmarkAdder()\
+        {\
+            Benchmarks().push_back(TestUnit(#name, test));\
+        }\
+    };\
+    BenchmarkAdder adder;\
+}
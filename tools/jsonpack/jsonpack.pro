@@ -0,0 +1,29 @@
+TEMPLATE = app
+TARGET = jsonpack
+CONFIG += console c++11
+CONFIG -= app_bundle
+CONFIG -= qt
+
+NV_ROOT = $$PWD/../../source/jni
+
+INCLUDEPATH += \
+    $$NV_ROOT \
+    $$NV_ROOT/core
+
+# Only what JSON, MessagePack and their strings need, the rest of core is
+# written for Android and doesn't build on the host
+SOURCES += \
+    $$NV_ROOT/core/VAtom.cpp \
+    $$NV_ROOT/core/VByteArray.cpp \
+    $$NV_ROOT/core/VChar.cpp \
+    $$NV_ROOT/core/VFrameArena.cpp \
+    $$NV_ROOT/core/VJson.cpp \
+    $$NV_ROOT/core/VJsonReader.cpp \
+    $$NV_ROOT/core/VLog.cpp \
+    $$NV_ROOT/core/VMessagePack.cpp \
+    $$NV_ROOT/core/VMutex.cpp \
+    $$NV_ROOT/core/VPath.cpp \
+    $$NV_ROOT/core/VString.cpp \
+    $$NV_ROOT/core/VStringView.cpp \
+    $$NV_ROOT/core/VUnicode.cpp \
+    main.cpp
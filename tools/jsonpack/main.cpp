@@ -0,0 +1,46 @@
+#include <VJson.h>
+#include <VLog.h>
+
+#include <fstream>
+#include <iterator>
+
+NV_USING_NAMESPACE
+
+// Converts a JSON asset into MessagePack, e.g.
+//
+//     jsonpack res/raw/efigs.fnt packed/efigs.fnt
+//
+// VJsonReader tells the two forms apart, so fonts, sound lists and anything
+// else read through it take the output under the same name. No build step
+// runs this yet, so the assets in the tree are still shipped as text.
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        vError("Usage: jsonpack <input> <output>");
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        vError("Can't open " << argv[1]);
+        return 1;
+    }
+    const VByteArray text(std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+
+    // Only an array or an object can be told from text when read back
+    const VJson json = VJson::Parse(text);
+    if (!json.isArray() && !json.isObject()) {
+        vError(argv[1] << " does not hold a JSON array or object");
+        return 1;
+    }
+
+    const VByteArray binary = json.toBinary();
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    if (!out.write(binary.data(), binary.size())) {
+        vError("Can't write " << argv[2]);
+        return 1;
+    }
+
+    vInfo(argv[1] << ": " << text.size() << " bytes to " << binary.size());
+    return 0;
+}